@@ -0,0 +1,85 @@
+#include "core/job_system.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Scheduling overhead of the job system: empty jobs, fine-grained parallelFor and dependency chains //
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNanoseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Scheduled in rounds that fit the deque: past its capacity a job runs inline in schedule, which would //
+// measure a function call rather than the scheduling //
+static void benchmarkEmptyJobs(vulkan::JobSystem &jobSystem, uint32_t jobCount) {
+    constexpr uint32_t ROUND_SIZE = vulkan::JobSystem::DEQUE_CAPACITY / 2;
+    std::atomic<uint32_t> executed{0};
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t scheduled = 0; scheduled < jobCount; scheduled += ROUND_SIZE) {
+        vulkan::JobCounter counter;
+        for (uint32_t i = scheduled; i < jobCount && i < scheduled + ROUND_SIZE; i++) {
+            jobSystem.schedule([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        jobSystem.wait(counter);
+    }
+    double nanoseconds = elapsedNanoseconds(start);
+
+    std::cout << "empty jobs       " << jobCount << " jobs in rounds of " << ROUND_SIZE << ", " << nanoseconds / jobCount << " ns/job" << (executed == jobCount ? "" : " (MISSING JOBS)") << std::endl;
+}
+
+static void benchmarkParallelFor(vulkan::JobSystem &jobSystem, uint32_t count, uint32_t batchSize) {
+    std::vector<float> values(count, 1.0f);
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = std::sqrt(values[i] * 2.0f + static_cast<float>(i));
+    }
+    double serial = elapsedNanoseconds(start);
+
+    start = Clock::now();
+    jobSystem.parallelFor(count, batchSize, [&values](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            values[i] = std::sqrt(values[i] * 2.0f + static_cast<float>(i));
+        }
+    });
+    double parallel = elapsedNanoseconds(start);
+
+    std::cout << "parallelFor      " << count << " items, batch " << batchSize << ": serial " << serial / 1000.0 << " us, parallel " << parallel / 1000.0 << " us, speed-up " << serial / parallel << "x" << std::endl;
+}
+
+static void benchmarkDependencyChain(vulkan::JobSystem &jobSystem, uint32_t length) {
+    std::vector<vulkan::JobCounter> counters(length);
+    uint32_t last = 0;
+
+    Clock::time_point start = Clock::now();
+    jobSystem.schedule([&last]() { last = 1; }, &counters[0]);
+    for (uint32_t i = 1; i < length; i++) {
+        jobSystem.scheduleAfter(counters[i - 1], [&last, i]() { last = i + 1; }, &counters[i]);
+    }
+    for (vulkan::JobCounter &counter : counters) {
+        jobSystem.wait(counter);
+    }
+    double nanoseconds = elapsedNanoseconds(start);
+
+    std::cout << "dependency chain " << length << " links, " << nanoseconds / length << " ns/link" << (last == length ? "" : " (OUT OF ORDER)") << std::endl;
+}
+
+int main() {
+    vulkan::JobSystem jobSystem;
+    std::cout << "workers: " << jobSystem.getWorkerCount() << std::endl;
+
+    for (int run = 0; run < 3; run++) {
+        benchmarkEmptyJobs(jobSystem, 100000);
+        benchmarkParallelFor(jobSystem, 1 << 22, 4096);
+        benchmarkParallelFor(jobSystem, 1 << 22, 256);
+        benchmarkDependencyChain(jobSystem, 10000);
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "core/allocation_counter.hpp"
+#include "core/job_system.hpp"
+#include "scene/transform_hierarchy.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Update time of the transform hierarchy, for the whole tree and for a few changed subtrees, checked //
+// against a scalar reference and for allocations //
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMilliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Parents come before their children, as in a scene file: one in 64 entities is a root //
+static void makeTree(uint32_t count, std::vector<vulkan::SceneEntity> &entities, std::vector<vulkan::SceneTransform> &transforms) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-10.0f, 10.0f};
+    std::uniform_real_distribution<float> scale{0.5f, 1.5f};
+    entities.resize(count);
+    transforms.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t parent = i % 64 == 0 ? vulkan::Scene::INVALID_INDEX : i - 1 - random() % std::min(i, 256u);
+        entities[i] = {parent, i, 0, 0};
+        transforms[i] = {{position(random), position(random)}, scale(random), position(random)};
+    }
+}
+
+// Counts the entities whose world transform differs from the scalar reference, resolved in file order //
+static uint32_t countMismatches(const vulkan::TransformHierarchy &hierarchy, const std::vector<vulkan::SceneEntity> &entities, const std::vector<vulkan::SceneTransform> &transforms) {
+    std::vector<vulkan::SceneTransform> world(entities.size());
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < entities.size(); i++) {
+        const vulkan::SceneTransform &local = transforms[i];
+        world[i] = local;
+        if (entities[i].parent != vulkan::Scene::INVALID_INDEX) {
+            const vulkan::SceneTransform &parent = world[entities[i].parent];
+            world[i].position.x = local.position.x * parent.scale + parent.position.x;
+            world[i].position.y = local.position.y * parent.scale + parent.position.y;
+            world[i].scale = local.scale * parent.scale;
+        }
+        vulkan::SceneTransform resolved = hierarchy.getWorld(i);
+        if (resolved.position.x != world[i].position.x || resolved.position.y != world[i].position.y || resolved.scale != world[i].scale || resolved.depth != world[i].depth) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Moves `changes` entities, spread over the scene, then updates //
+static void benchmarkUpdate(vulkan::TransformHierarchy &hierarchy, std::vector<vulkan::SceneEntity> &entities, std::vector<vulkan::SceneTransform> &transforms, uint32_t changes, uint32_t frame) {
+    uint32_t count = static_cast<uint32_t>(entities.size());
+    uint32_t stride = changes > 0 ? count / changes : count;
+    for (uint32_t i = 0; i < changes; i++) {
+        uint32_t entity = (i * stride + frame * 7919) % count;
+        transforms[entity].position.x += 1.0f;
+        hierarchy.setLocal(entity, transforms[entity]);
+    }
+
+    uint64_t allocationsBefore = vulkan::AllocationCounter::getAllocationCount();
+    Clock::time_point start = Clock::now();
+    hierarchy.update();
+    double milliseconds = elapsedMilliseconds(start);
+    uint64_t allocations = vulkan::AllocationCounter::getAllocationCount() - allocationsBefore;
+
+    std::cout << "update " << changes << " changed of " << count << ": " << milliseconds << " ms, " << allocations << " allocations" << std::endl;
+}
+
+int main() {
+    constexpr uint32_t NODE_COUNT = 500000;
+    vulkan::JobSystem jobSystem;
+    std::cout << "workers: " << jobSystem.getWorkerCount() << std::endl;
+
+    std::vector<vulkan::SceneEntity> entities;
+    std::vector<vulkan::SceneTransform> transforms;
+    makeTree(NODE_COUNT, entities, transforms);
+
+    vulkan::TransformHierarchy hierarchy{jobSystem};
+    hierarchy.build({entities.data(), NODE_COUNT}, {transforms.data(), NODE_COUNT}, NODE_COUNT);
+    std::cout << "nodes: " << hierarchy.getNodeCount() << ", levels: " << hierarchy.getLevelCount() << std::endl;
+
+    for (uint32_t frame = 0; frame < 3; frame++) {
+        // Every node is dirty after a build //
+        hierarchy.build({entities.data(), NODE_COUNT}, {transforms.data(), NODE_COUNT}, NODE_COUNT);
+        Clock::time_point start = Clock::now();
+        hierarchy.update();
+        std::cout << "update all " << NODE_COUNT << ": " << elapsedMilliseconds(start) << " ms" << std::endl;
+        benchmarkUpdate(hierarchy, entities, transforms, 0, frame);
+        benchmarkUpdate(hierarchy, entities, transforms, 1, frame);
+        benchmarkUpdate(hierarchy, entities, transforms, 100, frame);
+        benchmarkUpdate(hierarchy, entities, transforms, NODE_COUNT / 100, frame);
+    }
+
+    uint32_t mismatches = countMismatches(hierarchy, entities, transforms);
+    std::cout << "scalar reference: " << (mismatches == 0 ? "match" : "MISMATCH") << " (" << mismatches << " differ)" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Writes a C++ source holding every SPIR-V module given as an aligned constexpr array,
+# plus the table ShaderRegistry looks them up in by name (file name without ".spv"),
+# and the shader variant manifest as a string.
+# Usage: ./embed_shaders.sh <output.cpp> <manifest> <shader.spv>...
+
+OUTPUT=$1
+MANIFEST=$2
+shift 2
+
+if [ -z "$OUTPUT" ] || [ ! -f "$MANIFEST" ] || [ $# -eq 0 ]; then
+  echo -e "\033[1;30;41mUsage: $0 <output.cpp> <manifest> <shader.spv>...\033[0m"
+  exit 1
+fi
+
+mkdir -p "$(dirname "$OUTPUT")"
+
+{
+  echo "// Generated by embed_shaders.sh from the compiled shaders, do not edit //"
+  echo "#include \"pipeline/shader_registry.hpp\""
+  echo ""
+  echo "namespace vulkan {"
+  echo ""
+
+  INDEX=0
+  for SPV in "$@"; do
+    echo "    // $SPV //"
+    echo "    alignas(16) static constexpr uint32_t SHADER_$INDEX[] = {"
+    # SPIR-V is a stream of host-endian 32-bit words //
+    od -An -v -t x4 "$SPV" | sed -e 's/ *\([0-9a-f]\{8\}\)/0x\1u, /g' -e 's/ *$//' -e 's/^/        /'
+    echo "    };"
+    echo ""
+    INDEX=$((INDEX + 1))
+  done
+
+  echo "    const EmbeddedShader EMBEDDED_SHADERS[] = {"
+  INDEX=0
+  for SPV in "$@"; do
+    NAME=$(basename "$SPV" .spv)
+    echo "        {\"$NAME\", SHADER_$INDEX, sizeof(SHADER_$INDEX) / sizeof(uint32_t)},"
+    INDEX=$((INDEX + 1))
+  done
+  echo "    };"
+  echo ""
+  echo "    const size_t EMBEDDED_SHADER_COUNT = $INDEX;"
+  echo ""
+  echo "    // $MANIFEST //"
+  echo "    const unsigned char EMBEDDED_MANIFEST[] = {"
+  od -An -v -t x1 "$MANIFEST" | sed -e 's/ *\([0-9a-f]\{2\}\)/0x\1, /g' -e 's/ *$//' -e 's/^/        /'
+  echo "        0x00"
+  echo "    };"
+  echo ""
+  echo "}"
+} > "$OUTPUT"
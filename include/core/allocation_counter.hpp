@@ -0,0 +1,16 @@
+#pragma once
+
+// STD include //
+#include <cstdint>
+
+namespace vulkan {
+
+    // Counts every call to the global operator new, process-wide. Replacement operators live in //
+    // allocation_counter.cpp; the frame loop compares counts around a frame to prove it stays off the heap. //
+    class AllocationCounter {
+        public:
+            static uint64_t getAllocationCount();
+            static uint64_t getAllocatedBytes();
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// STD include //
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vulkan {
+
+    // Watches directories for files written or moved in (inotify; a no-op on other systems). Its thread //
+    // waits until a burst of changes has settled, then hands each changed file to the handler of its //
+    // directory, once, on that thread: rebuilding or re-importing happens there. What the render thread //
+    // must do with the result is posted, and run between two frames by applyPosted. //
+    class AssetWatcher {
+        private:
+            using Handler = std::function<void(const std::string &directory, const std::string &fileName)>;
+
+            struct Watch {
+                std::string directory;
+                uint32_t events;
+                Handler handler;
+            };
+
+            struct Change {
+                int descriptor;
+                std::string fileName;
+                uint32_t events;
+            };
+
+            int _inotify = -1;
+            int _wake = -1;
+            // A directory watched twice shares one descriptor //
+            std::unordered_map<int, std::vector<Watch>> _watches;
+            std::thread _thread;
+            std::mutex _mutex;
+            std::vector<std::function<void()>> _posted;
+
+            void run();
+            bool readEvents(std::vector<Change> &changes);
+
+        public:
+            static constexpr int SETTLE_MILLISECONDS = 50;
+            // What a watch reacts to: a file closed after being written in place, or moved in whole //
+            static constexpr uint32_t FILE_WRITTEN = 1;
+            static constexpr uint32_t FILE_MOVED_IN = 2;
+
+            AssetWatcher();
+            bool isSupported() const;
+            void watch(const std::string &directory, Handler handler, uint32_t events = FILE_WRITTEN | FILE_MOVED_IN);
+            void start();
+            void stop();
+            void post(std::function<void()> &&apply);
+            bool applyPosted();
+            ~AssetWatcher();
+
+            // Remove the copy operators to prevent make copies //
+            AssetWatcher(const AssetWatcher &) = delete;
+            AssetWatcher &operator=(const AssetWatcher &) = delete;
+    };
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// STD include //
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vulkan {
+
+    // Bump allocator: allocations are never freed one by one, the whole arena is reset at once. //
+    // When a frame needs more than the arena holds the extra comes from overflow blocks, and the next //
+    // reset grows the arena so the steady state never reaches the general heap. //
+    class LinearArena {
+        private:
+            std::unique_ptr<uint8_t[]> _memory;
+            size_t _capacity;
+            size_t _offset = 0;
+            size_t _peak = 0;
+            std::vector<std::unique_ptr<uint8_t[]>> _overflowBlocks;
+            size_t _overflowBytes = 0;
+
+        public:
+            LinearArena(size_t capacity);
+            void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+            void reset();
+            size_t getCapacity() const;
+            size_t getUsed() const;
+            size_t getPeak() const;
+
+            // Remove the copy operators to prevent make copies //
+            LinearArena(const LinearArena &) = delete;
+            LinearArena &operator=(const LinearArena &) = delete;
+    };
+
+    // Standard allocator over a LinearArena; deallocation is a no-op until the arena is reset. //
+    template <typename T>
+    class ArenaAllocator {
+        private:
+            LinearArena *_arena;
+
+        public:
+            using value_type = T;
+
+            ArenaAllocator(LinearArena &arena) noexcept : _arena{&arena} {}
+            template <typename U>
+            ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena{other.getArena()} {}
+
+            T *allocate(size_t count) {
+                return static_cast<T *>(_arena->allocate(count * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *, size_t) noexcept {}
+
+            LinearArena *getArena() const noexcept {
+                return _arena;
+            }
+
+            template <typename U>
+            bool operator==(const ArenaAllocator<U> &other) const noexcept {
+                return _arena == other.getArena();
+            }
+
+            template <typename U>
+            bool operator!=(const ArenaAllocator<U> &other) const noexcept {
+                return _arena != other.getArena();
+            }
+    };
+
+    // Transient container for data that lives at most until the end of the frame //
+    template <typename T>
+    using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+    // One arena per frame in flight. An arena is reset when its frame slot comes round again, //
+    // which is after that slot's fence has signalled, so memory handed to the GPU path stays valid. //
+    class FrameArenas {
+        private:
+            std::vector<std::unique_ptr<LinearArena>> _arenas;
+            size_t _current = 0;
+
+        public:
+            static constexpr size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+            FrameArenas(size_t frameCount, size_t capacity = DEFAULT_CAPACITY);
+            void beginFrame(size_t frameIndex);
+            LinearArena &getCurrent();
+
+            template <typename T>
+            FrameVector<T> makeVector() {
+                return FrameVector<T>{ArenaAllocator<T>{getCurrent()}};
+            }
+
+            // Remove the copy operators to prevent make copies //
+            FrameArenas(const FrameArenas &) = delete;
+            FrameArenas &operator=(const FrameArenas &) = delete;
+    };
+
+}
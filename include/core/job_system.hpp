@@ -0,0 +1,110 @@
+#pragma once
+
+// Code include //
+#include "work_stealing_deque.hpp"
+
+// STD include //
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vulkan {
+
+    class JobCounter;
+    struct JobPool;
+
+    // Either a function, or one batch of a parallelFor range, which needs no std::function of its own //
+    struct Job {
+        std::function<void()> function;
+        const std::function<void(uint32_t begin, uint32_t end)> *range = nullptr;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        JobCounter *counter = nullptr;
+        // The pool it goes back to once it has run, null for jobs scheduled from outside threads //
+        JobPool *pool = nullptr;
+        Job *next = nullptr;
+    };
+
+    // Jobs of one thread of the system, reused so steady-state scheduling does not allocate. The owner //
+    // takes from its free list alone; jobs run on other threads come back through the returned stack //
+    struct JobPool {
+        Job *free = nullptr;
+        std::atomic<Job *> returned{nullptr};
+        std::vector<std::unique_ptr<Job[]>> blocks;
+    };
+
+    // Number of unfinished jobs scheduled against it. Jobs queued with scheduleAfter run once it drops to zero. //
+    // Always wait on a counter before destroying it. //
+    class JobCounter {
+        private:
+            friend class JobSystem;
+
+            std::atomic<uint32_t> _pending{0};
+            std::mutex _mutex;
+            std::vector<Job *> _continuations;
+
+        public:
+            JobCounter() = default;
+            bool isDone() const;
+            uint32_t getPending() const;
+
+            // Remove the copy operators to prevent make copies //
+            JobCounter(const JobCounter &) = delete;
+            JobCounter &operator=(const JobCounter &) = delete;
+    };
+
+    // Fixed pool of worker threads, one pinned per core, each owning a work-stealing deque. //
+    // The thread that creates the system owns one more deque and helps out while it waits, so subsystems //
+    // fan work out with schedule/parallelFor instead of starting threads of their own. //
+    class JobSystem {
+        private:
+            std::vector<std::unique_ptr<WorkStealingDeque>> _deques;
+            std::vector<std::unique_ptr<JobPool>> _pools;
+            std::vector<std::thread> _workers;
+            std::atomic<bool> _running{true};
+
+            // Jobs scheduled from threads the system does not own //
+            std::mutex _injectedMutex;
+            std::deque<Job *> _injectedJobs;
+            std::atomic<uint32_t> _injectedCount{0};
+
+            std::atomic<int32_t> _queuedJobs{0};
+            std::atomic<uint32_t> _sleepingWorkers{0};
+            std::mutex _sleepMutex;
+            std::condition_variable _sleepCondition;
+
+            void workerLoop(uint32_t index);
+            Job *allocateJob(JobCounter *counter);
+            void releaseJob(Job *job);
+            void enqueue(Job *job);
+            Job *findJob(int32_t index);
+            void execute(Job *job);
+            void finish(JobCounter *counter);
+            int32_t getThreadIndex();
+            static void pinThread(std::thread &thread, uint32_t core);
+
+        public:
+            static constexpr uint32_t DEQUE_CAPACITY = 4096;
+            static constexpr uint32_t SPIN_COUNT = 64;
+            static constexpr uint32_t JOB_BLOCK_SIZE = 256;
+
+            JobSystem(uint32_t workerCount = 0);
+            void schedule(std::function<void()> &&function, JobCounter *counter = nullptr);
+            void scheduleAfter(JobCounter &dependency, std::function<void()> &&function, JobCounter *counter = nullptr);
+            void wait(JobCounter &counter);
+            void parallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t begin, uint32_t end)> &function);
+            uint32_t getWorkerCount();
+            ~JobSystem();
+
+            // Remove the copy operators to prevent make copies //
+            JobSystem(const JobSystem &) = delete;
+            JobSystem &operator=(const JobSystem &) = delete;
+    };
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// STD include //
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace vulkan {
+
+    // Read-only memory mapping of a whole file; pointers into it stay valid for the object's lifetime. //
+    class MappedFile {
+        private:
+            const uint8_t *_data = nullptr;
+            size_t _size = 0;
+
+        public:
+            MappedFile(const std::string &filePath);
+            const uint8_t *getData() const;
+            size_t getSize() const;
+            void prefetch(size_t offset, size_t length) const;
+            ~MappedFile();
+
+            // Remove the copy operators to prevent make copies //
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+    };
+
+}
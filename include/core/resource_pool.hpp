@@ -0,0 +1,137 @@
+#pragma once
+
+// Code include //
+#include "../devices/deletion_queue.hpp"
+
+// STD include //
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace vulkan {
+
+    // Names a resource of a ResourcePool<T, Tag>; the tag keeps handles of different pools apart. The //
+    // generation tells a handle to a released resource from one to whatever reused its slot since, and a //
+    // default handle is never valid. Handles are plain values, safe to copy, store and pass between threads. //
+    template <typename Tag>
+    struct Handle {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        bool isValid() const { return generation != 0; }
+        bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Handle &other) const { return !(*this == other); }
+    };
+
+    // Resources stored contiguously and reached through generational handles. A handle's slot gives the //
+    // resource's place in the dense array in O(1); removing one moves the last resource into the hole, so //
+    // the dense array never has gaps and loops over every resource walk plain memory. Pointers returned //
+    // by get stay valid until the next create or remove. Not synchronized: a pool belongs to one thread. //
+    template <typename T, typename Tag = T>
+    class ResourcePool {
+        private:
+            static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+            struct Slot {
+                uint32_t dense;
+                uint32_t generation;
+            };
+
+            std::vector<T> _resources;
+            std::vector<uint32_t> _resourceSlots;
+            std::vector<Slot> _slots;
+            std::vector<uint32_t> _freeSlots;
+
+            // Zero is left out, so a default handle never matches a slot //
+            static uint32_t nextGeneration(uint32_t generation) {
+                return generation == UINT32_MAX ? 1 : generation + 1;
+            }
+
+        public:
+            using HandleType = Handle<Tag>;
+
+            HandleType create(T &&resource) {
+                uint32_t index;
+                if (!_freeSlots.empty()) {
+                    index = _freeSlots.back();
+                    _freeSlots.pop_back();
+                } else {
+                    index = static_cast<uint32_t>(_slots.size());
+                    _slots.push_back({INVALID_INDEX, 1});
+                }
+                _slots[index].dense = static_cast<uint32_t>(_resources.size());
+                _resources.push_back(std::move(resource));
+                _resourceSlots.push_back(index);
+                return {index, _slots[index].generation};
+            }
+
+            bool contains(HandleType handle) const {
+                return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation && _slots[handle.index].dense != INVALID_INDEX;
+            }
+
+            // Null for a stale or default handle //
+            T *get(HandleType handle) {
+                return contains(handle) ? &_resources[_slots[handle.index].dense] : nullptr;
+            }
+
+            const T *get(HandleType handle) const {
+                return contains(handle) ? &_resources[_slots[handle.index].dense] : nullptr;
+            }
+
+            // The handle, and every copy of it, goes stale at once; the caller owns the resource returned //
+            T take(HandleType handle) {
+                Slot &slot = _slots[handle.index];
+                uint32_t dense = slot.dense;
+                T resource = std::move(_resources[dense]);
+                uint32_t last = static_cast<uint32_t>(_resources.size() - 1);
+                if (dense != last) {
+                    _resources[dense] = std::move(_resources[last]);
+                    _resourceSlots[dense] = _resourceSlots[last];
+                    _slots[_resourceSlots[dense]].dense = dense;
+                }
+                _resources.pop_back();
+                _resourceSlots.pop_back();
+                slot.dense = INVALID_INDEX;
+                slot.generation = nextGeneration(slot.generation);
+                _freeSlots.push_back(handle.index);
+                return resource;
+            }
+
+            // The handle goes stale at once, but the resource may still be in use by frames in flight: destroy //
+            // runs on it once they have retired. Returns false for a stale handle //
+            template <typename Destroy>
+            bool release(HandleType handle, DeletionQueue &deletionQueue, Destroy destroy) {
+                if (!contains(handle)) {
+                    return false;
+                }
+                std::shared_ptr<T> retired = std::make_shared<T>(take(handle));
+                deletionQueue.push([retired, destroy]() { destroy(*retired); });
+                return true;
+            }
+
+            // For resources whose destructor does the cleanup //
+            bool release(HandleType handle, DeletionQueue &deletionQueue) {
+                return release(handle, deletionQueue, [](T &) {});
+            }
+
+            // Every handle handed out so far goes stale //
+            void clear() {
+                for (uint32_t slot : _resourceSlots) {
+                    _slots[slot].dense = INVALID_INDEX;
+                    _slots[slot].generation = nextGeneration(_slots[slot].generation);
+                    _freeSlots.push_back(slot);
+                }
+                _resources.clear();
+                _resourceSlots.clear();
+            }
+
+            uint32_t size() const { return static_cast<uint32_t>(_resources.size()); }
+            bool isEmpty() const { return _resources.empty(); }
+            T *begin() { return _resources.data(); }
+            T *end() { return _resources.data() + _resources.size(); }
+            const T *begin() const { return _resources.data(); }
+            const T *end() const { return _resources.data() + _resources.size(); }
+    };
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Code include //
+#include "job_system.hpp"
+
+// STD include //
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vulkan {
+
+    // Records when each startup stage ran and on which thread, relative to the timeline's creation, and //
+    // prints the breakdown once the first frame is out. Stages either run on the calling thread (measure, //
+    // mark) or on the job system (schedule), where they overlap with the main thread. //
+    class StartupTimeline {
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            struct Stage {
+                std::string name;
+                double start;
+                double duration;
+                bool mainThread;
+            };
+
+            Clock::time_point _origin;
+            Clock::time_point _lastMark;
+            std::thread::id _mainThread;
+            std::mutex _mutex;
+            std::vector<Stage> _stages;
+            std::exception_ptr _failure;
+            bool _reported = false;
+
+            double toMilliseconds(Clock::time_point time);
+            void record(const std::string &name, Clock::time_point start, Clock::time_point end);
+
+        public:
+            StartupTimeline();
+            void measure(const std::string &name, const std::function<void()> &function);
+            void mark(const std::string &name);
+            void schedule(JobSystem &jobSystem, const std::string &name, std::function<void()> &&function, JobCounter &counter);
+            void wait(JobSystem &jobSystem, JobCounter &counter);
+            void report(std::ostream &stream);
+            bool isReported();
+
+            // Remove the copy operators to prevent make copies //
+            StartupTimeline(const StartupTimeline &) = delete;
+            StartupTimeline &operator=(const StartupTimeline &) = delete;
+    };
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// STD include //
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace vulkan {
+
+    struct Job;
+
+    // Fixed-capacity Chase-Lev deque. The owning thread pushes and pops at the bottom without locking, //
+    // any other thread steals from the top; a single compare-and-swap settles the race on the last job. //
+    class WorkStealingDeque {
+        private:
+            std::unique_ptr<std::atomic<Job *>[]> _buffer;
+            int64_t _mask;
+            alignas(64) std::atomic<int64_t> _top{0};
+            alignas(64) std::atomic<int64_t> _bottom{0};
+
+        public:
+            WorkStealingDeque(uint32_t capacity);
+            bool push(Job *job);
+            Job *pop();
+            Job *steal();
+            bool isEmpty() const;
+
+            // Remove the copy operators to prevent make copies //
+            WorkStealingDeque(const WorkStealingDeque &) = delete;
+            WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+    };
+
+}
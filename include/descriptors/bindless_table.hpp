@@ -0,0 +1,65 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+
+// STD include //
+#include <cstdint>
+#include <vector>
+
+namespace vulkan {
+
+    // One global descriptor set holding every sampled image and storage buffer of the engine. //
+    // Resources are registered once and addressed from shaders by index, so nothing is re-bound per draw. //
+    class BindlessTable {
+        private:
+            Device &_device;
+            VkDescriptorSetLayout _descriptorSetLayout;
+            VkDescriptorPool _descriptorPool;
+            VkDescriptorSet _descriptorSet;
+            uint32_t _maxImages;
+            uint32_t _maxBuffers;
+
+            std::vector<uint32_t> _freeImageIndices;
+            std::vector<uint32_t> _freeBufferIndices;
+            uint32_t _nextImageIndex = 0;
+            uint32_t _nextBufferIndex = 0;
+            // Whether each slot is registered, so a slot is never freed twice //
+            std::vector<bool> _liveImages;
+            std::vector<bool> _liveBuffers;
+
+            void computeCapacities();
+            void createDescriptorSetLayout();
+            void createDescriptorPool();
+            void allocateDescriptorSet();
+            static uint32_t allocateIndex(std::vector<uint32_t> &freeIndices, std::vector<bool> &live, uint32_t &nextIndex, uint32_t capacity);
+            static void releaseIndex(uint32_t index, std::vector<uint32_t> &freeIndices, std::vector<bool> &live, const char *kind);
+
+        public:
+            static constexpr uint32_t SET_INDEX = 0;
+            static constexpr uint32_t IMAGE_BINDING = 0;
+            static constexpr uint32_t BUFFER_BINDING = 1;
+            static constexpr uint32_t MAX_IMAGES = 16384;
+            static constexpr uint32_t MAX_BUFFERS = 4096;
+            static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+            BindlessTable(Device &device);
+            uint32_t registerImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            void updateImage(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            void releaseImage(uint32_t index);
+            uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+            void updateBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+            void releaseBuffer(uint32_t index);
+            void bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+            VkDescriptorSetLayout getDescriptorSetLayout();
+            VkDescriptorSet getDescriptorSet();
+            uint32_t getImageCapacity();
+            uint32_t getBufferCapacity();
+            ~BindlessTable();
+
+            // Remove the copy operators to prevent make copies //
+            BindlessTable(const BindlessTable &) = delete;
+            BindlessTable &operator=(const BindlessTable &) = delete;
+    };
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// STD include //
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace vulkan {
+
+    // Defers destruction of GPU objects until every frame that could still reference them has retired. //
+    class DeletionQueue {
+        private:
+            struct Entry {
+                uint64_t frame;
+                std::function<void()> destroy;
+            };
+
+            std::mutex _mutex;
+            std::deque<Entry> _entries;
+            uint64_t _frame = 0;
+            uint64_t _frameLatency;
+
+        public:
+            DeletionQueue(uint64_t frameLatency);
+            void push(std::function<void()> &&destroy);
+            void advanceFrame();
+            void flush();
+            uint64_t getFrame();
+            ~DeletionQueue();
+
+            // Remove the copy operators to prevent make copies //
+            DeletionQueue(const DeletionQueue &) = delete;
+            DeletionQueue &operator=(const DeletionQueue &) = delete;
+    };
+
+}
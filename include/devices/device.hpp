@@ -1,7 +1,12 @@
 #pragma once
 
 #include "window/window.hpp"
+#include "core/startup_timeline.hpp"
+#include <array>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace vulkan {
@@ -15,26 +20,84 @@ namespace vulkan {
     struct QueueFamilyIndices {
         uint32_t graphicsFamily;
         uint32_t presentFamily;
+        uint32_t transferFamily;
+        uint32_t computeFamily;
         bool graphicsFamilyHasValue = false;
         bool presentFamilyHasValue = false;
+        bool transferFamilyHasValue = false;
+        bool computeFamilyHasValue = false;
         bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+        bool hasDedicatedTransfer() { return transferFamilyHasValue && transferFamily != graphicsFamily; }
+        bool hasDedicatedCompute() { return computeFamilyHasValue && computeFamily != graphicsFamily; }
     };
 
+    // What an allocation is for, in the memory statistics //
+    enum class MemoryCategory : uint32_t { Buffer, Image, Staging };
+    static constexpr uint32_t MEMORY_CATEGORY_COUNT = 3;
+
+    struct MemoryHeapStatistics {
+        uint32_t heapIndex;
+        bool deviceLocal;
+        VkDeviceSize size;
+        // With VK_EXT_memory_budget, as the driver reports them for the whole process. Otherwise a share //
+        // of the heap, and what this device allocated from it //
+        VkDeviceSize budget;
+        VkDeviceSize usage;
+        VkDeviceSize allocatedBytes;
+        uint32_t allocationCount;
+        std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT> categoryBytes;
+    };
+
+    // Fixed-size, so it can be queried every frame without touching the heap //
+    struct MemoryStatistics {
+        bool budgetExtension;
+        uint32_t heapCount;
+        std::array<MemoryHeapStatistics, VK_MAX_MEMORY_HEAPS> heaps;
+    };
+
+    // Called by checkMemoryBudget for every heap, over its budget or not, so memory given up can come back //
+    using MemoryBudgetCallback = std::function<void(const MemoryHeapStatistics &heap)>;
+
     class Device {
         private:
+            struct MemoryAllocation {
+                uint32_t heapIndex;
+                VkDeviceSize size;
+                MemoryCategory category;
+            };
+
             VkInstance _instance;
             VkDebugUtilsMessengerEXT _debugMessenger;
             VkPhysicalDevice _physicalDevice = VK_NULL_HANDLE;
             Window &_window;
             VkCommandPool _commandPool;
+            VkCommandPool _computeCommandPool;
 
             VkDevice _device;
             VkSurfaceKHR _surface;
             VkQueue _graphicsQueue;
             VkQueue _presentQueue;
+            VkQueue _transferQueue;
+            VkQueue _computeQueue;
+            bool _asyncComputeSupported = false;
+            bool _dynamicRenderingSupported = false;
+            bool _multiDrawIndirectSupported = false;
+            bool _drawIndirectFirstInstanceSupported = false;
+            PFN_vkCmdBeginRenderingKHR _cmdBeginRendering = nullptr;
+            PFN_vkCmdEndRenderingKHR _cmdEndRendering = nullptr;
+            bool _presentWaitSupported = false;
+            PFN_vkWaitForPresentKHR _waitForPresent = nullptr;
+
+            VkPhysicalDeviceMemoryProperties _memoryProperties;
+            bool _memoryBudgetSupported = false;
+            std::mutex _memoryMutex;
+            std::unordered_map<VkDeviceMemory, MemoryAllocation> _allocations;
+            std::array<std::array<VkDeviceSize, MEMORY_CATEGORY_COUNT>, VK_MAX_MEMORY_HEAPS> _allocatedBytes{};
+            std::array<uint32_t, VK_MAX_MEMORY_HEAPS> _allocationCounts{};
+            std::vector<MemoryBudgetCallback> _memoryBudgetCallbacks;
 
             const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
-            const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+            const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME};
 
 
             void createInstance();
@@ -50,6 +113,10 @@ namespace vulkan {
             void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
             void hasGflwRequiredInstanceExtensions();
             bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+            bool checkDescriptorIndexingSupport(VkPhysicalDevice device);
+            bool checkDynamicRenderingSupport(VkPhysicalDevice device);
+            bool checkPresentWaitSupport(VkPhysicalDevice device);
+            bool hasDeviceExtension(VkPhysicalDevice device, const char *extensionName);
             SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
         public:
@@ -57,24 +124,60 @@ namespace vulkan {
             const bool enableValidationLayers = true;
             // =================================================== //
 
+            // Render straight into image views (VK_KHR_dynamic_rendering) when the device supports it //
+            const bool enableDynamicRendering = true;
+
+            // Read heap budgets and usage from the driver (VK_EXT_memory_budget) when the device supports it //
+            const bool enableMemoryBudget = true;
+
+            // Tag presents and wait for them to reach the screen (VK_KHR_present_id, VK_KHR_present_wait) //
+            // when the device supports it, for frame pacing //
+            const bool enablePresentWait = true;
+            // Without the extension, the share of each heap the process budgets for itself //
+            static constexpr float ESTIMATED_BUDGET_SHARE = 0.8f;
+
             VkPhysicalDeviceProperties _properties;
+            VkPhysicalDeviceDescriptorIndexingPropertiesEXT _descriptorIndexingProperties;
 
-            Device(Window &window);
+            Device(Window &window, StartupTimeline *startupTimeline = nullptr);
             VkCommandPool getCommandPool();
             VkDevice getDevice();
             VkSurfaceKHR getSurface();
             VkQueue getGraphicsQueue();
             VkQueue getPresentQueue();
+            VkQueue getTransferQueue();
+            VkQueue getComputeQueue();
+            VkCommandPool getComputeCommandPool();
+            bool isAsyncComputeSupported();
+            void submitCompute(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStage, VkSemaphore signalSemaphore, VkFence fence = VK_NULL_HANDLE);
+            void transferBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer, uint32_t srcFamily, uint32_t dstFamily, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+            bool isDynamicRenderingSupported();
+            bool isMultiDrawIndirectSupported();
+            bool isDrawIndirectFirstInstanceSupported();
+            void cmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR &renderingInformation);
+            void cmdEndRendering(VkCommandBuffer commandBuffer);
+            bool isPresentWaitSupported();
+            VkResult waitForPresent(VkSwapchainKHR swapChain, uint64_t presentId, uint64_t timeout);
             SwapChainSupportDetails getSwapChainSupport();
             QueueFamilyIndices findPhysicalQueueFamilies();
+            VkQueueFamilyProperties getQueueFamilyProperties(uint32_t queueFamily);
             uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+            bool hasMemoryProperties(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+            VkMemoryPropertyFlags getMemoryTypeProperties(uint32_t memoryTypeIndex);
             VkFormat findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
-            void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory);
+            VkDeviceMemory allocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, MemoryCategory category);
+            VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, MemoryCategory category);
+            void freeMemory(VkDeviceMemory memory);
+            bool isMemoryBudgetSupported();
+            MemoryStatistics getMemoryStatistics();
+            void addMemoryBudgetCallback(MemoryBudgetCallback callback);
+            void checkMemoryBudget();
+            void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory, MemoryCategory category = MemoryCategory::Buffer);
             VkCommandBuffer beginSingleTimeCommands();
             void endSingleTimeCommands(VkCommandBuffer commandBuffer);
             void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
             void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
-            void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory);
+            void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory, MemoryCategory category = MemoryCategory::Image);
             ~Device();
 
             // Remove the copy operators to prevent make copies //
@@ -0,0 +1,62 @@
+#pragma once
+
+// Code include //
+#include "../core/resource_pool.hpp"
+#include "device.hpp"
+#include "deletion_queue.hpp"
+
+// STD include //
+#include <cstdint>
+
+namespace vulkan {
+
+    struct GpuBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        // Persistently mapped when the memory is host visible, null otherwise //
+        void *mapped = nullptr;
+    };
+
+    struct GpuImage {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent3D extent = {};
+    };
+
+    using BufferHandle = Handle<GpuBuffer>;
+    using ImageHandle = Handle<GpuImage>;
+
+    // Buffers and 2D images owned by handle. Releasing one stales its handle at once and destroys it through //
+    // the deletion queue once the frames that may use it have retired; whatever is left is destroyed with //
+    // the pools, which expects the device to be idle. Used from the render thread. //
+    class GpuResources {
+        private:
+            Device &_device;
+            DeletionQueue &_deletionQueue;
+            ResourcePool<GpuBuffer> _buffers;
+            ResourcePool<GpuImage> _images;
+
+            static void destroyBuffer(Device &device, GpuBuffer &buffer);
+            static void destroyImage(Device &device, GpuImage &image);
+
+        public:
+            GpuResources(Device &device, DeletionQueue &deletionQueue);
+            BufferHandle createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category = MemoryCategory::Buffer);
+            ImageHandle createImage(const VkImageCreateInfo &imageInfo, VkImageAspectFlags aspectMask, VkMemoryPropertyFlags properties);
+            GpuBuffer *getBuffer(BufferHandle handle);
+            GpuImage *getImage(ImageHandle handle);
+            bool release(BufferHandle handle);
+            bool release(ImageHandle handle);
+            uint32_t getBufferCount() const;
+            uint32_t getImageCount() const;
+            ~GpuResources();
+
+            // Remove the copy operators to prevent make copies //
+            GpuResources(const GpuResources &) = delete;
+            GpuResources &operator=(const GpuResources &) = delete;
+    };
+
+}
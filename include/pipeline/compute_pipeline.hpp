@@ -0,0 +1,27 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+
+// STD include //
+#include <string>
+
+namespace vulkan {
+
+    class ComputePipeline {
+        private:
+            Device &_device;
+            VkPipeline _computePipeline;
+            VkShaderModule _shaderModule;
+
+        public:
+            ComputePipeline(Device &device, const std::string &compShader, VkPipelineLayout pipelineLayout);
+            void bind(VkCommandBuffer commandBuffer);
+            ~ComputePipeline();
+
+            // Remove the copy operators to prevent make copies //
+            ComputePipeline(const ComputePipeline &) = delete;
+            ComputePipeline &operator=(const ComputePipeline &) = delete;
+    };
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+
+// STD include //
+#include <cstdint>
+
+namespace vulkan {
+
+    // Sub-allocation handed out by DynamicBuffer: write through `data`, bind `buffer` at `offset` //
+    struct DynamicAllocation {
+        void *data;
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    // Persistently mapped buffer for geometry and constants that change every frame. //
+    // It is split into one slice per frame in flight; a slice is bump-allocated during its frame and //
+    // recycled by beginFrame once that frame's fence has signalled. On non-coherent memory everything //
+    // written since the last flush goes out in a single vkFlushMappedMemoryRanges call. //
+    class DynamicBuffer {
+        private:
+            Device &_device;
+            VkBuffer _buffer;
+            VkDeviceMemory _memory;
+            uint8_t *_mapped;
+            VkDeviceSize _frameSize;
+            uint32_t _frameCount;
+            uint32_t _frame = 0;
+            VkDeviceSize _offset = 0;
+            VkDeviceSize _flushedOffset = 0;
+            bool _coherent;
+            VkDeviceSize _uniformAlignment;
+            VkDeviceSize _storageAlignment;
+            VkDeviceSize _nonCoherentAtomSize;
+
+            void allocateMemory();
+
+        public:
+            static constexpr VkDeviceSize VERTEX_ALIGNMENT = 16;
+
+            DynamicBuffer(Device &device, VkDeviceSize frameSize, uint32_t frameCount);
+            void beginFrame(uint32_t frameIndex);
+            bool allocate(VkDeviceSize size, VkDeviceSize alignment, DynamicAllocation &allocation);
+            bool allocateVertices(VkDeviceSize size, DynamicAllocation &allocation);
+            bool allocateIndices(VkDeviceSize size, VkIndexType indexType, DynamicAllocation &allocation);
+            bool allocateUniform(VkDeviceSize size, DynamicAllocation &allocation);
+            bool allocateStorage(VkDeviceSize size, DynamicAllocation &allocation);
+            void flush();
+            VkBuffer getBuffer();
+            VkDeviceSize getFrameSize();
+            VkDeviceSize getUsed();
+            bool isCoherent();
+            ~DynamicBuffer();
+
+            // Remove the copy operators to prevent make copies //
+            DynamicBuffer(const DynamicBuffer &) = delete;
+            DynamicBuffer &operator=(const DynamicBuffer &) = delete;
+    };
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+
+// STD include //
+#include <cstdint>
+#include <vector>
+
+namespace vulkan {
+
+    // Picks the render resolution from the measured GPU frame time. Two timestamps per swap-chain image //
+    // bracket its command buffer and are read back, without waiting, once the image is acquired again. //
+    // The first is taken after the wait for the swap-chain image, so the time never includes that stall //
+    // and is also the GPU work estimate the frame pacer uses. //
+    // The scale moves in 5% steps and settles between changes, so the cached command buffers are only //
+    // re-recorded when the viewport actually changes. //
+    class DynamicResolution {
+        private:
+            Device &_device;
+            VkQueryPool _queryPool = VK_NULL_HANDLE;
+            std::vector<bool> _queriesWritten;
+            bool _timestampsSupported;
+            uint64_t _timestampMask;
+            double _timestampPeriod;
+            float _frameBudget;
+            float _gpuTime = 0.0f;
+            uint32_t _scalePercent = MAX_SCALE_PERCENT;
+            uint32_t _framesSinceChange = 0;
+
+        public:
+            static constexpr uint32_t MIN_SCALE_PERCENT = 50;
+            static constexpr uint32_t MAX_SCALE_PERCENT = 100;
+            static constexpr uint32_t SCALE_STEP_PERCENT = 5;
+            // Scale up only once the frame is comfortably under budget, so it does not oscillate //
+            static constexpr float RAISE_THRESHOLD = 0.8f;
+            static constexpr float SMOOTHING = 0.1f;
+            static constexpr uint32_t SETTLE_FRAMES = 30;
+
+            DynamicResolution(Device &device, float frameBudget = 1000.0f / 60.0f);
+            void createQueries(size_t imageCount);
+            void destroyQueries();
+            void recordBegin(VkCommandBuffer commandBuffer, int imageIndex);
+            void recordEnd(VkCommandBuffer commandBuffer, int imageIndex);
+            bool measure(int imageIndex);
+            bool update();
+            VkExtent2D getRenderExtent(VkExtent2D extent) const;
+            float getScale() const;
+            float getGpuTime() const;
+            ~DynamicResolution();
+
+            // Remove the copy operators to prevent make copies //
+            DynamicResolution(const DynamicResolution &) = delete;
+            DynamicResolution &operator=(const DynamicResolution &) = delete;
+    };
+
+}
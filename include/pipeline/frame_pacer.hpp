@@ -0,0 +1,71 @@
+#pragma once
+
+// Code include //
+#include "swap_chain.hpp"
+
+// STD include //
+#include <chrono>
+#include <cstdint>
+
+namespace vulkan {
+
+    // Starts each frame as late as it can while still making the next refresh, and measures the time from //
+    // input sampling to the frame reaching the screen. With present wait, beginFrame waits until the //
+    // previous frame is on screen, which both bounds the queue of frames and times the refresh, then sleeps //
+    // until the next refresh minus the expected CPU and GPU time. Without it, or without a GPU time to //
+    // expect, the time spent blocked acquiring the swap-chain image is turned into a sleep before the //
+    // frame instead. Without present wait, the latency is estimated from the CPU, GPU and refresh times. //
+    class FramePacer {
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            bool _presentWait;
+            Clock::time_point _frameStart;
+            Clock::time_point _inputTime;
+            Clock::time_point _lastPresent;
+            Clock::time_point _lastFrameStart;
+            bool _presentTimed = false;
+            bool _frameTimed = false;
+            bool _gpuTimed = false;
+            SwapChain *_pendingSwapChain = nullptr;
+            uint64_t _pendingPresentId = 0;
+            Clock::time_point _pendingInputTime;
+            float _refreshInterval = 1000.0f / 60.0f;
+            float _workTime = 0.0f;
+            float _delay = 0.0f;
+            float _acquireTime = 0.0f;
+            float _latency = 0.0f;
+            double _latencySum = 0.0;
+            float _maxLatency = 0.0f;
+            uint64_t _latencyCount = 0;
+
+            static float toMilliseconds(Clock::duration duration);
+            void recordLatency(float latency);
+
+        public:
+            // Kept between the expected end of the GPU work and the refresh, against frame time jitter //
+            static constexpr float SAFETY_MARGIN = 1.5f;
+            static constexpr float SMOOTHING = 0.1f;
+            // How much of the time blocked on the swap-chain moves into the sleep each frame, when it paces //
+            static constexpr float DELAY_GAIN = 0.5f;
+            static constexpr uint64_t PRESENT_TIMEOUT = 100000000;
+
+            FramePacer(Device &device);
+            void beginFrame(SwapChain &swapChain);
+            void markImageAcquired();
+            void markInputSampled();
+            void endFrame(SwapChain &swapChain, float gpuTime);
+            void reset();
+            bool usesPresentWait() const;
+            float getLatency() const;
+            float getAverageLatency() const;
+            float getMaxLatency() const;
+            uint64_t getLatencyCount() const;
+            float getRefreshInterval() const;
+
+            // Remove the copy operators to prevent make copies //
+            FramePacer(const FramePacer &) = delete;
+            FramePacer &operator=(const FramePacer &) = delete;
+    };
+
+}
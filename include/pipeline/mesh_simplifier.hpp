@@ -0,0 +1,83 @@
+#pragma once
+
+// Code include //
+#include "model.hpp"
+
+// GLM include //
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// STD include //
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace vulkan {
+
+    // Quadric error metric simplification (Garland & Heckbert) by greedy edge collapse. Models are flat, //
+    // so interior vertices carry no error of their own: each vertex accumulates the squared distance to //
+    // the lines of the boundary edges around it, and collapsing an edge costs the distance its merged //
+    // vertex moves away from all of them. Collapses that fold a triangle over or pinch the mesh are //
+    // skipped. Simplification is progressive: each call continues from the previous result. //
+    class MeshSimplifier {
+        private:
+            // Sum of squared distances to lines a x + b y + c = 0 //
+            struct Quadric {
+                double aa = 0.0, ab = 0.0, ac = 0.0, bb = 0.0, bc = 0.0, cc = 0.0;
+
+                void addLine(double a, double b, double c);
+                void add(const Quadric &quadric);
+                double evaluate(glm::vec2 position) const;
+            };
+
+            struct Collapse {
+                double cost;
+                uint32_t from;
+                uint32_t to;
+                uint32_t fromVersion;
+                uint32_t toVersion;
+                glm::vec2 position;
+                glm::vec3 color;
+
+                bool operator>(const Collapse &other) const { return cost > other.cost; }
+            };
+
+            std::vector<glm::vec2> _positions;
+            std::vector<glm::vec3> _colors;
+            std::vector<Quadric> _quadrics;
+            std::vector<uint32_t> _versions;
+            std::vector<bool> _removedVertices;
+            std::vector<std::vector<uint32_t>> _vertexTriangles;
+            std::vector<std::array<uint32_t, 3>> _triangles;
+            std::vector<bool> _removedTriangles;
+            std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> _collapses;
+            size_t _triangleCount = 0;
+            double _maxCost = 0.0;
+
+            void weld(const std::vector<Model::Vertex> &vertices);
+            void addBoundaryQuadrics();
+            void pushCollapses(uint32_t vertex);
+            Collapse evaluate(uint32_t from, uint32_t to) const;
+            bool isValid(const Collapse &collapse) const;
+            void apply(const Collapse &collapse);
+
+        public:
+            static constexpr uint32_t MAX_LODS = 8;
+            // Each level aims for this fraction of the previous one's triangles //
+            static constexpr float LOD_REDUCTION = 0.5f;
+            // A level that cannot get under this fraction of the previous one ends the chain //
+            static constexpr float MIN_LOD_REDUCTION = 0.75f;
+
+            MeshSimplifier(const std::vector<Model::Vertex> &vertices);
+            bool simplify(size_t targetTriangles);
+            size_t getTriangleCount() const;
+            float getError() const;
+            std::vector<Model::Vertex> getVertices() const;
+
+            static Model::LodMesh buildLodChain(const std::vector<Model::Vertex> &vertices);
+    };
+
+}
@@ -8,31 +8,65 @@
 #include <glm/glm.hpp>
 
 // STD include //
+#include <array>
 #include <vector>
 
 namespace vulkan {
 
+    // One level of detail: a range of the model's vertex buffer, and how far (in model units) its shape //
+    // may stray from the full-detail mesh //
+    struct ModelLod {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        float error;
+    };
+
+    // A run of levels of detail, finest first: one mesh of the model //
+    struct ModelMesh {
+        uint32_t firstLod;
+        uint32_t lodCount;
+    };
+
     class Model {
         private:
             Device &_device;
             VkBuffer _vertexBuffer;
             VkDeviceMemory _vertexBufferMemory;
             uint32_t _vertexCount;
+            std::vector<ModelLod> _lods;
+            std::vector<ModelMesh> _meshes;
 
 
         public:
+            // An object may show a level once its error projects under this many pixels //
+            static constexpr float LOD_PIXEL_ERROR = 1.0f;
+            // Width of the band around LOD_PIXEL_ERROR in which an object keeps its level //
+            static constexpr float LOD_HYSTERESIS = 0.25f;
 
             struct Vertex {
                 glm::vec2 position;
                 glm::vec3 color;
-                static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-                static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+                static std::array<VkVertexInputBindingDescription, 1> getBindingDescriptions();
+                static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions();
+            };
+
+            // Every level back to back, finest first, as MeshSimplifier::buildLodChain produces them //
+            struct LodMesh {
+                std::vector<Vertex> vertices;
+                std::vector<ModelLod> lods;
             };
 
             Model(Device &device, const std::vector<Vertex> &vertices);
-            void createVertexBuffers(const std::vector<Vertex> &vertices);
+            Model(Device &device, const LodMesh &mesh);
+            Model(Device &device, const Vertex *vertices, uint32_t vertexCount, std::vector<ModelLod> lods, std::vector<ModelMesh> meshes);
+            void createVertexBuffers(const Vertex *vertices, uint32_t vertexCount);
             void bind(VkCommandBuffer commandBuffer);
-            void draw(VkCommandBuffer commandBuffer);
+            void draw(VkCommandBuffer commandBuffer, uint32_t firstInstance = 0, uint32_t lod = 0);
+            uint32_t selectLod(uint32_t mesh, float pixelsPerUnit, uint32_t currentLod) const;
+            const ModelLod &getLod(uint32_t lod) const;
+            uint32_t getLodCount() const;
+            const ModelMesh &getMesh(uint32_t mesh) const;
+            uint32_t getMeshCount() const;
             ~Model();
 
             // Remove the copy operators to prevent make copies //
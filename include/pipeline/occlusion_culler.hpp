@@ -0,0 +1,121 @@
+#pragma once
+
+// Code include //
+#include "../descriptors/bindless_table.hpp"
+#include "../devices/device.hpp"
+#include "compute_pipeline.hpp"
+#include "swap_chain.hpp"
+
+// GLM include //
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// STD include //
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vulkan {
+
+    // One culled draw, std430: bounds in normalized device coordinates and the nearest depth they reach. //
+    // The draw is non-indexed, and its instance index is the object's index. //
+    struct OcclusionObject {
+        glm::vec2 boundsMin;
+        glm::vec2 boundsMax;
+        float depth;
+        uint32_t vertexCount;
+        uint32_t firstVertex;
+        uint32_t padding;
+    };
+
+    // Two-phase Hi-Z occlusion culling, entirely on the GPU. The early phase draws the objects found visible //
+    // by last frame's pyramid test; their depth is reduced into a pyramid of farthest depths, and the late //
+    // phase tests every object against it, draws the ones that just became visible and records visibility //
+    // for the next frame. Objects therefore never pop in: a newly revealed object is drawn the same frame. //
+    // Both phases write indirect draws with an instance count of 0 or 1, so the recorded commands do not //
+    // change from frame to frame. Needs a swap-chain with depth sampling. //
+    class OcclusionCuller {
+        private:
+            struct CullPushConstantData {
+                uint32_t objectBuffer;
+                uint32_t visibilityBuffer;
+                uint32_t commandBuffer;
+                uint32_t pyramid;
+                uint32_t objectCount;
+                uint32_t phase;
+                glm::vec2 pyramidSize;
+            };
+
+            struct PyramidPushConstantData {
+                glm::ivec2 sourceSize;
+                glm::ivec2 destinationSize;
+            };
+
+            struct StorageBuffer {
+                VkBuffer buffer = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                void *mapped = nullptr;
+                uint32_t bindlessIndex = BindlessTable::INVALID_INDEX;
+            };
+
+            Device &_device;
+            BindlessTable &_bindlessTable;
+            uint32_t _maxObjects;
+
+            StorageBuffer _visibilityBuffer;
+            StorageBuffer _commandBuffer;
+            std::vector<StorageBuffer> _objectBuffers;
+
+            VkImage _pyramid = VK_NULL_HANDLE;
+            VkDeviceMemory _pyramidMemory = VK_NULL_HANDLE;
+            VkImageView _pyramidView = VK_NULL_HANDLE;
+            std::vector<VkImageView> _pyramidMipViews;
+            std::vector<VkExtent2D> _pyramidExtents;
+            uint32_t _pyramidIndex = BindlessTable::INVALID_INDEX;
+            VkSampler _sampler;
+
+            VkDescriptorSetLayout _pyramidSetLayout;
+            VkDescriptorPool _pyramidDescriptorPool = VK_NULL_HANDLE;
+            std::vector<VkDescriptorSet> _depthSets;
+            std::vector<VkDescriptorSet> _mipSets;
+
+            VkPipelineLayout _cullPipelineLayout;
+            VkPipelineLayout _pyramidPipelineLayout;
+            std::unique_ptr<ComputePipeline> _cullPipeline;
+            std::unique_ptr<ComputePipeline> _pyramidPipeline;
+
+            void createStorageBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, StorageBuffer &storageBuffer);
+            void destroyStorageBuffer(StorageBuffer &storageBuffer);
+            void createSampler();
+            void createPipelineLayouts();
+            void createPyramidImage(VkExtent2D extent);
+            void createPyramidDescriptorSets(SwapChain &swapChain);
+            void destroyPyramid();
+            void writePyramidSet(VkDescriptorSet descriptorSet, VkImageView source, VkImageLayout sourceLayout, VkImageView destination);
+            void dispatchCull(VkCommandBuffer commandBuffer, size_t frameIndex, uint32_t objectCount, uint32_t phase);
+            static void computeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+        public:
+            static constexpr uint32_t DEFAULT_MAX_OBJECTS = 1u << 16;
+            static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+            static constexpr uint32_t PYRAMID_WORKGROUP_SIZE = 8;
+            static constexpr uint32_t EARLY_PHASE = 0;
+            static constexpr uint32_t LATE_PHASE = 1;
+
+            OcclusionCuller(Device &device, BindlessTable &bindlessTable, uint32_t maxObjects = DEFAULT_MAX_OBJECTS);
+            void createFrameObjects(size_t frameCount);
+            void createPyramid(SwapChain &swapChain);
+            OcclusionObject *getObjects(size_t frameIndex);
+            void recordEarlyCull(VkCommandBuffer commandBuffer, size_t frameIndex, uint32_t objectCount);
+            void recordDraws(VkCommandBuffer commandBuffer, uint32_t phase, uint32_t objectCount);
+            void recordLateCull(VkCommandBuffer commandBuffer, size_t frameIndex, VkExtent2D renderExtent, uint32_t objectCount);
+            uint32_t getMaxObjects();
+            ~OcclusionCuller();
+
+            // Remove the copy operators to prevent make copies //
+            OcclusionCuller(const OcclusionCuller &) = delete;
+            OcclusionCuller &operator=(const OcclusionCuller &) = delete;
+    };
+
+}
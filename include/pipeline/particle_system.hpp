@@ -0,0 +1,138 @@
+#pragma once
+
+// Code include //
+#include "../descriptors/bindless_table.hpp"
+#include "../devices/device.hpp"
+#include "compute_pipeline.hpp"
+#include "pipeline.hpp"
+#include "shader_variants.hpp"
+#include "swap_chain.hpp"
+
+// GLM include //
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// STD include //
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vulkan {
+
+    struct ParticleEmitter {
+        glm::vec2 position{0.0f, 0.0f};
+        glm::vec2 gravity{0.0f, 0.4f};
+        glm::vec4 startColor{1.0f, 0.6f, 0.2f, 1.0f};
+        glm::vec4 endColor{0.3f, 0.1f, 0.6f, 0.0f};
+        float rate = 100000.0f;
+        float speed = 0.5f;
+        float spread = 3.14159265f;
+        float minLifetime = 1.0f;
+        float maxLifetime = 3.0f;
+        float size = 0.004f;
+        bool softEdge = true; // Selects the SOFT_EDGE variant when the draw is recorded //
+    };
+
+    // GPU particle simulation. Particles live in device-local storage buffers and are only ever touched by //
+    // compute shaders: emission pops indices off a dead list, simulation ping-pongs between two alive lists //
+    // (compacting survivors, returning the dead), and the draw arguments are written on the GPU. The CPU //
+    // only fills a small parameter block per frame, so the per-frame cost does not depend on particle count. //
+    // Which alive list is current is kept on the GPU too, so the recorded commands are the same every frame. //
+    // With a dedicated compute family the simulation is recorded into its own command buffer for the async //
+    // compute queue; the shared buffers are then handed between the families every frame. //
+    class ParticleSystem {
+        private:
+            struct ParticleParameters {
+                glm::vec2 emitterPosition;
+                glm::vec2 gravity;
+                glm::vec4 startColor;
+                glm::vec4 endColor;
+                float deltaTime;
+                uint32_t emitCount;
+                uint32_t seed;
+                float speed;
+                float spread;
+                float minLifetime;
+                float maxLifetime;
+                float size;
+            };
+
+            struct ParticlePushConstantData {
+                uint32_t stateBuffer;
+                uint32_t particleBuffer;
+                uint32_t deadBuffer;
+                uint32_t aliveBuffer;
+                uint32_t parameterBuffer;
+                uint32_t maxParticles;
+            };
+
+            struct StorageBuffer {
+                VkBuffer buffer = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                void *mapped = nullptr;
+                uint32_t bindlessIndex = BindlessTable::INVALID_INDEX;
+            };
+
+            Device &_device;
+            BindlessTable &_bindlessTable;
+            uint32_t _maxParticles;
+            ParticleEmitter _emitter;
+            float _emitAccumulator = 0.0f;
+            uint32_t _frameSeed = 0;
+            uint32_t _graphicsFamily;
+            uint32_t _computeFamily;
+
+            StorageBuffer _stateBuffer;
+            StorageBuffer _particleBuffer;
+            StorageBuffer _deadBuffer;
+            StorageBuffer _aliveBuffer;
+            std::vector<StorageBuffer> _parameterBuffers;
+
+            VkPipelineLayout _pipelineLayout;
+            std::unique_ptr<ComputePipeline> _initPipeline;
+            std::unique_ptr<ComputePipeline> _emitPipeline;
+            std::unique_ptr<ComputePipeline> _preparePipeline;
+            std::unique_ptr<ComputePipeline> _simulatePipeline;
+            std::unique_ptr<ComputePipeline> _finishPipeline;
+            std::array<Pipeline *, 2> _renderPipelines{};
+
+            void createStorageBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, StorageBuffer &storageBuffer);
+            void destroyStorageBuffer(StorageBuffer &storageBuffer);
+            void createPipelineLayout();
+            void createComputePipelines();
+            void initializeLists();
+            void pushConstants(VkCommandBuffer commandBuffer, uint32_t parameterBuffer);
+            static void computeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+            void transferOwnership(VkCommandBuffer commandBuffer, uint32_t srcFamily, uint32_t dstFamily, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+        public:
+            static constexpr uint32_t DEFAULT_MAX_PARTICLES = 1u << 20;
+            static constexpr uint32_t MAX_EMIT_PER_FRAME = 1u << 16;
+            static constexpr uint32_t WORKGROUP_SIZE = 64;
+            static constexpr VkDeviceSize PARTICLE_SIZE = 48;
+            static constexpr VkDeviceSize STATE_SIZE = 48;
+            static constexpr VkDeviceSize DISPATCH_ARGUMENTS_OFFSET = 16;
+            static constexpr VkDeviceSize DRAW_ARGUMENTS_OFFSET = 32;
+            static constexpr VkPipelineStageFlags DRAW_STAGES = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+
+            ParticleSystem(Device &device, BindlessTable &bindlessTable, uint32_t maxParticles = DEFAULT_MAX_PARTICLES);
+            void createPipelines(const SwapChainTargets &targets, ShaderVariantCache &shaderVariants);
+            void createFrameParameters(size_t frameCount);
+            void setEmitter(const ParticleEmitter &emitter);
+            void update(size_t frameIndex, float deltaTime);
+            void recordSimulation(VkCommandBuffer commandBuffer, size_t frameIndex);
+            void recordGraphicsAcquire(VkCommandBuffer commandBuffer);
+            void recordDraw(VkCommandBuffer commandBuffer, size_t frameIndex);
+            void recordGraphicsRelease(VkCommandBuffer commandBuffer);
+            bool usesAsyncCompute();
+            uint32_t getMaxParticles();
+            ~ParticleSystem();
+
+            // Remove the copy operators to prevent make copies //
+            ParticleSystem(const ParticleSystem &) = delete;
+            ParticleSystem &operator=(const ParticleSystem &) = delete;
+    };
+
+}
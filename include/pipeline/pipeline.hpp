@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../devices/device.hpp"
+#include "shader_registry.hpp"
 #include <string>
 #include <vector>
 
@@ -8,6 +9,8 @@ namespace vulkan {
 
     struct PipelineConfigurationInformation {
 
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
         VkPipelineViewportStateCreateInfo viewportInformation;
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyInformation;
         VkPipelineRasterizationStateCreateInfo rasterizationInformation;
@@ -20,6 +23,13 @@ namespace vulkan {
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
+
+        // Dynamic rendering: used instead of renderPass when it is null //
+        std::vector<VkFormat> colorAttachmentFormats;
+        VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+        // Specialization constants, applied to both stages; only needs to live through pipeline creation //
+        const VkSpecializationInfo *specializationInformation = nullptr;
     };
 
     class Pipeline {
@@ -29,11 +39,10 @@ namespace vulkan {
             VkShaderModule _vertShaderModule;
             VkShaderModule _fragShaderModule;
 
-            static std::vector<char> readFile(const std::string &filePath);
-            void createShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule);
+            void createShaderModule(const ShaderCode &code, VkShaderModule *shaderModule);
 
         public:
-            Pipeline(Device &device, const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigurationInformation &configurationInformation);
+            Pipeline(Device &device, const std::string &vertShader, const std::string &fragShader, const PipelineConfigurationInformation &configurationInformation);
             static void defaultPipelineConfigurationInformation(PipelineConfigurationInformation &configurationInformation);
             void bind(VkCommandBuffer commandbuffer);
             ~Pipeline();
@@ -0,0 +1,50 @@
+#pragma once
+
+// STD include //
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vulkan {
+
+    // One SPIR-V module compiled into the executable; the table is generated by embed_shaders.sh //
+    struct EmbeddedShader {
+        const char *name;
+        const uint32_t *code;
+        size_t wordCount;
+    };
+
+    extern const EmbeddedShader EMBEDDED_SHADERS[];
+    extern const size_t EMBEDDED_SHADER_COUNT;
+    extern const unsigned char EMBEDDED_MANIFEST[];
+
+    // Points into the executable for embedded shaders; an override read from disk is owned by `storage`, //
+    // so the code lives as long as any copy of it //
+    struct ShaderCode {
+        const uint32_t *code;
+        size_t size;
+        std::shared_ptr<const std::vector<uint32_t>> storage;
+    };
+
+    // Looks shaders up by name ("sprite.frag" for shaders/sprite.frag). Shaders are embedded in the //
+    // executable, so creating pipelines reads no file. For development, setting VULKAN_SHADER_DIR loads //
+    // "<dir>/<name>.spv" from disk instead. The shader variant manifest is embedded and overridden the //
+    // same way. Under the override, changed sources can be recompiled in place with compileShader. //
+    class ShaderRegistry {
+        private:
+            static std::vector<uint32_t> readFile(const std::string &filePath);
+
+        public:
+            static constexpr const char *OVERRIDE_VARIABLE = "VULKAN_SHADER_DIR";
+            static constexpr const char *MANIFEST_NAME = "shader_variants.manifest";
+            static constexpr const char *COMPILER = "glslc";
+
+            static ShaderCode getShader(const std::string &name);
+            static std::string getManifest();
+            static const char *getOverrideDirectory();
+            static void compileShader(const std::string &sourcePath);
+    };
+
+}
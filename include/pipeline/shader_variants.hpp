@@ -0,0 +1,113 @@
+#pragma once
+
+// Code include //
+#include "../core/resource_pool.hpp"
+#include "../devices/device.hpp"
+#include "../devices/deletion_queue.hpp"
+#include "pipeline.hpp"
+
+// STD include //
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vulkan {
+
+    // A feature is a boolean specialization constant the shader declares with `layout(constant_id = N)` //
+    struct ShaderFeature {
+        std::string name;
+        uint32_t constantId;
+        uint32_t defaultValue;
+    };
+
+    struct ShaderProgram {
+        std::string name;
+        std::string vertShader;
+        std::string fragShader;
+        std::vector<ShaderFeature> features;
+    };
+
+    // The feature values of one variant. Every feature of the program is always specialized, so two //
+    // permutations with the same values hash the same whatever order they were set in. //
+    class ShaderPermutation {
+        private:
+            const ShaderProgram *_program;
+            std::vector<VkSpecializationMapEntry> _entries;
+            std::vector<uint32_t> _values;
+
+        public:
+            ShaderPermutation(const ShaderProgram &program);
+            ShaderPermutation &set(const std::string &feature, bool enabled);
+            bool isEnabled(const std::string &feature) const;
+            uint64_t hash() const;
+            VkSpecializationInfo getSpecializationInformation() const;
+            const ShaderProgram &getProgram() const;
+    };
+
+    // Programs and their features, parsed from the text manifest ShaderRegistry provides: //
+    //     program <name> <vertex shader> <fragment shader> //
+    //     feature <NAME> <constant_id> [default] //
+    // Features belong to the last program declared. The variants of a program are every combination of //
+    // its features. //
+    class ShaderManifest {
+        private:
+            std::unordered_map<std::string, ShaderProgram> _programs;
+
+        public:
+            static constexpr size_t MAX_FEATURES = 8;
+
+            ShaderManifest(const std::string &text);
+            const ShaderProgram &getProgram(const std::string &name) const;
+            std::vector<ShaderPermutation> enumeratePermutations(const std::string &name) const;
+    };
+
+    using PipelineHandle = Handle<Pipeline>;
+
+    // Built pipelines keyed by permutation hash, mixed with a caller key for the fixed-function state //
+    // (blend mode, ...). Branches on features are resolved when the pipeline is compiled, and selecting //
+    // a variant at draw time is a hash lookup, or a pool index for a caller that kept its handle. //
+    // Pipelines may be requested from several threads at once; they compile outside the lock. //
+    // For hot reload, the variants using a changed shader can be rebuilt in the background and swapped //
+    // in later: handles follow the swap, while the references handed out stay on the old pipelines until //
+    // swapRebuilt, so those callers fetch them again after it. Clearing the cache stales every handle. //
+    class ShaderVariantCache {
+        private:
+            struct Variant {
+                std::unique_ptr<Pipeline> pipeline;
+                ShaderPermutation permutation;
+                PipelineConfigurationInformation configuration;
+            };
+
+            Device &_device;
+            const ShaderManifest &_manifest;
+            std::mutex _mutex;
+            ResourcePool<Variant, Pipeline> _variants;
+            std::unordered_map<uint64_t, PipelineHandle> _pipelines;
+            std::unordered_map<uint64_t, std::unique_ptr<Pipeline>> _rebuilt;
+            uint64_t _generation = 0;
+
+            static uint64_t makeKey(const ShaderPermutation &permutation, uint64_t stateKey);
+            std::unique_ptr<Pipeline> createPipeline(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation);
+
+        public:
+            ShaderVariantCache(Device &device, const ShaderManifest &manifest);
+            PipelineHandle getVariant(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey = 0);
+            Pipeline *getPipeline(PipelineHandle handle);
+            Pipeline &getPipeline(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey = 0);
+            void warm(const std::string &program, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey = 0);
+            const ShaderManifest &getManifest() const;
+            size_t getVariantCount();
+            std::vector<std::string> getShaderNames();
+            size_t rebuild(const std::string &shader);
+            bool swapRebuilt(DeletionQueue &deletionQueue);
+            void clear();
+
+            // Remove the copy operators to prevent make copies //
+            ShaderVariantCache(const ShaderVariantCache &) = delete;
+            ShaderVariantCache &operator=(const ShaderVariantCache &) = delete;
+    };
+
+}
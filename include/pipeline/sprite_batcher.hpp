@@ -0,0 +1,118 @@
+#pragma once
+
+// Code include //
+#include "../core/frame_arena.hpp"
+#include "../core/job_system.hpp"
+#include "../descriptors/bindless_table.hpp"
+#include "../devices/device.hpp"
+#include "dynamic_buffer.hpp"
+#include "pipeline.hpp"
+#include "shader_variants.hpp"
+#include "swap_chain.hpp"
+
+// GLM include //
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// STD include //
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vulkan {
+
+    enum class SpriteBlend : uint8_t {
+        Opaque,
+        Alpha,
+        Additive
+    };
+
+    struct Sprite {
+        glm::vec2 position{0.0f, 0.0f};
+        glm::vec2 size{1.0f, 1.0f};
+        float rotation = 0.0f;
+        glm::vec4 uvRect{0.0f, 0.0f, 1.0f, 1.0f};
+        glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};
+        uint32_t texture = 0;
+        uint16_t layer = 0;
+        SpriteBlend blend = SpriteBlend::Alpha;
+    };
+
+    // Collects sprites for a frame and draws them as instanced quads. //
+    // Sprites are radix sorted by layer, blend mode and texture in the frame arena, packed in parallel into //
+    // a mapped instance buffer and drawn with one instanced draw per run of equal blend mode: textures come //
+    // from the bindless table, so a texture change never splits a draw. Nothing is allocated for the //
+    // sprites until the first one is submitted. //
+    class SpriteBatcher {
+        private:
+            struct SpriteInstance {
+                glm::vec2 position;
+                glm::vec2 size;
+                uint16_t uvRect[4];
+                uint32_t color;
+                float rotation;
+                uint32_t texture;
+            };
+
+            struct SpriteDraw {
+                SpriteBlend blend;
+                uint32_t firstInstance;
+                uint32_t instanceCount;
+            };
+
+            struct ViewPushConstantData {
+                glm::vec2 scale;
+                glm::vec2 translation;
+            };
+
+            static constexpr size_t BLEND_COUNT = 3;
+
+            Device &_device;
+            JobSystem &_jobSystem;
+            BindlessTable &_bindlessTable;
+            uint32_t _maxSprites;
+            uint32_t _frameIndex = 0;
+            std::unique_ptr<DynamicBuffer> _instanceBuffer;
+            VkPipelineLayout _pipelineLayout;
+            std::array<Pipeline *, BLEND_COUNT> _pipelines{};
+
+            std::vector<Sprite> _sprites;
+            std::vector<SpriteDraw> _draws;
+            DynamicAllocation _instances{};
+            ViewPushConstantData _view{{1.0f, 1.0f}, {0.0f, 0.0f}};
+            bool _overflowReported = false;
+
+            void createPipelineLayout();
+            void allocateSprites();
+            void sortSprites(FrameArenas &frameArenas, FrameVector<uint64_t> &keys, FrameVector<uint32_t> &order);
+            void writeInstances(const FrameVector<uint32_t> &order);
+            void buildDraws(const FrameVector<uint64_t> &keys);
+            static uint64_t makeKey(const Sprite &sprite);
+            static SpriteInstance packInstance(const Sprite &sprite);
+
+        public:
+            // 36 bytes of instance data each, per frame in flight //
+            static constexpr uint32_t DEFAULT_MAX_SPRITES = 1u << 16;
+            static constexpr uint32_t PARALLEL_BATCH_SIZE = 16384;
+
+            SpriteBatcher(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, uint32_t maxSprites = DEFAULT_MAX_SPRITES);
+            void createPipelines(const SwapChainTargets &targets, ShaderVariantCache &shaderVariants);
+            void beginFrame(uint32_t frameIndex);
+            bool submit(const Sprite &sprite);
+            bool submit(const Sprite *sprites, uint32_t count);
+            void setView(glm::vec2 scale, glm::vec2 translation);
+            void prepare(FrameArenas &frameArenas);
+            void record(VkCommandBuffer commandBuffer);
+            bool isEmpty();
+            uint32_t getSpriteCount();
+            uint32_t getDrawCount();
+            ~SpriteBatcher();
+
+            // Remove the copy operators to prevent make copies //
+            SpriteBatcher(const SpriteBatcher &) = delete;
+            SpriteBatcher &operator=(const SpriteBatcher &) = delete;
+    };
+
+}
@@ -13,20 +13,50 @@
 
 namespace vulkan {
 
+    // How many depth attachments back the swap-chain. One image is enough while every pass touching depth //
+    // runs on the graphics queue, since the render pass dependency orders consecutive frames; the other //
+    // modes exist for frame structures that overlap frames across queues. //
+    enum class DepthSharing {
+        PerSwapChainImage,
+        PerFrameInFlight,
+        Single
+    };
+
+    // What pipelines drawing into the swap-chain are built against. With dynamic rendering it is known //
+    // before the swap-chain exists: the formats only depend on the surface and the device. //
+    struct SwapChainTargets {
+        bool dynamicRendering;
+        VkFormat colorFormat;
+        VkFormat depthFormat;
+        VkRenderPass renderPass;
+    };
+
     class SwapChain {
         private:
             Device &_device;
+            DepthSharing _depthSharing;
             VkExtent2D _windowExtent;
             VkExtent2D _swapChainExtent;
             VkSwapchainKHR _swapChain;
             VkFormat _swapChainImageFormat;
-            VkRenderPass _renderPass;
+            VkFormat _swapChainDepthFormat;
+            bool _dynamicRendering;
+            bool _dynamicResolution;
+            VkExtent2D _renderExtent;
+            VkRenderPass _renderPass = VK_NULL_HANDLE;
             std::shared_ptr<SwapChain> _oldSwapChain;
 
             std::vector<VkFramebuffer> _swapChainFramebuffers;
             std::vector<VkImage> _depthImages;
             std::vector<VkDeviceMemory> _depthImageMemories;
             std::vector<VkImageView> _depthImageViews;
+            bool _depthLazilyAllocated = false;
+            bool _depthSampled = false;
+            // Layout transitions of a depth format with stencil must cover both planes //
+            VkImageAspectFlags _depthAspects = VK_IMAGE_ASPECT_DEPTH_BIT;
+            VkImage _sceneImage = VK_NULL_HANDLE;
+            VkDeviceMemory _sceneImageMemory = VK_NULL_HANDLE;
+            VkImageView _sceneImageView = VK_NULL_HANDLE;
             std::vector<VkImage> _swapChainImages;
             std::vector<VkImageView> _swapChainImageViews;
             std::vector<VkSemaphore> _imageAvailableSemaphores;
@@ -35,36 +65,75 @@ namespace vulkan {
             std::vector<VkFence> _imagesInFlight;
             
             size_t _currentFrame = 0;
+            // Of the last present, counting from 1; ids are per swap-chain //
+            uint64_t _presentId = 0;
 
             void init();
             void createSwapChain();
             void createImageViews();
             void createDepthResources();
+            void createSceneResources();
+            void blitScene(VkCommandBuffer commandBuffer, int imageIndex);
+            bool checkDynamicResolutionSupport(const VkSurfaceCapabilitiesKHR &capabilities, VkFormat format);
             void createRenderPass();
             void createFramebuffers();
             void createSyncObjects();
+            bool supportsLazilyAllocated(const VkImageCreateInfo &imageInfo);
+            size_t getDepthImageCount(DepthSharing depthSharing);
+            size_t getDepthIndex(int imageIndex);
+            void reportDepthMemory(VkDeviceSize imageSize);
 
-            VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
+            static VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
+            static VkFormat findDepthFormat(Device &device);
             VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes);
             VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
 
         public:
             static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-            SwapChain(Device &deviceRef, VkExtent2D windowExtent);
-            SwapChain(Device &deviceRef, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previous);
+            // Render into an offscreen target scaled by setRenderExtent and blit it into the swap-chain image. //
+            // Needs dynamic rendering; the render pass path always renders at the swap-chain extent. //
+            const bool enableDynamicResolution = true;
+            // Store depth and make it sampleable between suspendRendering and resumeRendering, for the Hi-Z //
+            // pyramid. Also needs dynamic rendering and drawIndirectFirstInstance, and costs the lazily //
+            // allocated depth on tile-based GPUs. //
+            const bool enableDepthSampling = true;
+            // Present in FIFO order for FramePacer to time frames against the display, rather than racing //
+            // ahead with mailbox or immediate presents whose latency is neither bounded nor measured //
+            const bool enableFramePacing = true;
+
+            SwapChain(Device &deviceRef, VkExtent2D windowExtent, DepthSharing depthSharing = DepthSharing::Single);
+            SwapChain(Device &deviceRef, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previous, DepthSharing depthSharing = DepthSharing::Single);
             VkFramebuffer getFrameBuffer(int index);
             VkRenderPass getRenderPass();
             VkImageView getImageView(int index);
             size_t getImageCount();
+            size_t getCurrentFrame();
             VkFormat getSwapChainImageFormat();
+            VkFormat getSwapChainDepthFormat();
+            bool usesDynamicRendering();
+            bool usesDynamicResolution();
+            bool usesDepthSampling();
+            VkImageView getDepthImageView(int imageIndex);
+            size_t getDepthSlot();
+            void setRenderExtent(VkExtent2D extent);
+            VkExtent2D getRenderExtent();
+            bool compareSwapFormats(const SwapChain &swapChain) const;
+            SwapChainTargets getTargets();
+            static SwapChainTargets queryTargets(Device &device);
+            void beginRendering(VkCommandBuffer commandBuffer, int imageIndex, const VkClearValue &colorClear, const VkClearValue &depthClear);
+            void suspendRendering(VkCommandBuffer commandBuffer, int imageIndex);
+            void resumeRendering(VkCommandBuffer commandBuffer, int imageIndex);
+            void endRendering(VkCommandBuffer commandBuffer, int imageIndex);
             VkExtent2D getSwapChainExtent();
             uint32_t getWidth();
             uint32_t getHeight();
             float extentAspectRatio();
             VkFormat findDepthFormat();
             VkResult acquireNextImage(uint32_t *imageIndex);
-            VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
+            VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStage = 0, VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+            uint64_t getPresentId();
+            VkResult waitForPresent(uint64_t presentId, uint64_t timeout);
             ~SwapChain();
 
             // Remove the copy operators to prevent make copies //
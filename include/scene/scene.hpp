@@ -0,0 +1,133 @@
+#pragma once
+
+// Code include //
+#include "../core/mapped_file.hpp"
+#include "../pipeline/model.hpp"
+
+// GLM include //
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// STD include //
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vulkan {
+
+    // The file is a header followed by sections of fixed-size records, each at an 8-byte aligned offset. //
+    // Records refer to each other by index and to strings by offset into the string section, never by //
+    // pointer, so a mapped file is used as is. Everything is little-endian. //
+    enum SceneSectionType : uint32_t {
+        SCENE_VERTICES,
+        SCENE_LODS,
+        SCENE_MESHES,
+        SCENE_MATERIALS,
+        SCENE_TRANSFORMS,
+        SCENE_ENTITIES,
+        SCENE_STRINGS,
+        SCENE_SECTION_COUNT
+    };
+
+    struct SceneSection {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct SceneHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        // Of every byte after the header //
+        uint64_t contentHash;
+        SceneSection sections[SCENE_SECTION_COUNT];
+    };
+
+    // Relative to the parent entity's transform, if any //
+    struct SceneTransform {
+        glm::vec2 position;
+        float scale;
+        float depth;
+    };
+
+    struct SceneMaterial {
+        glm::vec3 color;
+        // Offset of a texture path in the string section, or Scene::INVALID_INDEX //
+        uint32_t textureName;
+    };
+
+    // Meshes are ranges of the level-of-detail section, whose levels are ranges of the vertex section //
+    struct SceneEntity {
+        // An earlier entity, or Scene::INVALID_INDEX //
+        uint32_t parent;
+        uint32_t transform;
+        uint32_t mesh;
+        uint32_t material;
+    };
+
+    template <typename T>
+    struct SceneArray {
+        const T *data = nullptr;
+        uint32_t count = 0;
+
+        const T &operator[](uint32_t index) const { return data[index]; }
+        const T *begin() const { return data; }
+        const T *end() const { return data + count; }
+    };
+
+    // What Scene::serialize lays out into a file, built in code //
+    struct SceneData {
+        std::vector<Model::Vertex> vertices;
+        std::vector<ModelLod> lods;
+        std::vector<ModelMesh> meshes;
+        std::vector<SceneMaterial> materials;
+        std::vector<SceneTransform> transforms;
+        std::vector<SceneEntity> entities;
+        std::string strings;
+    };
+
+    // A scene used in place from its file mapping. Every offset, count and index is validated, and the //
+    // content hashed, once on load; after that the accessors hand out the records without any checks. //
+    class Scene {
+        private:
+            std::unique_ptr<MappedFile> _file;
+            std::vector<uint8_t> _bytes;
+            const uint8_t *_data = nullptr;
+            size_t _size = 0;
+            std::string _name;
+
+            void validate();
+            template <typename T>
+            SceneArray<T> getSection(SceneSectionType type) const;
+
+        public:
+            static constexpr uint32_t MAGIC = 0x4E435356; // "VSCN" //
+            static constexpr uint32_t VERSION = 1;
+            static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+            static constexpr const char *DEFAULT_PATH = "default.vscn";
+            static constexpr const char *OVERRIDE_VARIABLE = "VULKAN_SCENE";
+
+            Scene(const std::string &filePath);
+            Scene(std::vector<uint8_t> bytes);
+            SceneArray<Model::Vertex> getVertices() const;
+            SceneArray<ModelLod> getLods() const;
+            SceneArray<ModelMesh> getMeshes() const;
+            SceneArray<SceneMaterial> getMaterials() const;
+            SceneArray<SceneTransform> getTransforms() const;
+            SceneArray<SceneEntity> getEntities() const;
+            const char *getString(uint32_t offset) const;
+
+            static const char *getPath();
+            static uint64_t hashContent(const uint8_t *data, size_t size);
+            static std::vector<uint8_t> serialize(const SceneData &data);
+            static void write(const std::string &filePath, const std::vector<uint8_t> &bytes);
+
+            // Remove the copy operators to prevent make copies //
+            Scene(const Scene &) = delete;
+            Scene &operator=(const Scene &) = delete;
+    };
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// Code include //
+#include "../core/job_system.hpp"
+#include "scene.hpp"
+
+// STD include //
+#include <cstdint>
+#include <vector>
+
+namespace vulkan {
+
+    // World transforms of the scene entities, resolved through their parents. Nodes are stored by depth in //
+    // the tree, one array per component, so each level is a contiguous range whose parents all lie in the //
+    // levels before it: levels are resolved in order, and the nodes of a level, from whichever subtrees, in //
+    // parallel batches eight at a time (AVX2 when the CPU has it). Within a level, nodes are ordered by //
+    // parent, so a subtree is one contiguous range per level. Each level keeps the range of its changed //
+    // nodes, widened by the children of the level above's range: only that range is visited, and only its //
+    // nodes whose local transform or an ancestor's changed are recomputed. //
+    class TransformHierarchy {
+        private:
+            JobSystem &_jobSystem;
+            // Node of each entity, entity of each node, and parent node of each node //
+            std::vector<uint32_t> _nodes;
+            std::vector<uint32_t> _entities;
+            std::vector<uint32_t> _parents;
+            // Children of node n are the nodes from _childStarts[n] to _childStarts[n + 1] //
+            std::vector<uint32_t> _childStarts;
+            std::vector<uint32_t> _levelStarts;
+            // Node range of each level changed since the last update, empty when begin >= end //
+            std::vector<uint32_t> _dirtyBegins;
+            std::vector<uint32_t> _dirtyEnds;
+            std::vector<float> _localX;
+            std::vector<float> _localY;
+            std::vector<float> _localScale;
+            std::vector<float> _localDepth;
+            std::vector<float> _worldX;
+            std::vector<float> _worldY;
+            std::vector<float> _worldScale;
+            std::vector<float> _worldDepth;
+            // All bits set when the node must be recomputed, so the kernels use them as lane masks //
+            std::vector<uint32_t> _dirty;
+            bool _changed = false;
+            bool _avx2Supported;
+            // First node of the range being resolved: the batch functions capture only this, so they fit //
+            // in std::function without allocating //
+            uint32_t _rangeBegin = 0;
+
+            void updateRoots(uint32_t begin, uint32_t end);
+            void updateChildren(uint32_t begin, uint32_t end);
+            void updateChildrenAvx2(uint32_t begin, uint32_t end);
+
+        public:
+            static constexpr uint32_t PARALLEL_BATCH_SIZE = 16384;
+
+            TransformHierarchy(JobSystem &jobSystem);
+            void build(SceneArray<SceneEntity> entities, SceneArray<SceneTransform> transforms, uint32_t entityCount);
+            void setLocal(uint32_t entity, const SceneTransform &transform);
+            void update();
+            SceneTransform getWorld(uint32_t entity) const;
+            uint32_t getNodeCount() const;
+            uint32_t getLevelCount() const;
+
+            // Remove the copy operators to prevent make copies //
+            TransformHierarchy(const TransformHierarchy &) = delete;
+            TransformHierarchy &operator=(const TransformHierarchy &) = delete;
+    };
+
+}
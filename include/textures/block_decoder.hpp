@@ -0,0 +1,20 @@
+#pragma once
+
+// Vulkan include //
+#include <vulkan/vulkan.h>
+
+// STD include //
+#include <cstdint>
+
+namespace vulkan {
+
+    // CPU transcoder from block-compressed formats to RGBA8, used when the device cannot sample the //
+    // compressed format directly. Supports BC1/BC3/BC4/BC5/BC7 and ETC2 (RGB, RGB A1, RGBA with EAC alpha). //
+    class BlockDecoder {
+        public:
+            static bool canDecode(VkFormat format);
+            static VkFormat getDecodedFormat(VkFormat format);
+            static void decodeLevel(VkFormat format, const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *pixels);
+    };
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Vulkan include //
+#include <vulkan/vulkan.h>
+
+// STD include //
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vulkan {
+
+    struct FormatBlockInfo {
+        uint32_t blockWidth = 1;
+        uint32_t blockHeight = 1;
+        uint32_t bytesPerBlock = 4;
+    };
+
+    struct DecodedMipLevel {
+        const uint8_t *data;
+        VkDeviceSize size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // CPU side result of a decode, levels[0] being mip `baseLevel` of the full chain. //
+    // Pixel memory is owned by `storage`, which may be a heap buffer or a file mapping. //
+    struct DecodedImage {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+        uint32_t baseLevel = 0;
+        bool generateMipmaps = false;
+        std::vector<DecodedMipLevel> levels;
+        std::shared_ptr<const void> storage;
+    };
+
+    class ImageDecoder {
+        public:
+            using DecodeFunction = std::function<DecodedImage(const std::string &filePath, uint32_t maxDimension)>;
+
+            static void registerDecoder(const std::string &extension, DecodeFunction decoder);
+            static DecodedImage decode(const std::string &filePath, uint32_t maxDimension);
+            static DecodedImage decodePPM(const std::string &filePath, uint32_t maxDimension);
+            static void buildMipChain(DecodedImage &image);
+            static void dropLevelsAbove(DecodedImage &image, uint32_t maxDimension);
+            static uint32_t fullMipLevelCount(uint32_t width, uint32_t height);
+            static FormatBlockInfo getFormatBlockInfo(VkFormat format);
+            static VkDeviceSize mipLevelSize(VkFormat format, uint32_t width, uint32_t height);
+            static VkDeviceSize mipChainSize(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount);
+    };
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+#include "image_decoder.hpp"
+
+// Vulkan include //
+#include <vulkan/vulkan.h>
+
+// STD include //
+#include <string>
+#include <unordered_map>
+
+namespace vulkan {
+
+    // Loads 2D KTX2 textures straight out of a memory mapping. Formats the device can sample are //
+    // uploaded as stored (levels point into the mapping); the others are transcoded to RGBA8 on the CPU. //
+    class Ktx2Loader {
+        private:
+            std::unordered_map<VkFormat, VkFormat> _uploadFormats;
+
+        public:
+            Ktx2Loader(Device &device);
+            DecodedImage load(const std::string &filePath, uint32_t maxDimension) const;
+            VkFormat getUploadFormat(VkFormat fileFormat) const;
+
+            static void registerDecoder(Device &device);
+    };
+
+}
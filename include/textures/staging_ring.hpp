@@ -0,0 +1,37 @@
+#pragma once
+
+// Code include //
+#include "../devices/device.hpp"
+
+// STD include //
+#include <cstdint>
+
+namespace vulkan {
+
+    // Persistently mapped upload buffer used as a FIFO: allocations retire in the order they were made. //
+    class StagingRing {
+        private:
+            Device &_device;
+            VkBuffer _buffer;
+            VkDeviceMemory _memory;
+            uint8_t *_mapped;
+            VkDeviceSize _size;
+            uint64_t _head = 0;
+            uint64_t _tail = 0;
+
+        public:
+            StagingRing(Device &device, VkDeviceSize size);
+            bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+            void release(uint64_t position);
+            uint64_t getHead();
+            uint8_t *getMapped();
+            VkBuffer getBuffer();
+            VkDeviceSize getSize();
+            ~StagingRing();
+
+            // Remove the copy operators to prevent make copies //
+            StagingRing(const StagingRing &) = delete;
+            StagingRing &operator=(const StagingRing &) = delete;
+    };
+
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+// Code include //
+#include "../core/job_system.hpp"
+#include "../devices/device.hpp"
+#include "../devices/deletion_queue.hpp"
+#include "../descriptors/bindless_table.hpp"
+#include "image_decoder.hpp"
+#include "staging_ring.hpp"
+
+// STD include //
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vulkan {
+
+    using TextureHandle = uint32_t;
+
+    // Streams textures into the bindless table without ever blocking the frame loop. //
+    // Files are decoded as jobs on the engine job system, uploaded through a staging ring on the transfer queue and //
+    // mipmapped on the GPU. Every texture starts with a small mip tail resident and climbs one level at //
+    // a time while it keeps being used; when over budget the least recently used ones lose their top mip. //
+    class TextureStreamer {
+        public:
+            struct Settings {
+                VkDeviceSize memoryBudget = 256ull * 1024 * 1024;
+                VkDeviceSize stagingBufferSize = 32ull * 1024 * 1024;
+                VkDeviceSize maxUploadBytesPerFrame = 8ull * 1024 * 1024;
+                uint32_t initialResidentDimension = 64;
+                uint32_t maxPendingDecodes = 8;
+                uint64_t residencyWindowFrames = 120;
+            };
+
+            struct Statistics {
+                VkDeviceSize residentBytes;
+                VkDeviceSize memoryBudget;
+                uint32_t textureCount;
+                uint32_t fullyResidentCount;
+                uint32_t pendingDecodes;
+                uint32_t uploadsInFlight;
+            };
+
+            static constexpr TextureHandle INVALID_TEXTURE = UINT32_MAX;
+
+        private:
+            enum class TextureState { Empty, Decoding, Uploading, Resident, Failed };
+
+            struct Texture {
+                std::string path;
+                bool inUse = false;
+                bool busy = false;
+                TextureState state = TextureState::Empty;
+                uint32_t serial = 0;
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                uint32_t width = 0;
+                uint32_t height = 0;
+                uint32_t mipLevels = 0;
+                uint32_t minimumResidentLevel = 0;
+                uint32_t residentLevel = UINT32_MAX;
+                uint32_t bestLevel = 0;
+                VkImage image = VK_NULL_HANDLE;
+                VkDeviceMemory memory = VK_NULL_HANDLE;
+                VkImageView view = VK_NULL_HANDLE;
+                VkDeviceSize residentBytes = 0;
+                VkDeviceSize reservedBytes = 0;
+                uint32_t bindlessIndex = BindlessTable::INVALID_INDEX;
+                uint64_t lastUsedFrame = 0;
+            };
+
+            struct DecodeResult {
+                TextureHandle texture;
+                uint32_t serial;
+                DecodedImage image;
+                std::string error;
+            };
+
+            struct ResidencyChange {
+                TextureHandle texture;
+                uint32_t serial;
+                uint32_t residentLevel;
+                VkImage image;
+                VkDeviceMemory memory;
+                VkImageView view;
+                VkDeviceSize bytes;
+            };
+
+            struct GpuBatch {
+                VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+                VkCommandBuffer graphicsCommandBuffer = VK_NULL_HANDLE;
+                VkSemaphore ownershipSemaphore = VK_NULL_HANDLE;
+                VkFence fence = VK_NULL_HANDLE;
+                uint64_t stagingEnd = 0;
+                bool inFlight = false;
+                std::vector<ResidencyChange> changes;
+            };
+
+            static constexpr size_t BATCH_COUNT = 4;
+
+            Device &_device;
+            JobSystem &_jobSystem;
+            BindlessTable &_bindlessTable;
+            DeletionQueue &_deletionQueue;
+            Settings _settings;
+            StagingRing _stagingRing;
+            VkCommandPool _graphicsCommandPool;
+            VkCommandPool _transferCommandPool = VK_NULL_HANDLE;
+            QueueFamilyIndices _queueFamilies;
+            VkSampler _sampler;
+            bool _gpuMipmapsSupported;
+
+            VkImage _defaultImage;
+            VkDeviceMemory _defaultMemory;
+            VkImageView _defaultView;
+            uint32_t _defaultIndex;
+
+            std::vector<Texture> _textures;
+            std::vector<TextureHandle> _freeTextures;
+            std::vector<DecodeResult> _readyUploads;
+            std::vector<DecodeResult> _collectedResults;
+            std::vector<VkDeviceSize> _levelOffsets;
+            std::vector<TextureHandle> _evictionCandidates;
+            std::array<GpuBatch, BATCH_COUNT> _batches;
+            VkDeviceSize _residentBytes = 0;
+            VkDeviceSize _reservedBytes = 0;
+            uint64_t _frame = 0;
+            uint32_t _pendingDecodes = 0;
+
+            JobCounter _decodeCounter;
+            std::mutex _resultMutex;
+            std::vector<DecodeResult> _decodeResults;
+
+            void createCommandPools();
+            void createBatches();
+            void createSampler();
+            void createDefaultTexture();
+            void decode(TextureHandle handle, uint32_t serial, const std::string &path, uint32_t maxDimension);
+            void requestDecode(TextureHandle handle, uint32_t maxDimension);
+            void collectDecodeResults();
+            void retireBatches();
+            void submitUploads(GpuBatch &batch);
+            void enforceBudget(GpuBatch &batch);
+            void scheduleUpgrades();
+            bool downgrade(TextureHandle handle, GpuBatch &batch, VkCommandBuffer commandBuffer);
+            GpuBatch *acquireBatch();
+            void beginBatch(GpuBatch &batch);
+            void submitBatch(GpuBatch &batch);
+            void createTextureImage(VkFormat format, uint32_t width, uint32_t height, uint32_t levels, VkImage &image, VkDeviceMemory &memory, VkImageView &view, VkDeviceSize &bytes);
+            void recordUpload(GpuBatch &batch, const DecodedImage &decoded, VkDeviceSize stagingOffset, const std::vector<VkDeviceSize> &levelOffsets, VkImage image, uint32_t levelCount);
+            void destroyLater(VkImage image, VkDeviceMemory memory, VkImageView view, uint32_t bindlessIndex);
+
+        public:
+            TextureStreamer(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, DeletionQueue &deletionQueue);
+            TextureStreamer(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, DeletionQueue &deletionQueue, const Settings &settings);
+            TextureHandle request(const std::string &filePath);
+            void release(TextureHandle handle);
+            void touch(TextureHandle handle);
+            void update();
+            uint32_t getBindlessIndex(TextureHandle handle);
+            bool isFullyResident(TextureHandle handle);
+            void setMemoryBudget(VkDeviceSize budget);
+            Statistics getStatistics();
+            ~TextureStreamer();
+
+            // Remove the copy operators to prevent make copies //
+            TextureStreamer(const TextureStreamer &) = delete;
+            TextureStreamer &operator=(const TextureStreamer &) = delete;
+    };
+
+}
@@ -2,38 +2,159 @@
 
 // Code include //
 #include "window.hpp"
+#include "../pipeline/dynamic_buffer.hpp"
+#include "../pipeline/dynamic_resolution.hpp"
+#include "../pipeline/frame_pacer.hpp"
+#include "../pipeline/particle_system.hpp"
 #include "../pipeline/pipeline.hpp"
+#include "../pipeline/shader_variants.hpp"
+#include "../pipeline/sprite_batcher.hpp"
 #include "../pipeline/swap_chain.hpp"
 #include "../pipeline/model.hpp"
+#include "../pipeline/occlusion_culler.hpp"
+#include "../scene/scene.hpp"
+#include "../scene/transform_hierarchy.hpp"
+#include "../core/asset_watcher.hpp"
+#include "../core/frame_arena.hpp"
+#include "../core/startup_timeline.hpp"
+#include "../core/job_system.hpp"
 #include "../devices/device.hpp"
+#include "../devices/deletion_queue.hpp"
+#include "../devices/gpu_resources.hpp"
+#include "../descriptors/bindless_table.hpp"
+#include "../textures/texture_streamer.hpp"
 
 // STD include //
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
+#include <cstdint>
 
 namespace vulkan {
 
+    // Per-frame values read by the cached command buffers instead of being recorded into them. The draw //
+    // data is written into the dynamic buffer each frame; the bindless index follows it there //
+    struct FrameData {
+        uint32_t bindlessIndex;
+        VkDeviceSize drawDataOffset;
+        // One indirect draw per object, with multi-draw indirect //
+        BufferHandle commands;
+    };
+
+    // Loaded on the job system while the window and device are created; the getters wait for it //
+    class StartupAssets {
+        private:
+            JobSystem &_jobSystem;
+            StartupTimeline &_startupTimeline;
+            JobCounter _loading;
+            std::unique_ptr<ShaderManifest> _shaderManifest;
+            std::unique_ptr<Scene> _scene;
+
+        public:
+            StartupAssets(JobSystem &jobSystem, StartupTimeline &startupTimeline);
+            const ShaderManifest &getShaderManifest();
+            std::unique_ptr<Scene> takeScene();
+            ~StartupAssets();
+
+            // Remove the copy operators to prevent make copies //
+            StartupAssets(const StartupAssets &) = delete;
+            StartupAssets &operator=(const StartupAssets &) = delete;
+    };
+
     class Application {
         private:
             static constexpr int WIDTH = 1920;
             static constexpr int HEIGHT = 1080;
+            static constexpr uint64_t WARMUP_FRAMES = 16;
+            // Evicted texture memory is freed through the deletion queue, and the driver reports it a little //
+            // later still: the texture budget is left alone this many frames after a change //
+            static constexpr uint64_t MEMORY_BUDGET_SETTLE_FRAMES = SwapChain::MAX_FRAMES_IN_FLIGHT + 4;
+            // Share of a heap's budget the texture budget may grow back into //
+            static constexpr float MEMORY_BUDGET_RESTORE_SHARE = 0.9f;
+            // Per frame in flight; holds the draw data of as many draws as the occlusion culler takes //
+            static constexpr VkDeviceSize DYNAMIC_BUFFER_SIZE = 4 * 1024 * 1024;
+            // The root entities scroll by SCROLL_SPEED units a second and jump back every SCROLL_PERIOD seconds //
+            static constexpr float SCROLL_SPEED = 0.3f;
+            static constexpr float SCROLL_PERIOD = 50.0f / 3.0f;
+            StartupTimeline _startupTimeline;
+            JobSystem _jobSystem;
+            StartupAssets _startupAssets{_jobSystem, _startupTimeline};
             Window _window{WIDTH, HEIGHT, "Vulkan Application"};
-            Device _device{_window};
+            Device _device{_window, &_startupTimeline};
+            BindlessTable _bindlessTable{_device};
+            ShaderVariantCache _shaderVariants{_device, _startupAssets.getShaderManifest()};
+            DeletionQueue _deletionQueue{SwapChain::MAX_FRAMES_IN_FLIGHT};
+            GpuResources _gpuResources{_device, _deletionQueue};
+            FrameArenas _frameArenas{SwapChain::MAX_FRAMES_IN_FLIGHT};
+            DynamicBuffer _dynamicBuffer{_device, DYNAMIC_BUFFER_SIZE, SwapChain::MAX_FRAMES_IN_FLIGHT};
+            SpriteBatcher _spriteBatcher{_device, _jobSystem, _bindlessTable};
+            ParticleSystem _particleSystem{_device, _bindlessTable};
+            OcclusionCuller _occlusionCuller{_device, _bindlessTable};
+            TextureStreamer _textureStreamer{_device, _jobSystem, _bindlessTable, _deletionQueue};
+            DynamicResolution _dynamicResolution{_device};
+            FramePacer _framePacer{_device};
             std::unique_ptr<SwapChain> _swapChain;
-            std::unique_ptr<Pipeline> _pipeline;
+            PipelineHandle _pipeline;
             VkPipelineLayout _pipelineLayout;
             std::vector<VkCommandBuffer> _commandBuffers;
-            std::unique_ptr<Model> _model;
-            std::vector<VkFence> _commandBufferFences;
+            std::vector<VkCommandBuffer> _computeCommandBuffers;
+            VkSemaphore _computeFinishedSemaphore = VK_NULL_HANDLE;
+            VkSemaphore _graphicsFinishedSemaphore = VK_NULL_HANDLE;
+            bool _graphicsFinishedPending = false;
+            std::shared_ptr<Model> _model;
+            std::shared_ptr<Scene> _scene;
+            uint32_t _drawCount = 0;
+            uint32_t _drawCapacity = 0;
+            std::vector<glm::vec2> _meshBoundsMin;
+            std::vector<glm::vec2> _meshBoundsMax;
+            TransformHierarchy _transforms{_jobSystem};
+            std::vector<uint32_t> _drawLods;
+            // Streamed texture of each scene material, or TextureStreamer::INVALID_TEXTURE //
+            std::vector<TextureHandle> _materialTextures;
+            std::vector<FrameData> _frameData;
+            std::vector<uint64_t> _recordedGenerations;
+            std::vector<size_t> _recordedDepthSlots;
+            uint64_t _sceneGeneration = 1;
+            std::chrono::steady_clock::time_point _lastFrameTime = std::chrono::steady_clock::now();
+            // Seconds since the scene was set, wrapped to SCROLL_PERIOD //
+            float _sceneTime = 0.0f;
+            uint64_t _frameCount = 0;
+            uint64_t _steadyFrames = 0;
+            uint64_t _steadyFrameAllocations = 0;
+            VkDeviceSize _baseTextureBudget = 0;
+            uint64_t _textureBudgetFrame = 0;
+            // Last, so its thread stops before anything it rebuilds is destroyed //
+            AssetWatcher _assetWatcher;
 
-            void loadModels();
+            void loadScene();
+            std::shared_ptr<Model> createSceneModel(const Scene &scene);
+            void setScene(std::shared_ptr<Scene> scene, std::shared_ptr<Model> model);
+            void requestMaterialTextures();
+            void watchAssets();
+            void reloadShader(const std::string &directory, const std::string &fileName);
+            void reloadScene(const std::string &filePath);
+            void watchMemoryBudget();
+            bool isDeviceLocalMemoryTight();
+            void reportMemory();
             void createPipelineLayout();
-            void createPipeline();
+            void createPipeline(const SwapChainTargets &targets);
+            void getPipelines(const SwapChainTargets &targets);
+            void createSwapChainAndPipelines();
+            VkExtent2D waitForExtent();
             void createCommandBuffers();
             void freeCommandBuffers();
+            void createComputeSemaphores();
+            void destroyComputeSemaphores();
+            void createFrameData();
+            void destroyFrameData();
+            void invalidateCommandBuffers();
+            void applyRenderScale();
+            void updateFrameData(int imageIndex);
             void drawFrame();
             void recreateSwapChain();
             void recordCommandBuffer(int imageIndex);
+            void bindModel(int imageIndex);
 
         public:
             Application();
@@ -0,0 +1,13 @@
+// Shared declarations of the bindless resource table (see BindlessTable). //
+// Include with: #extension GL_GOOGLE_include_directive : require //
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform sampler2D bindlessTextures[];
+
+// Storage buffers live in binding 1; each shader declares the block layout it reads, e.g. //
+// layout(set = 0, binding = 1) readonly buffer ObjectBuffer { ObjectData objects[]; } objectBuffers[]; //
+
+vec4 sampleBindless(uint textureIndex, vec2 uv) {
+    return texture(bindlessTextures[nonuniformEXT(textureIndex)], uv);
+}
@@ -0,0 +1,14 @@
+#version 450
+
+// Round, faded particles; without it each particle is a flat square //
+layout(constant_id = 0) const bool SOFT_EDGE = true;
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCorner;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float falloff = SOFT_EDGE ? 1.0 - smoothstep(0.5, 1.0, length(fragCorner)) : 1.0;
+    outColor = vec4(fragColor.rgb, fragColor.a * falloff);
+}
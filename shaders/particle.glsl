@@ -0,0 +1,88 @@
+// Shared declarations of the GPU particle system (see ParticleSystem). //
+// Every buffer is reached through the bindless table; define PARTICLE_ACCESS as readonly before //
+// including this from graphics stages. //
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef PARTICLE_ACCESS
+#define PARTICLE_ACCESS
+#endif
+
+#define PARTICLE_WORKGROUP_SIZE 64
+
+// 48 bytes, matches ParticleSystem::PARTICLE_SIZE //
+struct Particle {
+    vec2 position;
+    vec2 velocity;
+    vec4 color;
+    float age;
+    float lifetime;
+    float size;
+    float padding;
+};
+
+// Dispatch arguments at byte 16 and draw arguments at byte 32, see ParticleSystem //
+layout(set = 0, binding = 1) PARTICLE_ACCESS buffer ParticleStateBuffer {
+    uint current;
+    int deadCount;
+    uint aliveCount[2];
+    uvec4 dispatchArguments;
+    uvec4 drawArguments;
+} stateBuffers[];
+
+layout(set = 0, binding = 1) PARTICLE_ACCESS buffer ParticleBuffer {
+    Particle particles[];
+} particleBuffers[];
+
+layout(set = 0, binding = 1) PARTICLE_ACCESS buffer ParticleIndexBuffer {
+    uint indices[];
+} indexBuffers[];
+
+layout(set = 0, binding = 1) readonly buffer ParticleParameterBuffer {
+    vec2 emitterPosition;
+    vec2 gravity;
+    vec4 startColor;
+    vec4 endColor;
+    float deltaTime;
+    uint emitCount;
+    uint seed;
+    float speed;
+    float spread;
+    float minLifetime;
+    float maxLifetime;
+    float size;
+} parameterBuffers[];
+
+layout(push_constant) uniform Push {
+    uint stateBuffer;
+    uint particleBuffer;
+    uint deadBuffer;
+    uint aliveBuffer;
+    uint parameterBuffer;
+    uint maxParticles;
+} push;
+
+#define STATE stateBuffers[push.stateBuffer]
+#define PARTICLES particleBuffers[push.particleBuffer].particles
+#define DEAD_LIST indexBuffers[push.deadBuffer].indices
+#define ALIVE_LIST indexBuffers[push.aliveBuffer].indices
+#define PARAMETERS parameterBuffers[push.parameterBuffer]
+
+// Alive list `list` occupies [list * maxParticles, (list + 1) * maxParticles) of the alive buffer //
+uint aliveSlot(uint list, uint slot) {
+    return list * push.maxParticles + slot;
+}
+
+uint hash(uint value) {
+    value ^= value >> 16;
+    value *= 0x7feb352du;
+    value ^= value >> 15;
+    value *= 0x846ca68bu;
+    value ^= value >> 16;
+    return value;
+}
+
+float random01(inout uint state) {
+    state = hash(state);
+    return float(state) / 4294967295.0;
+}
@@ -0,0 +1,24 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define PARTICLE_ACCESS readonly
+#include "particle.glsl"
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCorner;
+
+const vec2 corners[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+// One instance per alive particle, fetched through the list the finish pass made current //
+void main() {
+    uint index = ALIVE_LIST[aliveSlot(STATE.current, gl_InstanceIndex)];
+    Particle particle = PARTICLES[index];
+
+    vec2 corner = corners[gl_VertexIndex];
+    gl_Position = vec4(particle.position + corner * particle.size, 0.0, 1.0);
+    fragColor = particle.color;
+    fragCorner = corner;
+}
@@ -1,12 +1,14 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout (location = 0) out vec4 outColor;
+#include "bindless.glsl"
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragUv;
+layout(location = 2) flat in uint fragTexture;
 
-layout(push_constant) uniform Push {
-    vec2 offset;
-    vec3 color;
-} push;
+layout (location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(push.color, 1.0);
+    outColor = vec4(fragColor, 1.0) * sampleBindless(fragTexture, fragUv);
 }
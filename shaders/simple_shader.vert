@@ -1,13 +1,38 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "bindless.glsl"
 
 layout(location = 0) in vec2 position;
 layout(location = 1) in vec3 color;
 
-layout(push_constant) uniform Push {
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;
+layout(location = 2) flat out uint fragTexture;
+
+struct DrawData {
     vec2 offset;
+    float depth;
+    float scale;
     vec3 color;
+    uint texture;
+};
+
+// Written by the CPU every frame; the recorded command buffers only carry the indices. The draw index is //
+// the instance index, so draws culled on the GPU (see OcclusionCuller) find their data too //
+layout(set = 0, binding = 1) readonly buffer FrameData {
+    DrawData draws[];
+} frameData[];
+
+layout(push_constant) uniform Push {
+    uint frameDataIndex;
 } push;
 
 void main() {
-    gl_Position = vec4(position + push.offset, 0.0, 1.0);
-}
\ No newline at end of file
+    DrawData draw = frameData[nonuniformEXT(push.frameDataIndex)].draws[gl_InstanceIndex];
+    gl_Position = vec4(position * draw.scale + draw.offset, draw.depth, 1.0);
+    fragColor = draw.color;
+    // Meshes span the unit square around their origin //
+    fragUv = position + 0.5;
+    fragTexture = draw.texture;
+}
@@ -0,0 +1,20 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "bindless.glsl"
+
+// Opaque sprites cut out transparent texels instead of blending them //
+layout(constant_id = 0) const bool ALPHA_TEST = false;
+
+layout(location = 0) in vec2 fragUv;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) flat in uint fragTexture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = sampleBindless(fragTexture, fragUv) * fragColor;
+    if (ALPHA_TEST && outColor.a < 0.5) {
+        discard;
+    }
+}
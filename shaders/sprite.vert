@@ -0,0 +1,36 @@
+#version 450
+
+// One quad per instance; the six corners are generated from gl_VertexIndex //
+layout(location = 0) in vec2 instancePosition;
+layout(location = 1) in vec2 instanceSize;
+layout(location = 2) in vec4 instanceUvRect;
+layout(location = 3) in vec4 instanceColor;
+layout(location = 4) in float instanceRotation;
+layout(location = 5) in uint instanceTexture;
+
+layout(location = 0) out vec2 fragUv;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragTexture;
+
+layout(push_constant) uniform Push {
+    vec2 scale;
+    vec2 translation;
+} push;
+
+const vec2 corners[6] = vec2[](
+    vec2(-0.5, -0.5), vec2(0.5, -0.5), vec2(0.5, 0.5),
+    vec2(-0.5, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5)
+);
+
+void main() {
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 local = corner * instanceSize;
+    float s = sin(instanceRotation);
+    float c = cos(instanceRotation);
+    vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+
+    gl_Position = vec4((instancePosition + rotated) * push.scale + push.translation, 0.0, 1.0);
+    fragUv = mix(instanceUvRect.xy, instanceUvRect.zw, corner + 0.5);
+    fragColor = instanceColor;
+    fragTexture = instanceTexture;
+}
@@ -0,0 +1,116 @@
+#include "core/allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace vulkan {
+
+    static std::atomic<uint64_t> allocationCount{0};
+    static std::atomic<uint64_t> allocatedBytes{0};
+
+    uint64_t AllocationCounter::getAllocationCount() {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AllocationCounter::getAllocatedBytes() {
+        return allocatedBytes.load(std::memory_order_relaxed);
+    }
+
+    static void *countedAllocate(size_t size, size_t alignment) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (size == 0) {
+            size = 1;
+        }
+        void *pointer = nullptr;
+        if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            pointer = std::malloc(size);
+        } else if (posix_memalign(&pointer, alignment, size) != 0) {
+            pointer = nullptr;
+        }
+        return pointer;
+    }
+
+}
+
+void *operator new(size_t size) {
+    void *pointer = vulkan::countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    if (pointer == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return vulkan::countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return vulkan::countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    void *pointer = vulkan::countedAllocate(size, static_cast<size_t>(alignment));
+    if (pointer == nullptr) {
+        throw std::bad_alloc{};
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return vulkan::countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return vulkan::countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
@@ -0,0 +1,172 @@
+#include "core/asset_watcher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace vulkan {
+
+    AssetWatcher::AssetWatcher() {
+#ifdef __linux__
+        _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        _wake = eventfd(0, EFD_CLOEXEC);
+        if (_inotify < 0 || _wake < 0) {
+            throw std::runtime_error("Failed to create the asset watcher.");
+        }
+#endif
+    }
+
+    bool AssetWatcher::isSupported() const {
+        return _inotify >= 0;
+    }
+
+    // Call before start. Only files closed after writing, or moved in, count: a file is complete by then. //
+    // Watch only FILE_MOVED_IN for files that stay mapped while in use: rewriting one in place changes //
+    // the pages under its reader //
+    void AssetWatcher::watch(const std::string &directory, Handler handler, uint32_t events) {
+#ifdef __linux__
+        uint32_t mask = ((events & FILE_WRITTEN) != 0 ? IN_CLOSE_WRITE : 0) | ((events & FILE_MOVED_IN) != 0 ? IN_MOVED_TO : 0);
+        int descriptor = inotify_add_watch(_inotify, directory.c_str(), mask | IN_MASK_ADD);
+        if (descriptor < 0) {
+            throw std::runtime_error("Failed to watch directory: " + directory);
+        }
+        _watches[descriptor].push_back({directory, events, std::move(handler)});
+#else
+        (void)directory;
+        (void)handler;
+        (void)events;
+#endif
+    }
+
+    void AssetWatcher::start() {
+        if (isSupported() && !_watches.empty() && !_thread.joinable()) {
+            _thread = std::thread{[this]() { run(); }};
+        }
+    }
+
+    void AssetWatcher::stop() {
+#ifdef __linux__
+        if (_thread.joinable()) {
+            uint64_t wake = 1;
+            if (write(_wake, &wake, sizeof(wake)) != sizeof(wake)) {
+                std::cerr << "Failed to wake the asset watcher." << std::endl;
+            }
+            _thread.join();
+        }
+#endif
+    }
+
+    // An editor saving a file, or a build writing several, raises a burst of events: the handlers only //
+    // run once nothing has changed for SETTLE_MILLISECONDS, and once per file //
+    void AssetWatcher::run() {
+#ifdef __linux__
+        std::vector<Change> changes;
+        while (true) {
+            pollfd descriptors[2] = {{_inotify, POLLIN, 0}, {_wake, POLLIN, 0}};
+            int ready = poll(descriptors, 2, changes.empty() ? -1 : SETTLE_MILLISECONDS);
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready < 0 || (descriptors[1].revents & POLLIN) != 0) {
+                return;
+            }
+            if (ready > 0) {
+                readEvents(changes);
+                continue;
+            }
+
+            // One change per file, with the events of the whole burst //
+            std::sort(changes.begin(), changes.end(), [](const Change &a, const Change &b) {
+                return a.descriptor != b.descriptor ? a.descriptor < b.descriptor : a.fileName < b.fileName;
+            });
+            size_t merged = 0;
+            for (size_t i = 0; i < changes.size(); i++) {
+                if (merged > 0 && changes[merged - 1].descriptor == changes[i].descriptor && changes[merged - 1].fileName == changes[i].fileName) {
+                    changes[merged - 1].events |= changes[i].events;
+                } else {
+                    changes[merged++] = std::move(changes[i]);
+                }
+            }
+            changes.resize(merged);
+
+            for (const Change &change : changes) {
+                for (const Watch &watch : _watches.at(change.descriptor)) {
+                    if ((watch.events & change.events) == 0) {
+                        continue;
+                    }
+                    try {
+                        watch.handler(watch.directory, change.fileName);
+                    } catch (const std::exception &error) {
+                        std::cerr << "Failed to reload " << watch.directory << "/" << change.fileName << ": " << error.what() << std::endl;
+                    }
+                }
+            }
+            changes.clear();
+        }
+#endif
+    }
+
+    bool AssetWatcher::readEvents(std::vector<Change> &changes) {
+#ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length = read(_inotify, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return false;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+            if (event->len > 0 && _watches.count(event->wd) != 0) {
+                changes.push_back({event->wd, event->name, (event->mask & IN_MOVED_TO) != 0 ? FILE_MOVED_IN : FILE_WRITTEN});
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+        return true;
+#else
+        (void)changes;
+        return false;
+#endif
+    }
+
+    // Any thread //
+    void AssetWatcher::post(std::function<void()> &&apply) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _posted.push_back(std::move(apply));
+    }
+
+    // Call between two frames; allocates nothing while nothing was posted //
+    // Whether anything was applied //
+    bool AssetWatcher::applyPosted() {
+        std::vector<std::function<void()>> posted;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            posted.swap(_posted);
+        }
+        for (std::function<void()> &apply : posted) {
+            apply();
+        }
+        return !posted.empty();
+    }
+
+    AssetWatcher::~AssetWatcher() {
+        stop();
+#ifdef __linux__
+        if (_inotify >= 0) {
+            close(_inotify);
+        }
+        if (_wake >= 0) {
+            close(_wake);
+        }
+#endif
+    }
+
+}
@@ -0,0 +1,70 @@
+#include "core/frame_arena.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vulkan {
+
+    LinearArena::LinearArena(size_t capacity) : _memory{new uint8_t[capacity]}, _capacity{capacity} {}
+
+    void *LinearArena::allocate(size_t size, size_t alignment) {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+            throw std::runtime_error("Arena alignment must be a power of two.");
+        }
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(_memory.get());
+        uintptr_t aligned = (base + _offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t offset = static_cast<size_t>(aligned - base);
+        if (offset + size <= _capacity) {
+            _offset = offset + size;
+            _peak = std::max(_peak, _offset);
+            return reinterpret_cast<void *>(aligned);
+        }
+
+        // Out of space for this frame: take a heap block now and fold it into the arena on reset //
+        size_t blockSize = size + alignment;
+        _overflowBlocks.push_back(std::unique_ptr<uint8_t[]>{new uint8_t[blockSize]});
+        _overflowBytes += blockSize;
+        _peak = std::max(_peak, _offset + _overflowBytes);
+        uintptr_t block = reinterpret_cast<uintptr_t>(_overflowBlocks.back().get());
+        return reinterpret_cast<void *>((block + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+    }
+
+    void LinearArena::reset() {
+        if (!_overflowBlocks.empty()) {
+            _capacity = std::max(_capacity * 2, _capacity + _overflowBytes);
+            _memory.reset(new uint8_t[_capacity]);
+            _overflowBlocks.clear();
+            _overflowBytes = 0;
+        }
+        _offset = 0;
+    }
+
+    size_t LinearArena::getCapacity() const {
+        return _capacity;
+    }
+
+    size_t LinearArena::getUsed() const {
+        return _offset + _overflowBytes;
+    }
+
+    size_t LinearArena::getPeak() const {
+        return _peak;
+    }
+
+    FrameArenas::FrameArenas(size_t frameCount, size_t capacity) {
+        for (size_t i = 0; i < frameCount; i++) {
+            _arenas.push_back(std::make_unique<LinearArena>(capacity));
+        }
+    }
+
+    void FrameArenas::beginFrame(size_t frameIndex) {
+        _current = frameIndex % _arenas.size();
+        _arenas[_current]->reset();
+    }
+
+    LinearArena &FrameArenas::getCurrent() {
+        return *_arenas[_current];
+    }
+
+}
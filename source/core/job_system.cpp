@@ -0,0 +1,312 @@
+#include "core/job_system.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace vulkan {
+
+    struct ThreadSlot {
+        const JobSystem *system = nullptr;
+        int32_t index = -1;
+        uint32_t random = 0x9E3779B9u;
+    };
+
+    static thread_local ThreadSlot threadSlot;
+
+    bool JobCounter::isDone() const {
+        return _pending.load(std::memory_order_acquire) == 0;
+    }
+
+    uint32_t JobCounter::getPending() const {
+        return _pending.load(std::memory_order_acquire);
+    }
+
+    JobSystem::JobSystem(uint32_t workerCount) {
+        uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+        if (workerCount == 0) {
+            workerCount = std::max(1u, cores - 1);
+        }
+
+        for (uint32_t i = 0; i <= workerCount; i++) {
+            _deques.push_back(std::make_unique<WorkStealingDeque>(DEQUE_CAPACITY));
+            _pools.push_back(std::make_unique<JobPool>());
+        }
+
+        // Deque 0 belongs to the creating thread, the workers take the cores after it //
+        threadSlot.system = this;
+        threadSlot.index = 0;
+        for (uint32_t i = 1; i <= workerCount; i++) {
+            _workers.emplace_back(&JobSystem::workerLoop, this, i);
+            pinThread(_workers.back(), i % cores);
+        }
+    }
+
+    void JobSystem::pinThread(std::thread &thread, uint32_t core) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+#else
+        (void)thread;
+        (void)core;
+#endif
+    }
+
+    int32_t JobSystem::getThreadIndex() {
+        return threadSlot.system == this ? threadSlot.index : -1;
+    }
+
+    // From the calling thread's pool, which only grows, a block at a time, until it covers the most jobs //
+    // that thread has had in flight. Threads the system does not own get a job of their own //
+    Job *JobSystem::allocateJob(JobCounter *counter) {
+        if (counter != nullptr) {
+            counter->_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        int32_t index = getThreadIndex();
+        if (index < 0) {
+            Job *job = new Job;
+            job->counter = counter;
+            return job;
+        }
+
+        JobPool &pool = *_pools[index];
+        if (pool.free == nullptr) {
+            pool.free = pool.returned.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (pool.free == nullptr) {
+            pool.blocks.push_back(std::make_unique<Job[]>(JOB_BLOCK_SIZE));
+            Job *block = pool.blocks.back().get();
+            for (uint32_t i = 0; i < JOB_BLOCK_SIZE; i++) {
+                block[i].pool = &pool;
+                block[i].next = i + 1 < JOB_BLOCK_SIZE ? &block[i + 1] : nullptr;
+            }
+            pool.free = block;
+        }
+        Job *job = pool.free;
+        pool.free = job->next;
+        job->counter = counter;
+        return job;
+    }
+
+    // The owner puts it straight back on its free list, any other thread pushes it on the returned stack. //
+    // Only the owner ever empties that stack, in one exchange, so the push cannot suffer from ABA //
+    void JobSystem::releaseJob(Job *job) {
+        if (job->pool == nullptr) {
+            delete job;
+            return;
+        }
+        job->function = nullptr;
+        job->range = nullptr;
+
+        JobPool &pool = *job->pool;
+        int32_t index = getThreadIndex();
+        if (index >= 0 && _pools[index].get() == &pool) {
+            job->next = pool.free;
+            pool.free = job;
+            return;
+        }
+        Job *head = pool.returned.load(std::memory_order_relaxed);
+        do {
+            job->next = head;
+        } while (!pool.returned.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void JobSystem::schedule(std::function<void()> &&function, JobCounter *counter) {
+        Job *job = allocateJob(counter);
+        job->function = std::move(function);
+        enqueue(job);
+    }
+
+    // The job counts against its counter straight away, so waiting on it also covers the dependency //
+    void JobSystem::scheduleAfter(JobCounter &dependency, std::function<void()> &&function, JobCounter *counter) {
+        Job *job = allocateJob(counter);
+        job->function = std::move(function);
+        {
+            std::lock_guard<std::mutex> lock{dependency._mutex};
+            if (dependency._pending.load(std::memory_order_acquire) != 0) {
+                dependency._continuations.push_back(job);
+                return;
+            }
+        }
+        enqueue(job);
+    }
+
+    void JobSystem::enqueue(Job *job) {
+        _queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+        int32_t index = getThreadIndex();
+        if (index < 0) {
+            std::lock_guard<std::mutex> lock{_injectedMutex};
+            _injectedJobs.push_back(job);
+            _injectedCount.fetch_add(1, std::memory_order_release);
+        } else if (!_deques[index]->push(job)) {
+            _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            execute(job);
+            return;
+        }
+
+        if (_sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock{_sleepMutex};
+            _sleepCondition.notify_one();
+        }
+    }
+
+    // Own deque first, then jobs from outside threads, then steal starting from a random victim //
+    Job *JobSystem::findJob(int32_t index) {
+        Job *job = nullptr;
+        if (index >= 0) {
+            job = _deques[index]->pop();
+        }
+
+        if (job == nullptr && _injectedCount.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock{_injectedMutex};
+            if (!_injectedJobs.empty()) {
+                job = _injectedJobs.front();
+                _injectedJobs.pop_front();
+                _injectedCount.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (job == nullptr) {
+            uint32_t count = static_cast<uint32_t>(_deques.size());
+            threadSlot.random ^= threadSlot.random << 13;
+            threadSlot.random ^= threadSlot.random >> 17;
+            threadSlot.random ^= threadSlot.random << 5;
+            uint32_t start = threadSlot.random % count;
+            for (uint32_t i = 0; i < count && job == nullptr; i++) {
+                uint32_t victim = (start + i) % count;
+                if (static_cast<int32_t>(victim) != index) {
+                    job = _deques[victim]->steal();
+                }
+            }
+        }
+
+        if (job != nullptr) {
+            _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    void JobSystem::execute(Job *job) {
+        if (job->range != nullptr) {
+            (*job->range)(job->begin, job->end);
+        } else {
+            job->function();
+        }
+        JobCounter *counter = job->counter;
+        releaseJob(job);
+        finish(counter);
+    }
+
+    void JobSystem::finish(JobCounter *counter) {
+        if (counter == nullptr) {
+            return;
+        }
+
+        // Decrement under the lock so scheduleAfter never parks a continuation on a finished counter //
+        std::vector<Job *> continuations;
+        {
+            std::lock_guard<std::mutex> lock{counter->_mutex};
+            if (counter->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                continuations.swap(counter->_continuations);
+            }
+        }
+        for (Job *continuation : continuations) {
+            enqueue(continuation);
+        }
+    }
+
+    void JobSystem::workerLoop(uint32_t index) {
+        threadSlot.system = this;
+        threadSlot.index = static_cast<int32_t>(index);
+        threadSlot.random += index * 0x9E3779B9u;
+
+        uint32_t spins = 0;
+        while (_running.load(std::memory_order_acquire)) {
+            Job *job = findJob(static_cast<int32_t>(index));
+            if (job != nullptr) {
+                execute(job);
+                spins = 0;
+                continue;
+            }
+
+            if (++spins < SPIN_COUNT) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{_sleepMutex};
+            _sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            _sleepCondition.wait(lock, [this]() { return !_running.load(std::memory_order_acquire) || _queuedJobs.load(std::memory_order_seq_cst) > 0; });
+            _sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            spins = 0;
+        }
+    }
+
+    // The waiting thread runs other jobs instead of blocking, so nested waits inside jobs cannot starve the pool //
+    void JobSystem::wait(JobCounter &counter) {
+        int32_t index = getThreadIndex();
+        while (counter._pending.load(std::memory_order_acquire) != 0) {
+            Job *job = findJob(index);
+            if (job != nullptr) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        // The finishing thread may still hold the mutex; once we own it the counter is safe to destroy //
+        std::lock_guard<std::mutex> lock{counter._mutex};
+    }
+
+    void JobSystem::parallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t begin, uint32_t end)> &function) {
+        if (count == 0) {
+            return;
+        }
+        batchSize = std::max(1u, batchSize);
+
+        JobCounter counter;
+        uint32_t begin = 0;
+        for (; count - begin > batchSize; begin += batchSize) {
+            Job *job = allocateJob(&counter);
+            job->range = &function;
+            job->begin = begin;
+            job->end = begin + batchSize;
+            enqueue(job);
+        }
+
+        // The caller takes the last batch itself rather than idling //
+        function(begin, count);
+        wait(counter);
+    }
+
+    uint32_t JobSystem::getWorkerCount() {
+        return static_cast<uint32_t>(_workers.size());
+    }
+
+    JobSystem::~JobSystem() {
+        _running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock{_sleepMutex};
+            _sleepCondition.notify_all();
+        }
+        for (std::thread &worker : _workers) {
+            worker.join();
+        }
+
+        Job *job;
+        while ((job = findJob(getThreadIndex())) != nullptr) {
+            execute(job);
+        }
+        if (threadSlot.system == this) {
+            threadSlot.system = nullptr;
+            threadSlot.index = -1;
+        }
+    }
+
+}
@@ -0,0 +1,51 @@
+#include "core/mapped_file.hpp"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace vulkan {
+
+    MappedFile::MappedFile(const std::string &filePath) {
+        int descriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            throw std::runtime_error("Failed to open file: " + filePath);
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+            close(descriptor);
+            throw std::runtime_error("Failed to stat file or file is empty: " + filePath);
+        }
+        _size = static_cast<size_t>(status.st_size);
+
+        void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Failed to map file: " + filePath);
+        }
+        _data = static_cast<const uint8_t *>(mapping);
+    }
+
+    const uint8_t *MappedFile::getData() const {
+        return _data;
+    }
+
+    size_t MappedFile::getSize() const {
+        return _size;
+    }
+
+    // Hints the kernel to start paging a range in before it is copied out //
+    void MappedFile::prefetch(size_t offset, size_t length) const {
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = offset / pageSize * pageSize;
+        madvise(const_cast<uint8_t *>(_data) + begin, offset + length - begin, MADV_WILLNEED);
+    }
+
+    MappedFile::~MappedFile() {
+        munmap(const_cast<uint8_t *>(_data), _size);
+    }
+
+}
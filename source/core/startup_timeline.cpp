@@ -0,0 +1,100 @@
+#include "core/startup_timeline.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+namespace vulkan {
+
+    StartupTimeline::StartupTimeline() : _origin{Clock::now()}, _lastMark{_origin}, _mainThread{std::this_thread::get_id()} {}
+
+    double StartupTimeline::toMilliseconds(Clock::time_point time) {
+        return std::chrono::duration<double, std::milli>(time - _origin).count();
+    }
+
+    // Once reported, stages are no longer kept, so code shared with resizing can stay instrumented //
+    void StartupTimeline::record(const std::string &name, Clock::time_point start, Clock::time_point end) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_reported) {
+            return;
+        }
+        _stages.push_back({name, toMilliseconds(start), toMilliseconds(end) - toMilliseconds(start), std::this_thread::get_id() == _mainThread});
+        if (std::this_thread::get_id() == _mainThread) {
+            _lastMark = std::max(_lastMark, end);
+        }
+    }
+
+    void StartupTimeline::measure(const std::string &name, const std::function<void()> &function) {
+        Clock::time_point start = Clock::now();
+        function();
+        record(name, start, Clock::now());
+    }
+
+    // For work that cannot be wrapped, such as member construction: a stage covering everything the main //
+    // thread did since its last recorded stage //
+    void StartupTimeline::mark(const std::string &name) {
+        Clock::time_point start;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            start = _lastMark;
+        }
+        record(name, start, Clock::now());
+    }
+
+    // A job that throws would take the worker down: the first failure is kept and rethrown by wait //
+    void StartupTimeline::schedule(JobSystem &jobSystem, const std::string &name, std::function<void()> &&function, JobCounter &counter) {
+        jobSystem.schedule([this, name, function = std::move(function)]() {
+            Clock::time_point start = Clock::now();
+            try {
+                function();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{_mutex};
+                if (_failure == nullptr) {
+                    _failure = std::current_exception();
+                }
+            }
+            record(name, start, Clock::now());
+        }, &counter);
+    }
+
+    void StartupTimeline::wait(JobSystem &jobSystem, JobCounter &counter) {
+        jobSystem.wait(counter);
+
+        std::exception_ptr failure;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            std::swap(failure, _failure);
+        }
+        if (failure != nullptr) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    // Stages in start order; worker stages overlap the main thread stages around them //
+    void StartupTimeline::report(std::ostream &stream) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        std::vector<Stage> stages = _stages;
+        std::stable_sort(stages.begin(), stages.end(), [](const Stage &left, const Stage &right) { return left.start < right.start; });
+
+        std::ios_base::fmtflags flags = stream.flags();
+        std::streamsize precision = stream.precision();
+        double total = 0.0;
+        stream << "Startup timeline:" << std::endl;
+        for (const Stage &stage : stages) {
+            stream << "    " << std::left << std::setw(24) << stage.name << std::right << std::fixed << std::setprecision(2)
+                   << std::setw(10) << stage.start << " ms +" << std::setw(9) << stage.duration << " ms"
+                   << (stage.mainThread ? "" : "  (worker)") << std::endl;
+            total = std::max(total, stage.start + stage.duration);
+        }
+        stream << "Time to first frame: " << std::fixed << std::setprecision(2) << total << " ms" << std::endl;
+        stream.flags(flags);
+        stream.precision(precision);
+        _reported = true;
+    }
+
+    bool StartupTimeline::isReported() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _reported;
+    }
+
+}
@@ -0,0 +1,71 @@
+#include "core/work_stealing_deque.hpp"
+
+#include <stdexcept>
+
+namespace vulkan {
+
+    WorkStealingDeque::WorkStealingDeque(uint32_t capacity) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+            throw std::runtime_error("Work-stealing deque capacity must be a power of two.");
+        }
+        _buffer = std::make_unique<std::atomic<Job *>[]>(capacity);
+        _mask = static_cast<int64_t>(capacity) - 1;
+    }
+
+    // Owner only. Returns false when full so the caller can run the job inline instead //
+    bool WorkStealingDeque::push(Job *job) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        if (bottom - top > _mask) {
+            return false;
+        }
+        _buffer[bottom & _mask].store(job, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only, LIFO: the most recently pushed job is the one most likely still in cache //
+    Job *WorkStealingDeque::pop() {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last job: a thief may be taking it at the same time //
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread, FIFO: thieves take the oldest job, which tends to be the largest piece of work //
+    Job *WorkStealingDeque::steal() {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job *job = _buffer[top & _mask].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    bool WorkStealingDeque::isEmpty() const {
+        return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+    }
+
+}
@@ -0,0 +1,203 @@
+#include "descriptors/bindless_table.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace vulkan {
+
+    BindlessTable::BindlessTable(Device &device) : _device{device} {
+        computeCapacities();
+        _liveImages.assign(_maxImages, false);
+        _liveBuffers.assign(_maxBuffers, false);
+        createDescriptorSetLayout();
+        createDescriptorPool();
+        allocateDescriptorSet();
+    }
+
+    void BindlessTable::computeCapacities() {
+        const VkPhysicalDeviceDescriptorIndexingPropertiesEXT &limits = _device._descriptorIndexingProperties;
+
+        // Combined image samplers count against both the sampler and the sampled image limits //
+        _maxImages = std::min({MAX_IMAGES, limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSamplers, limits.maxPerStageDescriptorUpdateAfterBindSamplers});
+        _maxBuffers = std::min({MAX_BUFFERS, limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+        if (_maxImages + _maxBuffers > limits.maxPerStageUpdateAfterBindResources) {
+            _maxImages = std::min(_maxImages, limits.maxPerStageUpdateAfterBindResources / 2);
+            _maxBuffers = std::min(_maxBuffers, limits.maxPerStageUpdateAfterBindResources - _maxImages);
+        }
+    }
+
+    void BindlessTable::createDescriptorSetLayout() {
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = IMAGE_BINDING;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = _maxImages;
+        bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1].binding = BUFFER_BINDING;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = _maxBuffers;
+        bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+        bindings[1].pImmutableSamplers = nullptr;
+
+        // Partially bound: empty slots are legal as long as shaders never read them //
+        VkDescriptorBindingFlagsEXT flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {flags, flags};
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInformation{};
+        bindingFlagsInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        bindingFlagsInformation.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInformation.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo layoutInformation{};
+        layoutInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInformation.pNext = &bindingFlagsInformation;
+        layoutInformation.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        layoutInformation.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInformation.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(_device.getDevice(), &layoutInformation, nullptr, &_descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor set layout.");
+        }
+    }
+
+    void BindlessTable::createDescriptorPool() {
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = _maxImages;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = _maxBuffers;
+
+        VkDescriptorPoolCreateInfo poolInformation{};
+        poolInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInformation.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolInformation.maxSets = 1;
+        poolInformation.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInformation.pPoolSizes = poolSizes.data();
+
+        if (vkCreateDescriptorPool(_device.getDevice(), &poolInformation, nullptr, &_descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bindless descriptor pool.");
+        }
+    }
+
+    void BindlessTable::allocateDescriptorSet() {
+        VkDescriptorSetAllocateInfo allocInformation{};
+        allocInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInformation.descriptorPool = _descriptorPool;
+        allocInformation.descriptorSetCount = 1;
+        allocInformation.pSetLayouts = &_descriptorSetLayout;
+
+        if (vkAllocateDescriptorSets(_device.getDevice(), &allocInformation, &_descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate bindless descriptor set.");
+        }
+    }
+
+    uint32_t BindlessTable::allocateIndex(std::vector<uint32_t> &freeIndices, std::vector<bool> &live, uint32_t &nextIndex, uint32_t capacity) {
+        uint32_t index;
+        if (!freeIndices.empty()) {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+        } else if (nextIndex >= capacity) {
+            throw std::runtime_error("Bindless descriptor table is full.");
+        } else {
+            index = nextIndex++;
+        }
+        live[index] = true;
+        return index;
+    }
+
+    // A slot freed twice would be handed to two resources at once, so that and unknown slots are errors //
+    void BindlessTable::releaseIndex(uint32_t index, std::vector<uint32_t> &freeIndices, std::vector<bool> &live, const char *kind) {
+        if (index == INVALID_INDEX) {
+            return;
+        }
+        if (index >= live.size() || !live[index]) {
+            throw std::runtime_error(std::string("Released a bindless ") + kind + " index that is not registered: " + std::to_string(index));
+        }
+        live[index] = false;
+        freeIndices.push_back(index);
+    }
+
+    uint32_t BindlessTable::registerImage(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout) {
+        uint32_t index = allocateIndex(_freeImageIndices, _liveImages, _nextImageIndex, _maxImages);
+        updateImage(index, imageView, sampler, imageLayout);
+        return index;
+    }
+
+    void BindlessTable::updateImage(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout) {
+        VkDescriptorImageInfo imageInformation{};
+        imageInformation.sampler = sampler;
+        imageInformation.imageView = imageView;
+        imageInformation.imageLayout = imageLayout;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = _descriptorSet;
+        write.dstBinding = IMAGE_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInformation;
+        vkUpdateDescriptorSets(_device.getDevice(), 1, &write, 0, nullptr);
+    }
+
+    void BindlessTable::releaseImage(uint32_t index) {
+        releaseIndex(index, _freeImageIndices, _liveImages, "image");
+    }
+
+    uint32_t BindlessTable::registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        uint32_t index = allocateIndex(_freeBufferIndices, _liveBuffers, _nextBufferIndex, _maxBuffers);
+        updateBuffer(index, buffer, offset, range);
+        return index;
+    }
+
+    void BindlessTable::updateBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+        VkDescriptorBufferInfo bufferInformation{};
+        bufferInformation.buffer = buffer;
+        bufferInformation.offset = offset;
+        bufferInformation.range = range;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = _descriptorSet;
+        write.dstBinding = BUFFER_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInformation;
+        vkUpdateDescriptorSets(_device.getDevice(), 1, &write, 0, nullptr);
+    }
+
+    void BindlessTable::releaseBuffer(uint32_t index) {
+        releaseIndex(index, _freeBufferIndices, _liveBuffers, "buffer");
+    }
+
+    void BindlessTable::bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipelineBindPoint bindPoint) {
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, SET_INDEX, 1, &_descriptorSet, 0, nullptr);
+    }
+
+    VkDescriptorSetLayout BindlessTable::getDescriptorSetLayout() {
+        return _descriptorSetLayout;
+    }
+
+    VkDescriptorSet BindlessTable::getDescriptorSet() {
+        return _descriptorSet;
+    }
+
+    uint32_t BindlessTable::getImageCapacity() {
+        return _maxImages;
+    }
+
+    uint32_t BindlessTable::getBufferCapacity() {
+        return _maxBuffers;
+    }
+
+    BindlessTable::~BindlessTable() {
+        vkDestroyDescriptorPool(_device.getDevice(), _descriptorPool, nullptr);
+        vkDestroyDescriptorSetLayout(_device.getDevice(), _descriptorSetLayout, nullptr);
+    }
+
+}
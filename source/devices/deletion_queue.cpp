@@ -0,0 +1,46 @@
+#include "devices/deletion_queue.hpp"
+
+namespace vulkan {
+
+    DeletionQueue::DeletionQueue(uint64_t frameLatency) : _frameLatency{frameLatency} {}
+
+    void DeletionQueue::push(std::function<void()> &&destroy) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _entries.push_back({_frame, std::move(destroy)});
+    }
+
+    // Called once the fence of the oldest frame in flight has been waited on //
+    void DeletionQueue::advanceFrame() {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _frame++;
+        while (!_entries.empty() && _entries.front().frame + _frameLatency <= _frame) {
+            std::function<void()> destroy = std::move(_entries.front().destroy);
+            _entries.pop_front();
+            lock.unlock();
+            destroy();
+            lock.lock();
+        }
+    }
+
+    // Only valid once the device is idle //
+    void DeletionQueue::flush() {
+        std::unique_lock<std::mutex> lock{_mutex};
+        while (!_entries.empty()) {
+            std::function<void()> destroy = std::move(_entries.front().destroy);
+            _entries.pop_front();
+            lock.unlock();
+            destroy();
+            lock.lock();
+        }
+    }
+
+    uint64_t DeletionQueue::getFrame() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _frame;
+    }
+
+    DeletionQueue::~DeletionQueue() {
+        flush();
+    }
+
+}
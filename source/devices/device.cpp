@@ -7,13 +7,25 @@
 
 namespace vulkan {
 
-    Device::Device(Window &window) : _window{window} {
+    Device::Device(Window &window, StartupTimeline *startupTimeline) : _window{window} {
+        if (startupTimeline != nullptr) {
+            startupTimeline->mark("job system and window");
+        }
         createInstance();
         setupDebugMessenger();
+        if (startupTimeline != nullptr) {
+            startupTimeline->mark("instance");
+        }
         createSurface();
         pickPhysicalDevice();
+        if (startupTimeline != nullptr) {
+            startupTimeline->mark("physical device");
+        }
         createLogicalDevice();
         createCommandPool();
+        if (startupTimeline != nullptr) {
+            startupTimeline->mark("logical device");
+        }
     }
 
     VkCommandPool Device::getCommandPool() {
@@ -36,6 +48,90 @@ namespace vulkan {
         return _presentQueue;
     }
 
+    VkQueue Device::getTransferQueue() {
+        return _transferQueue;
+    }
+
+    VkQueue Device::getComputeQueue() {
+        return _computeQueue;
+    }
+
+    VkCommandPool Device::getComputeCommandPool() {
+        return _computeCommandPool;
+    }
+
+    bool Device::isAsyncComputeSupported() {
+        return _asyncComputeSupported;
+    }
+
+    // Compute work submitted here runs beside the graphics queue when the family is dedicated. Ordering //
+    // against graphics goes through the semaphores; either may be null //
+    void Device::submitCompute(VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStage, VkSemaphore signalSemaphore, VkFence fence) {
+        VkSubmitInfo submitInformation{};
+        submitInformation.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInformation.commandBufferCount = 1;
+        submitInformation.pCommandBuffers = &commandBuffer;
+        if (waitSemaphore != VK_NULL_HANDLE) {
+            submitInformation.waitSemaphoreCount = 1;
+            submitInformation.pWaitSemaphores = &waitSemaphore;
+            submitInformation.pWaitDstStageMask = &waitStage;
+        }
+        if (signalSemaphore != VK_NULL_HANDLE) {
+            submitInformation.signalSemaphoreCount = 1;
+            submitInformation.pSignalSemaphores = &signalSemaphore;
+        }
+
+        if (vkQueueSubmit(_computeQueue, 1, &submitInformation, fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit compute command buffer.");
+        }
+    }
+
+    // Exclusive buffers change queue family through a matching release (recorded on the source queue) and //
+    // acquire (recorded on the destination queue). The same call records either half: the release ignores //
+    // the destination access, the acquire the source access. Within one family it is a plain barrier. //
+    void Device::transferBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer, uint32_t srcFamily, uint32_t dstFamily, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = srcFamily == dstFamily ? VK_QUEUE_FAMILY_IGNORED : srcFamily;
+        barrier.dstQueueFamilyIndex = srcFamily == dstFamily ? VK_QUEUE_FAMILY_IGNORED : dstFamily;
+        barrier.buffer = buffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    bool Device::isDynamicRenderingSupported() {
+        return _dynamicRenderingSupported;
+    }
+
+    bool Device::isPresentWaitSupported() {
+        return _presentWaitSupported;
+    }
+
+    VkResult Device::waitForPresent(VkSwapchainKHR swapChain, uint64_t presentId, uint64_t timeout) {
+        return _waitForPresent(_device, swapChain, presentId, timeout);
+    }
+
+    // Many indirect draws in one call, each with its own first instance //
+    bool Device::isMultiDrawIndirectSupported() {
+        return _multiDrawIndirectSupported;
+    }
+
+    // Indirect draws that find their data by instance index need it, as the occlusion culler's do //
+    bool Device::isDrawIndirectFirstInstanceSupported() {
+        return _drawIndirectFirstInstanceSupported;
+    }
+
+    void Device::cmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR &renderingInformation) {
+        _cmdBeginRendering(commandBuffer, &renderingInformation);
+    }
+
+    void Device::cmdEndRendering(VkCommandBuffer commandBuffer) {
+        _cmdEndRendering(commandBuffer);
+    }
+
     SwapChainSupportDetails Device::getSwapChainSupport() {
         return querySwapChainSupport(_physicalDevice);
     }
@@ -44,6 +140,17 @@ namespace vulkan {
         return findQueueFamilies(_physicalDevice);
     }
 
+    VkQueueFamilyProperties Device::getQueueFamilyProperties(uint32_t queueFamily) {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, queueFamilies.data());
+        if (queueFamily >= queueFamilyCount) {
+            throw std::runtime_error("Invalid queue family index.");
+        }
+        return queueFamilies[queueFamily];
+    }
+
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData, void *pUserData) {
         (void) messageSeverity; // Unused at the moment, voided to prevent warning
         (void) messageType; // Unused at the moment, voided to prevent warning
@@ -79,7 +186,7 @@ namespace vulkan {
         appInformation.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInformation.pEngineName = "BBKEngine";
         appInformation.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInformation.apiVersion = VK_API_VERSION_1_0;
+        appInformation.apiVersion = VK_API_VERSION_1_2;
 
         VkInstanceCreateInfo createInformation{};
         createInformation.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -139,7 +246,15 @@ namespace vulkan {
             throw std::runtime_error("Failed to find a suitable GPU.");
         }
 
-        vkGetPhysicalDeviceProperties(_physicalDevice, &_properties);
+        _descriptorIndexingProperties = {};
+        _descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &_descriptorIndexingProperties;
+        vkGetPhysicalDeviceProperties2(_physicalDevice, &properties);
+        _properties = properties.properties;
+        vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &_memoryProperties);
         std::cout << "Physical device: " << _properties.deviceName << std::endl;
     }
 
@@ -147,7 +262,7 @@ namespace vulkan {
         QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInformations;
-        std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+        std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily, indices.transferFamily, indices.computeFamily};
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -159,18 +274,75 @@ namespace vulkan {
             queueCreateInformations.push_back(queueCreateInformation);
         }
 
-        VkPhysicalDeviceFeatures deviceFeatures{};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
+        // Bindless resources: non-uniformly indexed, partially bound arrays updated after bind //
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+        descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+
+        // Optional: without it the swap-chain falls back to a render pass and framebuffers //
+        std::vector<const char *> enabledExtensions = deviceExtensions;
+        _dynamicRenderingSupported = enableDynamicRendering && checkDynamicRenderingSupport(_physicalDevice);
+
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+        dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+        dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+        if (_dynamicRenderingSupported) {
+            enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            descriptorIndexingFeatures.pNext = &dynamicRenderingFeatures;
+        }
+
+        // Optional: without it frame pacing falls back to timing heuristics //
+        _presentWaitSupported = enablePresentWait && checkPresentWaitSupport(_physicalDevice);
+
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        presentWaitFeatures.presentWait = VK_TRUE;
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        presentIdFeatures.presentId = VK_TRUE;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        if (_presentWaitSupported) {
+            enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            presentWaitFeatures.pNext = descriptorIndexingFeatures.pNext;
+            descriptorIndexingFeatures.pNext = &presentIdFeatures;
+        }
+
+        // Optional: without it heap budgets and usage are estimated //
+        _memoryBudgetSupported = enableMemoryBudget && hasDeviceExtension(_physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (_memoryBudgetSupported) {
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        VkPhysicalDeviceFeatures2 deviceFeatures{};
+        deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        deviceFeatures.pNext = &descriptorIndexingFeatures;
+        deviceFeatures.features.samplerAnisotropy = VK_TRUE;
+
+        // Optional: indirect draws otherwise go one per call, and only with a first instance of zero //
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedFeatures);
+        deviceFeatures.features.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.features.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+        _drawIndirectFirstInstanceSupported = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+        _multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect && _drawIndirectFirstInstanceSupported;
 
         VkDeviceCreateInfo createInformation{};
         createInformation.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInformation.pNext = &deviceFeatures;
 
         createInformation.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInformations.size());
         createInformation.pQueueCreateInfos = queueCreateInformations.data();
 
-        createInformation.pEnabledFeatures = &deviceFeatures;
-        createInformation.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInformation.ppEnabledExtensionNames = deviceExtensions.data();
+        createInformation.pEnabledFeatures = nullptr;
+        createInformation.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInformation.ppEnabledExtensionNames = enabledExtensions.data();
 
         if (enableValidationLayers) {
             createInformation.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -185,6 +357,19 @@ namespace vulkan {
 
         vkGetDeviceQueue(_device, indices.graphicsFamily, 0, &_graphicsQueue);
         vkGetDeviceQueue(_device, indices.presentFamily, 0, &_presentQueue);
+        vkGetDeviceQueue(_device, indices.transferFamily, 0, &_transferQueue);
+        vkGetDeviceQueue(_device, indices.computeFamily, 0, &_computeQueue);
+        _asyncComputeSupported = indices.hasDedicatedCompute();
+
+        if (_dynamicRenderingSupported) {
+            _cmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(_device, "vkCmdBeginRenderingKHR"));
+            _cmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(_device, "vkCmdEndRenderingKHR"));
+            _dynamicRenderingSupported = _cmdBeginRendering != nullptr && _cmdEndRendering != nullptr;
+        }
+        if (_presentWaitSupported) {
+            _waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(_device, "vkWaitForPresentKHR"));
+            _presentWaitSupported = _waitForPresent != nullptr;
+        }
     }
 
     void Device::createCommandPool() {
@@ -198,6 +383,16 @@ namespace vulkan {
         if (vkCreateCommandPool(_device, &poolInformation, nullptr, &_commandPool) != VK_SUCCESS) {
             throw std::runtime_error("failed to create command pool!");
         }
+
+        // Without a dedicated family, compute work is recorded from the graphics pool //
+        _computeCommandPool = _commandPool;
+        if (queueFamilyIndices.hasDedicatedCompute()) {
+            poolInformation.queueFamilyIndex = queueFamilyIndices.computeFamily;
+            poolInformation.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            if (vkCreateCommandPool(_device, &poolInformation, nullptr, &_computeCommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compute command pool!");
+            }
+        }
     }
 
     void Device::createSurface() {
@@ -218,7 +413,79 @@ namespace vulkan {
         VkPhysicalDeviceFeatures supportedFeatures;
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-        return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+        return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy && checkDescriptorIndexingSupport(device);
+    }
+
+    bool Device::checkDescriptorIndexingSupport(VkPhysicalDevice device) {
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+        descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &descriptorIndexingFeatures;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        return descriptorIndexingFeatures.runtimeDescriptorArray && descriptorIndexingFeatures.descriptorBindingPartiallyBound && descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending && descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind && descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind && descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing && descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+    }
+
+    bool Device::hasDeviceExtension(VkPhysicalDevice device, const char *extensionName) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+        for (const VkExtensionProperties &extension : availableExtensions) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool Device::checkPresentWaitSupport(VkPhysicalDevice device) {
+        if (!hasDeviceExtension(device, VK_KHR_PRESENT_ID_EXTENSION_NAME) || !hasDeviceExtension(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+            return false;
+        }
+
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &presentIdFeatures;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        return presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+    }
+
+    bool Device::checkDynamicRenderingSupport(VkPhysicalDevice device) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        bool extensionFound = false;
+        for (const VkExtensionProperties &extension : availableExtensions) {
+            if (strcmp(extension.extensionName, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) == 0) {
+                extensionFound = true;
+                break;
+            }
+        }
+        if (!extensionFound) {
+            return false;
+        }
+
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+        dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &dynamicRenderingFeatures;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        return dynamicRenderingFeatures.dynamicRendering;
     }
 
     void Device::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo) {
@@ -329,22 +596,42 @@ namespace vulkan {
 
         int i = 0;
         for (const VkQueueFamilyProperties &queueFamily : queueFamilies) {
-            if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-                indices.graphicsFamily = i;
-                indices.graphicsFamilyHasValue = true;
+            if (!indices.isComplete()) {
+                if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+                    indices.graphicsFamily = i;
+                    indices.graphicsFamilyHasValue = true;
+                }
+                VkBool32 presentSupport = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+                if (queueFamily.queueCount > 0 && presentSupport) {
+                    indices.presentFamily = i;
+                    indices.presentFamilyHasValue = true;
+                }
             }
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
-            if (queueFamily.queueCount > 0 && presentSupport) {
-                indices.presentFamily = i;
-                indices.presentFamilyHasValue = true;
+            // A transfer-only family usually maps to the DMA engines and runs beside rendering //
+            if (!indices.transferFamilyHasValue && queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                indices.transferFamily = i;
+                indices.transferFamilyHasValue = true;
             }
-            if (indices.isComplete()) {
-                break;
+            // Likewise a compute family without graphics is the async compute engine //
+            if (!indices.computeFamilyHasValue && queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                indices.computeFamily = i;
+                indices.computeFamilyHasValue = true;
             }
             i++;
         }
 
+        if (!indices.transferFamilyHasValue && indices.graphicsFamilyHasValue) {
+            indices.transferFamily = indices.graphicsFamily;
+            indices.transferFamilyHasValue = true;
+        }
+
+        // Graphics families always support compute //
+        if (!indices.computeFamilyHasValue && indices.graphicsFamilyHasValue) {
+            indices.computeFamily = indices.graphicsFamily;
+            indices.computeFamilyHasValue = true;
+        }
+
         return indices;
     }
 
@@ -385,17 +672,156 @@ namespace vulkan {
     }
 
     uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &memProperties);
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+        for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
                 return i;
             }
         }
         throw std::runtime_error("Failed to find suitable memory type.");
     }
 
-    void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
+    // Whether one of the memory types in typeFilter, as in VkMemoryRequirements, has all the properties //
+    bool Device::hasMemoryProperties(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+        for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    VkMemoryPropertyFlags Device::getMemoryTypeProperties(uint32_t memoryTypeIndex) {
+        return _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    }
+
+    // Memory types come best first, but the best one may sit in a heap already over its budget: the first //
+    // matching type whose heap still has room is taken, and the next ones are tried if the driver runs out //
+    VkDeviceMemory Device::allocateMemory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, MemoryCategory category) {
+        MemoryStatistics statistics = getMemoryStatistics();
+        std::array<uint32_t, VK_MAX_MEMORY_TYPES> candidates;
+        uint32_t candidateCount = 0;
+        for (uint32_t pass = 0; pass < 2; pass++) {
+            for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+                if (!(requirements.memoryTypeBits & (1 << i)) || (_memoryProperties.memoryTypes[i].propertyFlags & properties) != properties) {
+                    continue;
+                }
+                const MemoryHeapStatistics &heap = statistics.heaps[_memoryProperties.memoryTypes[i].heapIndex];
+                bool fits = heap.usage + requirements.size <= heap.budget;
+                if (fits == (pass == 0)) {
+                    candidates[candidateCount++] = i;
+                }
+            }
+        }
+        if (candidateCount == 0) {
+            throw std::runtime_error("Failed to find suitable memory type.");
+        }
+
+        for (uint32_t candidate = 0; candidate < candidateCount; candidate++) {
+            try {
+                return allocateMemory(requirements.size, candidates[candidate], category);
+            } catch (const std::runtime_error &) {
+                if (candidate + 1 == candidateCount) {
+                    throw;
+                }
+            }
+        }
+        return VK_NULL_HANDLE;
+    }
+
+    // Every allocation goes through here, and every release through freeMemory, to be accounted for //
+    VkDeviceMemory Device::allocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, MemoryCategory category) {
+        VkMemoryAllocateInfo allocInformation{};
+        allocInformation.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInformation.allocationSize = size;
+        allocInformation.memoryTypeIndex = memoryTypeIndex;
+
+        VkDeviceMemory memory;
+        if (vkAllocateMemory(_device, &allocInformation, nullptr, &memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate device memory.");
+        }
+
+        uint32_t heapIndex = _memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        std::lock_guard<std::mutex> lock{_memoryMutex};
+        _allocations[memory] = {heapIndex, size, category};
+        _allocatedBytes[heapIndex][static_cast<uint32_t>(category)] += size;
+        _allocationCounts[heapIndex]++;
+        return memory;
+    }
+
+    void Device::freeMemory(VkDeviceMemory memory) {
+        if (memory == VK_NULL_HANDLE) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{_memoryMutex};
+            std::unordered_map<VkDeviceMemory, MemoryAllocation>::iterator allocation = _allocations.find(memory);
+            if (allocation != _allocations.end()) {
+                _allocatedBytes[allocation->second.heapIndex][static_cast<uint32_t>(allocation->second.category)] -= allocation->second.size;
+                _allocationCounts[allocation->second.heapIndex]--;
+                _allocations.erase(allocation);
+            }
+        }
+        vkFreeMemory(_device, memory, nullptr);
+    }
+
+    bool Device::isMemoryBudgetSupported() {
+        return _memoryBudgetSupported;
+    }
+
+    MemoryStatistics Device::getMemoryStatistics() {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+        budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        if (_memoryBudgetSupported) {
+            VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+            memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            memoryProperties.pNext = &budgetProperties;
+            vkGetPhysicalDeviceMemoryProperties2(_physicalDevice, &memoryProperties);
+        }
+
+        MemoryStatistics statistics{};
+        statistics.budgetExtension = _memoryBudgetSupported;
+        statistics.heapCount = _memoryProperties.memoryHeapCount;
+        std::lock_guard<std::mutex> lock{_memoryMutex};
+        for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; i++) {
+            MemoryHeapStatistics &heap = statistics.heaps[i];
+            heap.heapIndex = i;
+            heap.deviceLocal = (_memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            heap.size = _memoryProperties.memoryHeaps[i].size;
+            heap.categoryBytes = _allocatedBytes[i];
+            for (VkDeviceSize bytes : heap.categoryBytes) {
+                heap.allocatedBytes += bytes;
+            }
+            heap.allocationCount = _allocationCounts[i];
+            if (_memoryBudgetSupported) {
+                heap.budget = budgetProperties.heapBudget[i];
+                heap.usage = budgetProperties.heapUsage[i];
+            } else {
+                heap.budget = static_cast<VkDeviceSize>(static_cast<double>(heap.size) * ESTIMATED_BUDGET_SHARE);
+                heap.usage = heap.allocatedBytes;
+            }
+        }
+        return statistics;
+    }
+
+    // Streaming systems register here to evict when a heap runs over budget, and to grow again after //
+    void Device::addMemoryBudgetCallback(MemoryBudgetCallback callback) {
+        _memoryBudgetCallbacks.push_back(std::move(callback));
+    }
+
+    // Call once a frame, from the render thread; allocates nothing //
+    void Device::checkMemoryBudget() {
+        if (_memoryBudgetCallbacks.empty()) {
+            return;
+        }
+        MemoryStatistics statistics = getMemoryStatistics();
+        for (uint32_t i = 0; i < statistics.heapCount; i++) {
+            for (const MemoryBudgetCallback &callback : _memoryBudgetCallbacks) {
+                callback(statistics.heaps[i]);
+            }
+        }
+    }
+
+    void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &bufferMemory, MemoryCategory category) {
         VkBufferCreateInfo bufferInformation{};
         bufferInformation.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInformation.size = size;
@@ -408,15 +834,7 @@ namespace vulkan {
 
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(_device, buffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInformation{};
-        allocInformation.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInformation.allocationSize = memRequirements.size;
-        allocInformation.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(_device, &allocInformation, nullptr, &bufferMemory) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to allocate vertex buffer memory.");
-        }
+        bufferMemory = allocateMemory(memRequirements, properties, category);
 
         vkBindBufferMemory(_device, buffer, bufferMemory, 0);
     }
@@ -485,22 +903,14 @@ namespace vulkan {
         endSingleTimeCommands(commandBuffer);
     }
 
-    void Device::createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory) {
+    void Device::createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory, MemoryCategory category) {
         if (vkCreateImage(_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
             throw std::runtime_error("failed to create image!");
         }
 
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(_device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInformation{};
-        allocInformation.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInformation.allocationSize = memRequirements.size;
-        allocInformation.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(_device, &allocInformation, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
+        imageMemory = allocateMemory(memRequirements, properties, category);
 
         if (vkBindImageMemory(_device, image, imageMemory, 0) != VK_SUCCESS) {
             throw std::runtime_error("failed to bind image memory!");
@@ -508,6 +918,9 @@ namespace vulkan {
     }
 
     Device::~Device() {
+        if (_computeCommandPool != _commandPool) {
+            vkDestroyCommandPool(_device, _computeCommandPool, nullptr);
+        }
         vkDestroyCommandPool(_device, _commandPool, nullptr);
         vkDestroyDevice(_device, nullptr);
 
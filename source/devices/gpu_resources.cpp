@@ -0,0 +1,95 @@
+#include "devices/gpu_resources.hpp"
+
+#include <stdexcept>
+
+namespace vulkan {
+
+    GpuResources::GpuResources(Device &device, DeletionQueue &deletionQueue) : _device{device}, _deletionQueue{deletionQueue} {}
+
+    BufferHandle GpuResources::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, MemoryCategory category) {
+        GpuBuffer buffer;
+        buffer.size = size;
+        _device.createBuffer(size, usage, properties, buffer.buffer, buffer.memory, category);
+        if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 && vkMapMemory(_device.getDevice(), buffer.memory, 0, size, 0, &buffer.mapped) != VK_SUCCESS) {
+            destroyBuffer(_device, buffer);
+            throw std::runtime_error("Failed to map buffer memory.");
+        }
+        return _buffers.create(std::move(buffer));
+    }
+
+    ImageHandle GpuResources::createImage(const VkImageCreateInfo &imageInfo, VkImageAspectFlags aspectMask, VkMemoryPropertyFlags properties) {
+        GpuImage image;
+        image.format = imageInfo.format;
+        image.extent = imageInfo.extent;
+        _device.createImageWithInfo(imageInfo, properties, image.image, image.memory);
+
+        VkImageViewCreateInfo viewInformation{};
+        viewInformation.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInformation.image = image.image;
+        viewInformation.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInformation.format = imageInfo.format;
+        viewInformation.subresourceRange.aspectMask = aspectMask;
+        viewInformation.subresourceRange.baseMipLevel = 0;
+        viewInformation.subresourceRange.levelCount = imageInfo.mipLevels;
+        viewInformation.subresourceRange.baseArrayLayer = 0;
+        viewInformation.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(_device.getDevice(), &viewInformation, nullptr, &image.view) != VK_SUCCESS) {
+            destroyImage(_device, image);
+            throw std::runtime_error("Failed to create image view.");
+        }
+        return _images.create(std::move(image));
+    }
+
+    GpuBuffer *GpuResources::getBuffer(BufferHandle handle) {
+        return _buffers.get(handle);
+    }
+
+    GpuImage *GpuResources::getImage(ImageHandle handle) {
+        return _images.get(handle);
+    }
+
+    bool GpuResources::release(BufferHandle handle) {
+        Device *device = &_device;
+        return _buffers.release(handle, _deletionQueue, [device](GpuBuffer &buffer) { destroyBuffer(*device, buffer); });
+    }
+
+    bool GpuResources::release(ImageHandle handle) {
+        Device *device = &_device;
+        return _images.release(handle, _deletionQueue, [device](GpuImage &image) { destroyImage(*device, image); });
+    }
+
+    uint32_t GpuResources::getBufferCount() const {
+        return _buffers.size();
+    }
+
+    uint32_t GpuResources::getImageCount() const {
+        return _images.size();
+    }
+
+    void GpuResources::destroyBuffer(Device &device, GpuBuffer &buffer) {
+        if (buffer.mapped != nullptr) {
+            vkUnmapMemory(device.getDevice(), buffer.memory);
+        }
+        vkDestroyBuffer(device.getDevice(), buffer.buffer, nullptr);
+        device.freeMemory(buffer.memory);
+    }
+
+    void GpuResources::destroyImage(Device &device, GpuImage &image) {
+        if (image.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(device.getDevice(), image.view, nullptr);
+        }
+        vkDestroyImage(device.getDevice(), image.image, nullptr);
+        device.freeMemory(image.memory);
+    }
+
+    GpuResources::~GpuResources() {
+        for (GpuBuffer &buffer : _buffers) {
+            destroyBuffer(_device, buffer);
+        }
+        for (GpuImage &image : _images) {
+            destroyImage(_device, image);
+        }
+    }
+
+}
@@ -0,0 +1,43 @@
+#include "pipeline/compute_pipeline.hpp"
+#include "pipeline/shader_registry.hpp"
+
+#include <stdexcept>
+
+namespace vulkan {
+
+    ComputePipeline::ComputePipeline(Device &device, const std::string &compShader, VkPipelineLayout pipelineLayout) : _device{device} {
+        ShaderCode code = ShaderRegistry::getShader(compShader);
+
+        VkShaderModuleCreateInfo moduleInformation{};
+        moduleInformation.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInformation.codeSize = code.size;
+        moduleInformation.pCode = code.code;
+        if (vkCreateShaderModule(_device.getDevice(), &moduleInformation, nullptr, &_shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute shader module.");
+        }
+
+        VkComputePipelineCreateInfo pipelineInformation{};
+        pipelineInformation.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInformation.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInformation.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInformation.stage.module = _shaderModule;
+        pipelineInformation.stage.pName = "main";
+        pipelineInformation.layout = pipelineLayout;
+        pipelineInformation.basePipelineIndex = -1;
+        pipelineInformation.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(_device.getDevice(), VK_NULL_HANDLE, 1, &pipelineInformation, nullptr, &_computePipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute pipeline.");
+        }
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _computePipeline);
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        vkDestroyShaderModule(_device.getDevice(), _shaderModule, nullptr);
+        vkDestroyPipeline(_device.getDevice(), _computePipeline, nullptr);
+    }
+
+}
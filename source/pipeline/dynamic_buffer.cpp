@@ -0,0 +1,149 @@
+#include "pipeline/dynamic_buffer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace vulkan {
+
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    DynamicBuffer::DynamicBuffer(Device &device, VkDeviceSize frameSize, uint32_t frameCount) : _device{device}, _frameCount{frameCount} {
+        const VkPhysicalDeviceLimits &limits = _device._properties.limits;
+        _uniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+        _storageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 1);
+        _nonCoherentAtomSize = std::max<VkDeviceSize>(limits.nonCoherentAtomSize, 1);
+
+        // Slices start on an atom boundary so flushing one frame never touches another //
+        _frameSize = alignUp(frameSize, std::max({_nonCoherentAtomSize, _uniformAlignment, _storageAlignment, VERTEX_ALIGNMENT}));
+        allocateMemory();
+    }
+
+    void DynamicBuffer::allocateMemory() {
+        VkBufferCreateInfo bufferInformation{};
+        bufferInformation.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInformation.size = _frameSize * _frameCount;
+        bufferInformation.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        bufferInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(_device.getDevice(), &bufferInformation, nullptr, &_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create dynamic buffer.");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetBufferMemoryRequirements(_device.getDevice(), _buffer, &memRequirements);
+
+        // Prefer memory the GPU reads at full speed, then plain coherent host memory, then anything mappable //
+        const VkMemoryPropertyFlags preferences[] = {
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+        };
+        uint32_t memoryType = UINT32_MAX;
+        for (VkMemoryPropertyFlags properties : preferences) {
+            try {
+                memoryType = _device.findMemoryType(memRequirements.memoryTypeBits, properties);
+                break;
+            } catch (const std::runtime_error &) {
+                continue;
+            }
+        }
+        if (memoryType == UINT32_MAX) {
+            throw std::runtime_error("Failed to find host visible memory for the dynamic buffer.");
+        }
+        _coherent = (_device.getMemoryTypeProperties(memoryType) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+        _memory = _device.allocateMemory(memRequirements.size, memoryType, MemoryCategory::Buffer);
+        vkBindBufferMemory(_device.getDevice(), _buffer, _memory, 0);
+
+        void *data;
+        if (vkMapMemory(_device.getDevice(), _memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map dynamic buffer memory.");
+        }
+        _mapped = static_cast<uint8_t *>(data);
+    }
+
+    // Call once the fence of `frameIndex` has signalled: the GPU is done with that slice //
+    void DynamicBuffer::beginFrame(uint32_t frameIndex) {
+        _frame = frameIndex % _frameCount;
+        _offset = 0;
+        _flushedOffset = 0;
+    }
+
+    bool DynamicBuffer::allocate(VkDeviceSize size, VkDeviceSize alignment, DynamicAllocation &allocation) {
+        VkDeviceSize begin = alignUp(_offset, std::max<VkDeviceSize>(alignment, 1));
+        if (begin + size > _frameSize) {
+            return false;
+        }
+        _offset = begin + size;
+
+        VkDeviceSize offset = _frame * _frameSize + begin;
+        allocation.data = _mapped + offset;
+        allocation.buffer = _buffer;
+        allocation.offset = offset;
+        allocation.size = size;
+        return true;
+    }
+
+    bool DynamicBuffer::allocateVertices(VkDeviceSize size, DynamicAllocation &allocation) {
+        return allocate(size, VERTEX_ALIGNMENT, allocation);
+    }
+
+    bool DynamicBuffer::allocateIndices(VkDeviceSize size, VkIndexType indexType, DynamicAllocation &allocation) {
+        return allocate(size, indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4, allocation);
+    }
+
+    bool DynamicBuffer::allocateUniform(VkDeviceSize size, DynamicAllocation &allocation) {
+        return allocate(size, _uniformAlignment, allocation);
+    }
+
+    bool DynamicBuffer::allocateStorage(VkDeviceSize size, DynamicAllocation &allocation) {
+        return allocate(size, _storageAlignment, allocation);
+    }
+
+    // Call before submitting work that reads this frame's allocations //
+    void DynamicBuffer::flush() {
+        if (_coherent || _offset == _flushedOffset) {
+            _flushedOffset = _offset;
+            return;
+        }
+
+        VkDeviceSize frameBase = _frame * _frameSize;
+        VkDeviceSize begin = _flushedOffset / _nonCoherentAtomSize * _nonCoherentAtomSize;
+        VkDeviceSize end = std::min(alignUp(_offset, _nonCoherentAtomSize), _frameSize);
+
+        VkMappedMemoryRange range{};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = _memory;
+        range.offset = frameBase + begin;
+        range.size = end - begin;
+        if (vkFlushMappedMemoryRanges(_device.getDevice(), 1, &range) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to flush dynamic buffer memory.");
+        }
+        _flushedOffset = _offset;
+    }
+
+    VkBuffer DynamicBuffer::getBuffer() {
+        return _buffer;
+    }
+
+    VkDeviceSize DynamicBuffer::getFrameSize() {
+        return _frameSize;
+    }
+
+    VkDeviceSize DynamicBuffer::getUsed() {
+        return _offset;
+    }
+
+    bool DynamicBuffer::isCoherent() {
+        return _coherent;
+    }
+
+    DynamicBuffer::~DynamicBuffer() {
+        vkUnmapMemory(_device.getDevice(), _memory);
+        vkDestroyBuffer(_device.getDevice(), _buffer, nullptr);
+        _device.freeMemory(_memory);
+    }
+
+}
@@ -0,0 +1,122 @@
+#include "pipeline/dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vulkan {
+
+    DynamicResolution::DynamicResolution(Device &device, float frameBudget) : _device{device}, _frameBudget{frameBudget} {
+        // Only the valid bits of a timestamp count, and a family with none has no timestamps at all //
+        uint32_t validBits = _device.getQueueFamilyProperties(_device.findPhysicalQueueFamilies().graphicsFamily).timestampValidBits;
+        _timestampsSupported = validBits > 0;
+        _timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t{1} << validBits) - 1;
+        _timestampPeriod = _device._properties.limits.timestampPeriod;
+    }
+
+    // Queries 2i and 2i + 1 bracket the command buffer of swap-chain image i //
+    void DynamicResolution::createQueries(size_t imageCount) {
+        destroyQueries();
+        _queriesWritten.assign(imageCount, false);
+        if (!_timestampsSupported) {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInformation{};
+        queryPoolInformation.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInformation.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInformation.queryCount = static_cast<uint32_t>(imageCount * 2);
+        if (vkCreateQueryPool(_device.getDevice(), &queryPoolInformation, nullptr, &_queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create timestamp query pool.");
+        }
+    }
+
+    void DynamicResolution::destroyQueries() {
+        if (_queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(_device.getDevice(), _queryPool, nullptr);
+            _queryPool = VK_NULL_HANDLE;
+        }
+        _queriesWritten.clear();
+    }
+
+    // Recorded first, outside any rendering: the reset is a transfer command. The frame's submission //
+    // waits for the swap-chain image at the colour attachment output stage, so a timestamp taken there //
+    // starts after the image is available; at the top of the pipe it would time the wait too //
+    void DynamicResolution::recordBegin(VkCommandBuffer commandBuffer, int imageIndex) {
+        if (_queryPool == VK_NULL_HANDLE) {
+            return;
+        }
+        vkCmdResetQueryPool(commandBuffer, _queryPool, static_cast<uint32_t>(imageIndex) * 2, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, _queryPool, static_cast<uint32_t>(imageIndex) * 2);
+    }
+
+    void DynamicResolution::recordEnd(VkCommandBuffer commandBuffer, int imageIndex) {
+        if (_queryPool == VK_NULL_HANDLE) {
+            return;
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queryPool, static_cast<uint32_t>(imageIndex) * 2 + 1);
+        _queriesWritten[imageIndex] = true;
+    }
+
+    // Call once the image is acquired, before its command buffer is re-recorded. Returns true when a new //
+    // sample was taken //
+    bool DynamicResolution::measure(int imageIndex) {
+        if (_queryPool == VK_NULL_HANDLE || !_queriesWritten[imageIndex]) {
+            return false;
+        }
+
+        // The image's previous submission has completed, so the results are there unless it was never submitted //
+        uint64_t timestamps[2];
+        if (vkGetQueryPoolResults(_device.getDevice(), _queryPool, static_cast<uint32_t>(imageIndex) * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return false;
+        }
+        uint64_t ticks = ((timestamps[1] & _timestampMask) - (timestamps[0] & _timestampMask)) & _timestampMask;
+        float sample = static_cast<float>(static_cast<double>(ticks) * _timestampPeriod / 1000000.0);
+        _gpuTime = _gpuTime == 0.0f ? sample : _gpuTime + (sample - _gpuTime) * SMOOTHING;
+        _framesSinceChange++;
+        return true;
+    }
+
+    // Call after measure, only when the swap-chain renders at a scaled extent. Returns true when the scale //
+    // changed, and with it the render extent baked into the command buffers //
+    bool DynamicResolution::update() {
+        if (_gpuTime == 0.0f || _framesSinceChange < SETTLE_FRAMES) {
+            return false;
+        }
+
+        uint32_t scalePercent = _scalePercent;
+        if (_gpuTime > _frameBudget) {
+            // GPU time follows the pixel count, the square of the scale: jump straight to the estimate //
+            uint32_t estimate = static_cast<uint32_t>(static_cast<float>(_scalePercent) * std::sqrt(_frameBudget / _gpuTime));
+            estimate -= estimate % SCALE_STEP_PERCENT;
+            scalePercent = std::max(MIN_SCALE_PERCENT, std::min(_scalePercent - SCALE_STEP_PERCENT, estimate));
+        } else if (_gpuTime < _frameBudget * RAISE_THRESHOLD) {
+            scalePercent = std::min(MAX_SCALE_PERCENT, _scalePercent + SCALE_STEP_PERCENT);
+        }
+
+        if (scalePercent == _scalePercent) {
+            return false;
+        }
+        _scalePercent = scalePercent;
+        _framesSinceChange = 0;
+        return true;
+    }
+
+    VkExtent2D DynamicResolution::getRenderExtent(VkExtent2D extent) const {
+        return {std::max(1u, extent.width * _scalePercent / 100), std::max(1u, extent.height * _scalePercent / 100)};
+    }
+
+    float DynamicResolution::getScale() const {
+        return static_cast<float>(_scalePercent) / 100.0f;
+    }
+
+    // Smoothed, in milliseconds; 0 until measured, and always without timestamps //
+    float DynamicResolution::getGpuTime() const {
+        return _gpuTime;
+    }
+
+    DynamicResolution::~DynamicResolution() {
+        destroyQueries();
+    }
+
+}
@@ -0,0 +1,143 @@
+#include "pipeline/frame_pacer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace vulkan {
+
+    FramePacer::FramePacer(Device &device) : _presentWait{device.isPresentWaitSupported()} {}
+
+    float FramePacer::toMilliseconds(Clock::duration duration) {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+
+    // Call before acquiring the swap-chain image //
+    void FramePacer::beginFrame(SwapChain &swapChain) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point start = now;
+        if (_presentWait) {
+            // The previous frame reaching the screen marks a refresh: the next one is an interval later //
+            if (_pendingSwapChain == &swapChain && swapChain.waitForPresent(_pendingPresentId, PRESENT_TIMEOUT) == VK_SUCCESS) {
+                now = Clock::now();
+                recordLatency(toMilliseconds(now - _pendingInputTime));
+                if (_presentTimed) {
+                    // A missed refresh shows up as a multiple of the interval: only single ones refine it //
+                    float interval = toMilliseconds(now - _lastPresent);
+                    if (interval < _refreshInterval * 1.5f) {
+                        _refreshInterval += (interval - _refreshInterval) * SMOOTHING;
+                    }
+                }
+                _lastPresent = now;
+                _presentTimed = true;
+            }
+            _pendingSwapChain = nullptr;
+        } else {
+            // Presents are paced by FIFO, so frames start a refresh apart once the queue is full //
+            if (_frameTimed) {
+                float interval = toMilliseconds(now - _lastFrameStart);
+                if (interval < _refreshInterval * 1.5f) {
+                    _refreshInterval += (interval - _refreshInterval) * SMOOTHING;
+                }
+            }
+        }
+
+        if (_presentWait && _gpuTimed) {
+            // From the last present: when the wait did not complete, it is stale and the frame starts at once //
+            float slack = _refreshInterval - _workTime - SAFETY_MARGIN;
+            if (slack > 0.0f && _presentTimed) {
+                start = std::max(now, _lastPresent + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(slack)));
+            }
+        } else {
+            start = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(_delay));
+        }
+
+        if (start > now) {
+            std::this_thread::sleep_until(start);
+        }
+        _frameStart = Clock::now();
+        _lastFrameStart = _frameStart;
+        _frameTimed = true;
+        _inputTime = _frameStart;
+    }
+
+    // Call right after acquiring the swap-chain image, before any other work of the frame //
+    void FramePacer::markImageAcquired() {
+        _inputTime = Clock::now();
+        _acquireTime = toMilliseconds(_inputTime - _frameStart);
+        if (!_presentWait || !_gpuTimed) {
+            // Time blocked on the swap-chain is latency: moved before the frame, it is spent before the input //
+            _delay = std::clamp(_delay + (_acquireTime - SAFETY_MARGIN) * DELAY_GAIN, 0.0f, _refreshInterval);
+        }
+    }
+
+    // Call right after polling input //
+    void FramePacer::markInputSampled() {
+        _inputTime = Clock::now();
+    }
+
+    // Call once the frame is presented, with the measured GPU time of a frame, which must exclude the //
+    // wait for the swap-chain image; 0 when it is not measured, and the frames are then paced on the CPU //
+    // side only //
+    void FramePacer::endFrame(SwapChain &swapChain, float gpuTime) {
+        Clock::time_point now = Clock::now();
+        float cpuTime = toMilliseconds(now - _inputTime);
+
+        // All of the frame's CPU work but the acquire, which only waits. Jumps up at once and decays //
+        // slowly, so one fast frame does not start the next one too late //
+        _gpuTimed = gpuTime > 0.0f;
+        float workTime = std::max(0.0f, toMilliseconds(now - _frameStart) - _acquireTime) + gpuTime;
+        _workTime = workTime > _workTime ? workTime : _workTime + (workTime - _workTime) * SMOOTHING;
+
+        if (_presentWait) {
+            _pendingSwapChain = &swapChain;
+            _pendingPresentId = swapChain.getPresentId();
+            _pendingInputTime = _inputTime;
+        } else {
+            // Scanout begins, on average, half a refresh after the frame is done //
+            recordLatency(cpuTime + gpuTime + _refreshInterval * 0.5f);
+        }
+    }
+
+    // Call when the swap-chain is recreated: present ids restart and the timings no longer hold //
+    void FramePacer::reset() {
+        _pendingSwapChain = nullptr;
+        _presentTimed = false;
+        _frameTimed = false;
+        _gpuTimed = false;
+        _delay = 0.0f;
+    }
+
+    void FramePacer::recordLatency(float latency) {
+        _latency = latency;
+        _latencySum += latency;
+        _maxLatency = std::max(_maxLatency, latency);
+        _latencyCount++;
+    }
+
+    bool FramePacer::usesPresentWait() const {
+        return _presentWait;
+    }
+
+    // Of the last frame measured, in milliseconds: from sampling its input to its present completing with //
+    // present wait, estimated otherwise //
+    float FramePacer::getLatency() const {
+        return _latency;
+    }
+
+    float FramePacer::getAverageLatency() const {
+        return _latencyCount > 0 ? static_cast<float>(_latencySum / static_cast<double>(_latencyCount)) : 0.0f;
+    }
+
+    float FramePacer::getMaxLatency() const {
+        return _maxLatency;
+    }
+
+    uint64_t FramePacer::getLatencyCount() const {
+        return _latencyCount;
+    }
+
+    float FramePacer::getRefreshInterval() const {
+        return _refreshInterval;
+    }
+
+}
@@ -0,0 +1,301 @@
+#include "pipeline/mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace vulkan {
+
+    void MeshSimplifier::Quadric::addLine(double a, double b, double c) {
+        aa += a * a;
+        ab += a * b;
+        ac += a * c;
+        bb += b * b;
+        bc += b * c;
+        cc += c * c;
+    }
+
+    void MeshSimplifier::Quadric::add(const Quadric &quadric) {
+        aa += quadric.aa;
+        ab += quadric.ab;
+        ac += quadric.ac;
+        bb += quadric.bb;
+        bc += quadric.bc;
+        cc += quadric.cc;
+    }
+
+    double MeshSimplifier::Quadric::evaluate(glm::vec2 position) const {
+        double x = position.x;
+        double y = position.y;
+        return aa * x * x + 2.0 * ab * x * y + 2.0 * ac * x + bb * y * y + 2.0 * bc * y + cc;
+    }
+
+    // Takes a non-indexed triangle list, as Model draws it //
+    MeshSimplifier::MeshSimplifier(const std::vector<Model::Vertex> &vertices) {
+        weld(vertices);
+        addBoundaryQuadrics();
+        for (uint32_t vertex = 0; vertex < _positions.size(); vertex++) {
+            pushCollapses(vertex);
+        }
+    }
+
+    // Corners at the same position become one vertex, keeping the first one's color //
+    void MeshSimplifier::weld(const std::vector<Model::Vertex> &vertices) {
+        std::unordered_map<uint64_t, uint32_t> indices;
+        std::array<uint32_t, 3> triangle{};
+        for (size_t i = 0; i < vertices.size(); i++) {
+            uint32_t x, y;
+            std::memcpy(&x, &vertices[i].position.x, sizeof(x));
+            std::memcpy(&y, &vertices[i].position.y, sizeof(y));
+            std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> inserted = indices.emplace((static_cast<uint64_t>(x) << 32) | y, static_cast<uint32_t>(_positions.size()));
+            if (inserted.second) {
+                _positions.push_back(vertices[i].position);
+                _colors.push_back(vertices[i].color);
+            }
+            triangle[i % 3] = inserted.first->second;
+
+            bool degenerate = triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2];
+            if (i % 3 == 2 && !degenerate) {
+                _triangles.push_back(triangle);
+            }
+        }
+
+        _quadrics.resize(_positions.size());
+        _versions.assign(_positions.size(), 0);
+        _removedVertices.assign(_positions.size(), false);
+        _vertexTriangles.resize(_positions.size());
+        _removedTriangles.assign(_triangles.size(), false);
+        _triangleCount = _triangles.size();
+        for (uint32_t triangle = 0; triangle < _triangles.size(); triangle++) {
+            for (uint32_t corner : _triangles[triangle]) {
+                _vertexTriangles[corner].push_back(triangle);
+            }
+        }
+    }
+
+    // An edge used by a single triangle is on the outline //
+    void MeshSimplifier::addBoundaryQuadrics() {
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        for (const std::array<uint32_t, 3> &triangle : _triangles) {
+            for (size_t corner = 0; corner < 3; corner++) {
+                uint32_t a = triangle[corner];
+                uint32_t b = triangle[(corner + 1) % 3];
+                edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+            }
+        }
+
+        for (const std::array<uint32_t, 3> &triangle : _triangles) {
+            for (size_t corner = 0; corner < 3; corner++) {
+                uint32_t a = triangle[corner];
+                uint32_t b = triangle[(corner + 1) % 3];
+                if (edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)] != 1) {
+                    continue;
+                }
+                double dx = static_cast<double>(_positions[b].x) - _positions[a].x;
+                double dy = static_cast<double>(_positions[b].y) - _positions[a].y;
+                double length = std::sqrt(dx * dx + dy * dy);
+                if (length == 0.0) {
+                    continue;
+                }
+                double nx = -dy / length;
+                double ny = dx / length;
+                double c = -(nx * _positions[a].x + ny * _positions[a].y);
+                _quadrics[a].addLine(nx, ny, c);
+                _quadrics[b].addLine(nx, ny, c);
+            }
+        }
+    }
+
+    void MeshSimplifier::pushCollapses(uint32_t vertex) {
+        for (uint32_t triangle : _vertexTriangles[vertex]) {
+            if (_removedTriangles[triangle]) {
+                continue;
+            }
+            for (uint32_t corner : _triangles[triangle]) {
+                if (corner != vertex) {
+                    _collapses.push(evaluate(vertex, corner));
+                }
+            }
+        }
+    }
+
+    // The merged vertex goes to whichever of the two ends or the midpoint costs least //
+    MeshSimplifier::Collapse MeshSimplifier::evaluate(uint32_t from, uint32_t to) const {
+        Quadric quadric = _quadrics[from];
+        quadric.add(_quadrics[to]);
+
+        std::array<glm::vec2, 3> positions = {_positions[to], _positions[from], (_positions[from] + _positions[to]) * 0.5f};
+        std::array<glm::vec3, 3> colors = {_colors[to], _colors[from], (_colors[from] + _colors[to]) * 0.5f};
+        Collapse collapse{};
+        collapse.from = from;
+        collapse.to = to;
+        collapse.fromVersion = _versions[from];
+        collapse.toVersion = _versions[to];
+        collapse.cost = -1.0;
+        for (size_t candidate = 0; candidate < positions.size(); candidate++) {
+            double cost = std::max(0.0, quadric.evaluate(positions[candidate]));
+            if (collapse.cost < 0.0 || cost < collapse.cost) {
+                collapse.cost = cost;
+                collapse.position = positions[candidate];
+                collapse.color = colors[candidate];
+            }
+        }
+        return collapse;
+    }
+
+    static float signedArea(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    bool MeshSimplifier::isValid(const Collapse &collapse) const {
+        // The two ends may only share the vertices opposite the edge, or the mesh pinches into a non-manifold //
+        std::vector<uint32_t> fromNeighbours;
+        size_t sharedTriangles = 0;
+        for (uint32_t triangle : _vertexTriangles[collapse.from]) {
+            if (_removedTriangles[triangle]) {
+                continue;
+            }
+            const std::array<uint32_t, 3> &corners = _triangles[triangle];
+            if (std::find(corners.begin(), corners.end(), collapse.to) != corners.end()) {
+                sharedTriangles++;
+            }
+            fromNeighbours.insert(fromNeighbours.end(), corners.begin(), corners.end());
+        }
+        if (sharedTriangles == 0) {
+            return false;
+        }
+        std::sort(fromNeighbours.begin(), fromNeighbours.end());
+        fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+
+        std::vector<uint32_t> commonNeighbours;
+        for (uint32_t triangle : _vertexTriangles[collapse.to]) {
+            if (_removedTriangles[triangle]) {
+                continue;
+            }
+            for (uint32_t corner : _triangles[triangle]) {
+                if (corner != collapse.from && corner != collapse.to && std::binary_search(fromNeighbours.begin(), fromNeighbours.end(), corner)) {
+                    commonNeighbours.push_back(corner);
+                }
+            }
+        }
+        std::sort(commonNeighbours.begin(), commonNeighbours.end());
+        if (static_cast<size_t>(std::unique(commonNeighbours.begin(), commonNeighbours.end()) - commonNeighbours.begin()) > sharedTriangles) {
+            return false;
+        }
+
+        // No remaining triangle may turn over or collapse to nothing //
+        for (uint32_t end : {collapse.from, collapse.to}) {
+            for (uint32_t triangle : _vertexTriangles[end]) {
+                const std::array<uint32_t, 3> &corners = _triangles[triangle];
+                if (_removedTriangles[triangle] || std::find(corners.begin(), corners.end(), end == collapse.from ? collapse.to : collapse.from) != corners.end()) {
+                    continue;
+                }
+                std::array<glm::vec2, 3> moved;
+                for (size_t corner = 0; corner < 3; corner++) {
+                    moved[corner] = corners[corner] == end ? collapse.position : _positions[corners[corner]];
+                }
+                float before = signedArea(_positions[corners[0]], _positions[corners[1]], _positions[corners[2]]);
+                float after = signedArea(moved[0], moved[1], moved[2]);
+                if (before * after <= 0.0f || std::abs(after) < std::abs(before) * 1e-3f) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void MeshSimplifier::apply(const Collapse &collapse) {
+        for (uint32_t triangle : _vertexTriangles[collapse.from]) {
+            if (_removedTriangles[triangle]) {
+                continue;
+            }
+            std::array<uint32_t, 3> &corners = _triangles[triangle];
+            if (std::find(corners.begin(), corners.end(), collapse.to) != corners.end()) {
+                _removedTriangles[triangle] = true;
+                _triangleCount--;
+                continue;
+            }
+            std::replace(corners.begin(), corners.end(), collapse.from, collapse.to);
+            _vertexTriangles[collapse.to].push_back(triangle);
+        }
+        _vertexTriangles[collapse.from].clear();
+        _removedVertices[collapse.from] = true;
+
+        std::vector<uint32_t> &toTriangles = _vertexTriangles[collapse.to];
+        toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [this](uint32_t triangle) { return _removedTriangles[triangle]; }), toTriangles.end());
+
+        _positions[collapse.to] = collapse.position;
+        _colors[collapse.to] = collapse.color;
+        _quadrics[collapse.to].add(_quadrics[collapse.from]);
+        _versions[collapse.to]++;
+        _maxCost = std::max(_maxCost, collapse.cost);
+        pushCollapses(collapse.to);
+    }
+
+    // Cheapest collapse first, until the target is reached or nothing can be collapsed any more. Queued //
+    // collapses whose ends have changed since are stale and dropped; the changed vertex queued fresh ones //
+    bool MeshSimplifier::simplify(size_t targetTriangles) {
+        while (_triangleCount > targetTriangles && !_collapses.empty()) {
+            Collapse collapse = _collapses.top();
+            _collapses.pop();
+            if (_removedVertices[collapse.from] || _removedVertices[collapse.to] || _versions[collapse.from] != collapse.fromVersion || _versions[collapse.to] != collapse.toVersion) {
+                continue;
+            }
+            if (isValid(collapse)) {
+                apply(collapse);
+            }
+        }
+        return _triangleCount <= targetTriangles;
+    }
+
+    size_t MeshSimplifier::getTriangleCount() const {
+        return _triangleCount;
+    }
+
+    // The largest distance, in model units, a collapse so far has moved the outline //
+    float MeshSimplifier::getError() const {
+        return static_cast<float>(std::sqrt(_maxCost));
+    }
+
+    std::vector<Model::Vertex> MeshSimplifier::getVertices() const {
+        std::vector<Model::Vertex> vertices;
+        vertices.reserve(_triangleCount * 3);
+        for (size_t triangle = 0; triangle < _triangles.size(); triangle++) {
+            if (_removedTriangles[triangle]) {
+                continue;
+            }
+            for (uint32_t corner : _triangles[triangle]) {
+                vertices.push_back({_positions[corner], _colors[corner]});
+            }
+        }
+        return vertices;
+    }
+
+    // Level 0 is the mesh as given; each next level halves the triangles, until that no longer pays off //
+    Model::LodMesh MeshSimplifier::buildLodChain(const std::vector<Model::Vertex> &vertices) {
+        Model::LodMesh mesh;
+        mesh.vertices = vertices;
+        mesh.lods.push_back({0, static_cast<uint32_t>(vertices.size()), 0.0f});
+
+        MeshSimplifier simplifier{vertices};
+        size_t triangles = simplifier.getTriangleCount();
+        while (mesh.lods.size() < MAX_LODS) {
+            size_t target = static_cast<size_t>(static_cast<float>(triangles) * LOD_REDUCTION);
+            if (target == 0) {
+                break;
+            }
+            simplifier.simplify(target);
+            if (static_cast<float>(simplifier.getTriangleCount()) > static_cast<float>(triangles) * MIN_LOD_REDUCTION) {
+                break;
+            }
+
+            std::vector<Model::Vertex> level = simplifier.getVertices();
+            mesh.lods.push_back({static_cast<uint32_t>(mesh.vertices.size()), static_cast<uint32_t>(level.size()), simplifier.getError()});
+            mesh.vertices.insert(mesh.vertices.end(), level.begin(), level.end());
+            triangles = simplifier.getTriangleCount();
+        }
+        return mesh;
+    }
+
+}
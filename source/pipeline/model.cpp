@@ -1,23 +1,35 @@
 #include "pipeline/model.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 namespace vulkan {
 
-    Model::Model(Device &device, const std::vector<Vertex> &vertices) : _device{device} {
-        createVertexBuffers(vertices);
+    Model::Model(Device &device, const std::vector<Vertex> &vertices) : Model{device, vertices.data(), static_cast<uint32_t>(vertices.size()), {{0, static_cast<uint32_t>(vertices.size()), 0.0f}}, {{0, 1}}} {
     }
 
-    void Model::createVertexBuffers(const std::vector<Vertex> &vertices) {
-        _vertexCount = static_cast<uint32_t>(vertices.size());
+    Model::Model(Device &device, const LodMesh &mesh) : Model{device, mesh.vertices.data(), static_cast<uint32_t>(mesh.vertices.size()), mesh.lods, {{0, static_cast<uint32_t>(mesh.lods.size())}}} {
+    }
+
+    // All the levels of all the meshes share the one vertex buffer, so switching level only changes the //
+    // draw's range. The vertices may point straight into a mapped file: they are copied once, to the GPU //
+    Model::Model(Device &device, const Vertex *vertices, uint32_t vertexCount, std::vector<ModelLod> lods, std::vector<ModelMesh> meshes) : _device{device}, _lods{std::move(lods)}, _meshes{std::move(meshes)} {
+        assert(!_lods.empty() && "a model needs at least one level of detail.");
+        assert(!_meshes.empty() && "a model needs at least one mesh.");
+        createVertexBuffers(vertices, vertexCount);
+    }
+
+    void Model::createVertexBuffers(const Vertex *vertices, uint32_t vertexCount) {
+        _vertexCount = vertexCount;
         assert(_vertexCount >= 3 && "vertex count must be at least 3.");
         VkDeviceSize bufferSize = sizeof(vertices[0]) * _vertexCount;
         _device.createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _vertexBuffer, _vertexBufferMemory);
 
         void *data;
         vkMapMemory(_device.getDevice(), _vertexBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
+        memcpy(data, vertices, static_cast<size_t>(bufferSize));
         vkUnmapMemory(_device.getDevice(), _vertexBufferMemory);
     }
 
@@ -27,20 +39,53 @@ namespace vulkan {
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
     }
 
-    void Model::draw(VkCommandBuffer commandBuffer) {
-        vkCmdDraw(commandBuffer, _vertexCount, 1, 0 ,0);
+    void Model::draw(VkCommandBuffer commandBuffer, uint32_t firstInstance, uint32_t lod) {
+        vkCmdDraw(commandBuffer, _lods[lod].vertexCount, 1, _lods[lod].firstVertex, firstInstance);
+    }
+
+    // `pixelsPerUnit` is how many pixels one model unit covers on screen where the object is drawn. The //
+    // coarsest level whose error projects under LOD_PIXEL_ERROR is wanted, but an object only refines once //
+    // its level is clearly too coarse, and only coarsens once the next level is clearly fine enough, so it //
+    // does not flicker between two levels near the threshold. Levels are indices into the whole model //
+    uint32_t Model::selectLod(uint32_t mesh, float pixelsPerUnit, uint32_t currentLod) const {
+        uint32_t firstLod = _meshes[mesh].firstLod;
+        uint32_t lastLod = firstLod + _meshes[mesh].lodCount - 1;
+        uint32_t lod = std::max(firstLod, std::min(currentLod, lastLod));
+        while (lod > firstLod && _lods[lod].error * pixelsPerUnit > LOD_PIXEL_ERROR * (1.0f + LOD_HYSTERESIS)) {
+            lod--;
+        }
+        while (lod < lastLod && _lods[lod + 1].error * pixelsPerUnit <= LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS)) {
+            lod++;
+        }
+        return lod;
+    }
+
+    const ModelLod &Model::getLod(uint32_t lod) const {
+        return _lods[lod];
+    }
+
+    uint32_t Model::getLodCount() const {
+        return static_cast<uint32_t>(_lods.size());
+    }
+
+    const ModelMesh &Model::getMesh(uint32_t mesh) const {
+        return _meshes[mesh];
+    }
+
+    uint32_t Model::getMeshCount() const {
+        return static_cast<uint32_t>(_meshes.size());
     }
 
-    std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions() {
-        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    std::array<VkVertexInputBindingDescription, 1> Model::Vertex::getBindingDescriptions() {
+        std::array<VkVertexInputBindingDescription, 1> bindingDescriptions{};
         bindingDescriptions[0].binding = 0;
         bindingDescriptions[0].stride = sizeof(Vertex);
         bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
         return bindingDescriptions;
     }
 
-    std::vector<VkVertexInputAttributeDescription> Model::Vertex::getAttributeDescriptions() {
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+    std::array<VkVertexInputAttributeDescription, 2> Model::Vertex::getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
         attributeDescriptions[0].location = 0;
         attributeDescriptions[0].binding = 0;
         attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
@@ -55,7 +100,7 @@ namespace vulkan {
 
     Model::~Model() {
         vkDestroyBuffer(_device.getDevice(), _vertexBuffer, nullptr);
-        vkFreeMemory(_device.getDevice(), _vertexBufferMemory, nullptr);
+        _device.freeMemory(_vertexBufferMemory);
     }
 
 }
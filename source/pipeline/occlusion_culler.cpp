@@ -0,0 +1,401 @@
+#include "pipeline/occlusion_culler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace vulkan {
+
+    OcclusionCuller::OcclusionCuller(Device &device, BindlessTable &bindlessTable, uint32_t maxObjects) : _device{device}, _bindlessTable{bindlessTable}, _maxObjects{maxObjects} {
+        VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        createStorageBuffer(static_cast<VkDeviceSize>(_maxObjects) * sizeof(uint32_t), storage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _visibilityBuffer);
+        createStorageBuffer(static_cast<VkDeviceSize>(_maxObjects) * 2 * sizeof(VkDrawIndirectCommand), storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _commandBuffer);
+
+        createSampler();
+        createPipelineLayouts();
+        _cullPipeline = std::make_unique<ComputePipeline>(_device, "occlusion_cull.comp", _cullPipelineLayout);
+        _pyramidPipeline = std::make_unique<ComputePipeline>(_device, "depth_pyramid.comp", _pyramidPipelineLayout);
+
+        // Nothing was visible before the first frame: its early phase draws nothing //
+        VkCommandBuffer commandBuffer = _device.beginSingleTimeCommands();
+        vkCmdFillBuffer(commandBuffer, _visibilityBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+        _device.endSingleTimeCommands(commandBuffer);
+    }
+
+    void OcclusionCuller::createStorageBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, StorageBuffer &storageBuffer) {
+        _device.createBuffer(size, usage, properties, storageBuffer.buffer, storageBuffer.memory);
+        if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            vkMapMemory(_device.getDevice(), storageBuffer.memory, 0, size, 0, &storageBuffer.mapped);
+        }
+        storageBuffer.bindlessIndex = _bindlessTable.registerBuffer(storageBuffer.buffer);
+    }
+
+    void OcclusionCuller::destroyStorageBuffer(StorageBuffer &storageBuffer) {
+        _bindlessTable.releaseBuffer(storageBuffer.bindlessIndex);
+        if (storageBuffer.mapped != nullptr) {
+            vkUnmapMemory(_device.getDevice(), storageBuffer.memory);
+        }
+        vkDestroyBuffer(_device.getDevice(), storageBuffer.buffer, nullptr);
+        _device.freeMemory(storageBuffer.memory);
+        storageBuffer = StorageBuffer{};
+    }
+
+    // Point sampling: the cull test picks the level where the bounds span at most two texels, and takes //
+    // the farthest of the four corners itself //
+    void OcclusionCuller::createSampler() {
+        VkSamplerCreateInfo samplerInformation{};
+        samplerInformation.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInformation.magFilter = VK_FILTER_NEAREST;
+        samplerInformation.minFilter = VK_FILTER_NEAREST;
+        samplerInformation.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInformation.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInformation.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInformation.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInformation.anisotropyEnable = VK_FALSE;
+        samplerInformation.maxAnisotropy = 1.0f;
+        samplerInformation.compareEnable = VK_FALSE;
+        samplerInformation.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInformation.minLod = 0.0f;
+        samplerInformation.maxLod = VK_LOD_CLAMP_NONE;
+        samplerInformation.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+        samplerInformation.unnormalizedCoordinates = VK_FALSE;
+
+        if (vkCreateSampler(_device.getDevice(), &samplerInformation, nullptr, &_sampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid sampler.");
+        }
+    }
+
+    // Culling reaches everything through the bindless table. Building the pyramid writes storage images, //
+    // which the table does not hold, so each level gets a small set of its own: its source and itself //
+    void OcclusionCuller::createPipelineLayouts() {
+        VkPushConstantRange cullPushConstantRange{};
+        cullPushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        cullPushConstantRange.offset = 0;
+        cullPushConstantRange.size = sizeof(CullPushConstantData);
+
+        VkDescriptorSetLayout bindlessSetLayout = _bindlessTable.getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInformation{};
+        pipelineLayoutInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInformation.setLayoutCount = 1;
+        pipelineLayoutInformation.pSetLayouts = &bindlessSetLayout;
+        pipelineLayoutInformation.pushConstantRangeCount = 1;
+        pipelineLayoutInformation.pPushConstantRanges = &cullPushConstantRange;
+        if (vkCreatePipelineLayout(_device.getDevice(), &pipelineLayoutInformation, nullptr, &_cullPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create occlusion culling pipeline layout.");
+        }
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo setLayoutInformation{};
+        setLayoutInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInformation.bindingCount = static_cast<uint32_t>(bindings.size());
+        setLayoutInformation.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(_device.getDevice(), &setLayoutInformation, nullptr, &_pyramidSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid descriptor set layout.");
+        }
+
+        VkPushConstantRange pyramidPushConstantRange{};
+        pyramidPushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pyramidPushConstantRange.offset = 0;
+        pyramidPushConstantRange.size = sizeof(PyramidPushConstantData);
+
+        pipelineLayoutInformation.pSetLayouts = &_pyramidSetLayout;
+        pipelineLayoutInformation.pPushConstantRanges = &pyramidPushConstantRange;
+        if (vkCreatePipelineLayout(_device.getDevice(), &pipelineLayoutInformation, nullptr, &_pyramidPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid pipeline layout.");
+        }
+    }
+
+    // One host-visible object list per command buffer, like the application's frame data //
+    void OcclusionCuller::createFrameObjects(size_t frameCount) {
+        for (StorageBuffer &objectBuffer : _objectBuffers) {
+            destroyStorageBuffer(objectBuffer);
+        }
+        _objectBuffers.resize(frameCount);
+        for (StorageBuffer &objectBuffer : _objectBuffers) {
+            createStorageBuffer(static_cast<VkDeviceSize>(_maxObjects) * sizeof(OcclusionObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, objectBuffer);
+        }
+    }
+
+    // Call with the device idle whenever the swap-chain is created. The pyramid is the largest power of //
+    // two that fits in the swap-chain extent, so every level halves the previous one exactly; level 0 //
+    // reduces however much of the depth was rendered into it //
+    void OcclusionCuller::createPyramid(SwapChain &swapChain) {
+        destroyPyramid();
+
+        VkExtent2D extent{1, 1};
+        while (extent.width * 2 <= swapChain.getWidth()) {
+            extent.width *= 2;
+        }
+        while (extent.height * 2 <= swapChain.getHeight()) {
+            extent.height *= 2;
+        }
+        createPyramidImage(extent);
+        createPyramidDescriptorSets(swapChain);
+    }
+
+    void OcclusionCuller::createPyramidImage(VkExtent2D extent) {
+        _pyramidExtents.clear();
+        for (VkExtent2D level = extent; ; level = {std::max(1u, level.width / 2), std::max(1u, level.height / 2)}) {
+            _pyramidExtents.push_back(level);
+            if (level.width == 1 && level.height == 1) {
+                break;
+            }
+        }
+        uint32_t levelCount = static_cast<uint32_t>(_pyramidExtents.size());
+
+        VkImageCreateInfo imageInformation{};
+        imageInformation.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInformation.imageType = VK_IMAGE_TYPE_2D;
+        imageInformation.extent.width = extent.width;
+        imageInformation.extent.height = extent.height;
+        imageInformation.extent.depth = 1;
+        imageInformation.mipLevels = levelCount;
+        imageInformation.arrayLayers = 1;
+        imageInformation.format = VK_FORMAT_R32_SFLOAT;
+        imageInformation.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInformation.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInformation.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInformation.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInformation.flags = 0;
+
+        _device.createImageWithInfo(imageInformation, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _pyramid, _pyramidMemory);
+
+        VkImageViewCreateInfo viewInformation{};
+        viewInformation.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInformation.image = _pyramid;
+        viewInformation.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInformation.format = VK_FORMAT_R32_SFLOAT;
+        viewInformation.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1};
+        if (vkCreateImageView(_device.getDevice(), &viewInformation, nullptr, &_pyramidView) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid view.");
+        }
+
+        _pyramidMipViews.resize(levelCount);
+        for (uint32_t level = 0; level < levelCount; level++) {
+            viewInformation.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+            if (vkCreateImageView(_device.getDevice(), &viewInformation, nullptr, &_pyramidMipViews[level]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create depth pyramid level view.");
+            }
+        }
+
+        // The pyramid stays in the general layout: each level is written, then read by the next one and the cull //
+        VkCommandBuffer commandBuffer = _device.beginSingleTimeCommands();
+        VkImageMemoryBarrier toGeneral{};
+        toGeneral.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toGeneral.srcAccessMask = 0;
+        toGeneral.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        toGeneral.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toGeneral.image = _pyramid;
+        toGeneral.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+        _device.endSingleTimeCommands(commandBuffer);
+
+        _pyramidIndex = _bindlessTable.registerImage(_pyramidView, _sampler, VK_IMAGE_LAYOUT_GENERAL);
+    }
+
+    // Level 0 reads the depth of the swap-chain image being rendered, so there is one of its sets per image //
+    void OcclusionCuller::createPyramidDescriptorSets(SwapChain &swapChain) {
+        uint32_t depthSetCount = static_cast<uint32_t>(swapChain.getImageCount());
+        uint32_t mipSetCount = static_cast<uint32_t>(_pyramidMipViews.size()) - 1;
+        uint32_t setCount = depthSetCount + mipSetCount;
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[0].descriptorCount = setCount;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[1].descriptorCount = setCount;
+
+        VkDescriptorPoolCreateInfo poolInformation{};
+        poolInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInformation.maxSets = setCount;
+        poolInformation.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInformation.pPoolSizes = poolSizes.data();
+        if (vkCreateDescriptorPool(_device.getDevice(), &poolInformation, nullptr, &_pyramidDescriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create depth pyramid descriptor pool.");
+        }
+
+        std::vector<VkDescriptorSetLayout> setLayouts(setCount, _pyramidSetLayout);
+        std::vector<VkDescriptorSet> descriptorSets(setCount);
+        VkDescriptorSetAllocateInfo allocateInformation{};
+        allocateInformation.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInformation.descriptorPool = _pyramidDescriptorPool;
+        allocateInformation.descriptorSetCount = setCount;
+        allocateInformation.pSetLayouts = setLayouts.data();
+        if (vkAllocateDescriptorSets(_device.getDevice(), &allocateInformation, descriptorSets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate depth pyramid descriptor sets.");
+        }
+
+        _depthSets.assign(descriptorSets.begin(), descriptorSets.begin() + depthSetCount);
+        _mipSets.assign(descriptorSets.begin() + depthSetCount, descriptorSets.end());
+        for (uint32_t i = 0; i < depthSetCount; i++) {
+            writePyramidSet(_depthSets[i], swapChain.getDepthImageView(static_cast<int>(i)), VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, _pyramidMipViews[0]);
+        }
+        for (uint32_t level = 1; level <= mipSetCount; level++) {
+            writePyramidSet(_mipSets[level - 1], _pyramidMipViews[level - 1], VK_IMAGE_LAYOUT_GENERAL, _pyramidMipViews[level]);
+        }
+    }
+
+    void OcclusionCuller::writePyramidSet(VkDescriptorSet descriptorSet, VkImageView source, VkImageLayout sourceLayout, VkImageView destination) {
+        VkDescriptorImageInfo sourceInformation{};
+        sourceInformation.sampler = _sampler;
+        sourceInformation.imageView = source;
+        sourceInformation.imageLayout = sourceLayout;
+
+        VkDescriptorImageInfo destinationInformation{};
+        destinationInformation.imageView = destination;
+        destinationInformation.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = descriptorSet;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &sourceInformation;
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = descriptorSet;
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &destinationInformation;
+        vkUpdateDescriptorSets(_device.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void OcclusionCuller::destroyPyramid() {
+        if (_pyramidDescriptorPool != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(_device.getDevice(), _pyramidDescriptorPool, nullptr);
+            _pyramidDescriptorPool = VK_NULL_HANDLE;
+        }
+        _depthSets.clear();
+        _mipSets.clear();
+        if (_pyramidIndex != BindlessTable::INVALID_INDEX) {
+            _bindlessTable.releaseImage(_pyramidIndex);
+            _pyramidIndex = BindlessTable::INVALID_INDEX;
+        }
+        for (VkImageView mipView : _pyramidMipViews) {
+            vkDestroyImageView(_device.getDevice(), mipView, nullptr);
+        }
+        _pyramidMipViews.clear();
+        if (_pyramid != VK_NULL_HANDLE) {
+            vkDestroyImageView(_device.getDevice(), _pyramidView, nullptr);
+            vkDestroyImage(_device.getDevice(), _pyramid, nullptr);
+            _device.freeMemory(_pyramidMemory);
+            _pyramid = VK_NULL_HANDLE;
+        }
+    }
+
+    // Filled after the image is acquired, before the frame is submitted; at most getMaxObjects() entries //
+    OcclusionObject *OcclusionCuller::getObjects(size_t frameIndex) {
+        return static_cast<OcclusionObject *>(_objectBuffers[frameIndex].mapped);
+    }
+
+    void OcclusionCuller::computeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void OcclusionCuller::dispatchCull(VkCommandBuffer commandBuffer, size_t frameIndex, uint32_t objectCount, uint32_t phase) {
+        _cullPipeline->bind(commandBuffer);
+        _bindlessTable.bind(commandBuffer, _cullPipelineLayout, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+        CullPushConstantData push{};
+        push.objectBuffer = _objectBuffers[frameIndex].bindlessIndex;
+        push.visibilityBuffer = _visibilityBuffer.bindlessIndex;
+        push.commandBuffer = _commandBuffer.bindlessIndex;
+        push.pyramid = _pyramidIndex;
+        push.objectCount = objectCount;
+        push.phase = phase;
+        push.pyramidSize = {static_cast<float>(_pyramidExtents[0].width), static_cast<float>(_pyramidExtents[0].height)};
+        vkCmdPushConstants(commandBuffer, _cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstantData), &push);
+        vkCmdDispatch(commandBuffer, (objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+        computeBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    }
+
+    // Recorded before rendering begins. The barrier orders this frame's compute after everything the //
+    // previous frame still does with the draws, the visibility and the pyramid //
+    void OcclusionCuller::recordEarlyCull(VkCommandBuffer commandBuffer, size_t frameIndex, uint32_t objectCount) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        dispatchCull(commandBuffer, frameIndex, std::min(objectCount, _maxObjects), EARLY_PHASE);
+    }
+
+    // Recorded inside the rendering, with the object's pipeline and vertex buffer bound. The culled draws //
+    // are still issued, with no instances: one multi-draw per phase, or one draw per object without //
+    // multiDrawIndirect //
+    void OcclusionCuller::recordDraws(VkCommandBuffer commandBuffer, uint32_t phase, uint32_t objectCount) {
+        objectCount = std::min(objectCount, _maxObjects);
+        VkDeviceSize offset = static_cast<VkDeviceSize>(phase) * objectCount * sizeof(VkDrawIndirectCommand);
+        if (_device.isMultiDrawIndirectSupported()) {
+            uint32_t maxDrawCount = _device._properties.limits.maxDrawIndirectCount;
+            for (uint32_t first = 0; first < objectCount; first += maxDrawCount) {
+                uint32_t drawCount = std::min(objectCount - first, maxDrawCount);
+                vkCmdDrawIndirect(commandBuffer, _commandBuffer.buffer, offset + first * sizeof(VkDrawIndirectCommand), drawCount, sizeof(VkDrawIndirectCommand));
+            }
+            return;
+        }
+        for (uint32_t i = 0; i < objectCount; i++) {
+            vkCmdDrawIndirect(commandBuffer, _commandBuffer.buffer, offset + i * sizeof(VkDrawIndirectCommand), 1, sizeof(VkDrawIndirectCommand));
+        }
+    }
+
+    // Recorded between SwapChain::suspendRendering and resumeRendering: reduces the early phase's depth, //
+    // which covers `renderExtent`, into the pyramid, then culls against it //
+    void OcclusionCuller::recordLateCull(VkCommandBuffer commandBuffer, size_t frameIndex, VkExtent2D renderExtent, uint32_t objectCount) {
+        _pyramidPipeline->bind(commandBuffer);
+        VkExtent2D source = renderExtent;
+        for (size_t level = 0; level < _pyramidExtents.size(); level++) {
+            VkDescriptorSet descriptorSet = level == 0 ? _depthSets[frameIndex] : _mipSets[level - 1];
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pyramidPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+            VkExtent2D destination = _pyramidExtents[level];
+            PyramidPushConstantData push{};
+            push.sourceSize = {static_cast<int>(source.width), static_cast<int>(source.height)};
+            push.destinationSize = {static_cast<int>(destination.width), static_cast<int>(destination.height)};
+            vkCmdPushConstants(commandBuffer, _pyramidPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PyramidPushConstantData), &push);
+            vkCmdDispatch(commandBuffer, (destination.width + PYRAMID_WORKGROUP_SIZE - 1) / PYRAMID_WORKGROUP_SIZE, (destination.height + PYRAMID_WORKGROUP_SIZE - 1) / PYRAMID_WORKGROUP_SIZE, 1);
+            computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+            source = destination;
+        }
+
+        dispatchCull(commandBuffer, frameIndex, std::min(objectCount, _maxObjects), LATE_PHASE);
+    }
+
+    uint32_t OcclusionCuller::getMaxObjects() {
+        return _maxObjects;
+    }
+
+    OcclusionCuller::~OcclusionCuller() {
+        destroyPyramid();
+        for (StorageBuffer &objectBuffer : _objectBuffers) {
+            destroyStorageBuffer(objectBuffer);
+        }
+        destroyStorageBuffer(_visibilityBuffer);
+        destroyStorageBuffer(_commandBuffer);
+        vkDestroySampler(_device.getDevice(), _sampler, nullptr);
+        vkDestroyPipelineLayout(_device.getDevice(), _cullPipelineLayout, nullptr);
+        vkDestroyPipelineLayout(_device.getDevice(), _pyramidPipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(_device.getDevice(), _pyramidSetLayout, nullptr);
+    }
+
+}
@@ -0,0 +1,252 @@
+#include "pipeline/particle_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vulkan {
+
+    ParticleSystem::ParticleSystem(Device &device, BindlessTable &bindlessTable, uint32_t maxParticles) : _device{device}, _bindlessTable{bindlessTable}, _maxParticles{maxParticles} {
+        QueueFamilyIndices queueFamilies = _device.findPhysicalQueueFamilies();
+        _graphicsFamily = queueFamilies.graphicsFamily;
+        _computeFamily = _device.isAsyncComputeSupported() ? queueFamilies.computeFamily : queueFamilies.graphicsFamily;
+
+        VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        createStorageBuffer(STATE_SIZE, storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _stateBuffer);
+        createStorageBuffer(static_cast<VkDeviceSize>(_maxParticles) * PARTICLE_SIZE, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _particleBuffer);
+        createStorageBuffer(static_cast<VkDeviceSize>(_maxParticles) * sizeof(uint32_t), storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _deadBuffer);
+        createStorageBuffer(static_cast<VkDeviceSize>(_maxParticles) * sizeof(uint32_t) * 2, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _aliveBuffer);
+
+        createPipelineLayout();
+        createComputePipelines();
+        initializeLists();
+    }
+
+    void ParticleSystem::createStorageBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, StorageBuffer &storageBuffer) {
+        _device.createBuffer(size, usage, properties, storageBuffer.buffer, storageBuffer.memory);
+        if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+            vkMapMemory(_device.getDevice(), storageBuffer.memory, 0, size, 0, &storageBuffer.mapped);
+        }
+        storageBuffer.bindlessIndex = _bindlessTable.registerBuffer(storageBuffer.buffer);
+    }
+
+    void ParticleSystem::destroyStorageBuffer(StorageBuffer &storageBuffer) {
+        _bindlessTable.releaseBuffer(storageBuffer.bindlessIndex);
+        if (storageBuffer.mapped != nullptr) {
+            vkUnmapMemory(_device.getDevice(), storageBuffer.memory);
+        }
+        vkDestroyBuffer(_device.getDevice(), storageBuffer.buffer, nullptr);
+        _device.freeMemory(storageBuffer.memory);
+        storageBuffer = StorageBuffer{};
+    }
+
+    void ParticleSystem::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ParticlePushConstantData);
+
+        VkDescriptorSetLayout bindlessSetLayout = _bindlessTable.getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInformation{};
+        pipelineLayoutInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInformation.setLayoutCount = 1;
+        pipelineLayoutInformation.pSetLayouts = &bindlessSetLayout;
+        pipelineLayoutInformation.pushConstantRangeCount = 1;
+        pipelineLayoutInformation.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(_device.getDevice(), &pipelineLayoutInformation, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create particle pipeline layout.");
+        }
+    }
+
+    void ParticleSystem::createComputePipelines() {
+        _initPipeline = std::make_unique<ComputePipeline>(_device, "particle_init.comp", _pipelineLayout);
+        _emitPipeline = std::make_unique<ComputePipeline>(_device, "particle_emit.comp", _pipelineLayout);
+        _preparePipeline = std::make_unique<ComputePipeline>(_device, "particle_prepare.comp", _pipelineLayout);
+        _simulatePipeline = std::make_unique<ComputePipeline>(_device, "particle_simulate.comp", _pipelineLayout);
+        _finishPipeline = std::make_unique<ComputePipeline>(_device, "particle_finish.comp", _pipelineLayout);
+    }
+
+    void ParticleSystem::createPipelines(const SwapChainTargets &targets, ShaderVariantCache &shaderVariants) {
+        PipelineConfigurationInformation pipelineConfiguration{};
+        Pipeline::defaultPipelineConfigurationInformation(pipelineConfiguration);
+
+        // Particles are fetched by index in the vertex shader; there is no vertex input //
+        pipelineConfiguration.bindingDescriptions.clear();
+        pipelineConfiguration.attributeDescriptions.clear();
+        pipelineConfiguration.depthStencilInformation.depthTestEnable = VK_FALSE;
+        pipelineConfiguration.depthStencilInformation.depthWriteEnable = VK_FALSE;
+        pipelineConfiguration.colorBlendAttachment.blendEnable = VK_TRUE;
+        pipelineConfiguration.colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        pipelineConfiguration.colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        pipelineConfiguration.colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        pipelineConfiguration.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+
+        if (targets.dynamicRendering) {
+            pipelineConfiguration.colorAttachmentFormats = {targets.colorFormat};
+            pipelineConfiguration.depthAttachmentFormat = targets.depthFormat;
+        } else {
+            pipelineConfiguration.renderPass = targets.renderPass;
+        }
+        pipelineConfiguration.pipelineLayout = _pipelineLayout;
+        // Both variants are built now; the emitter picks one when the draw is recorded //
+        ShaderPermutation permutation{shaderVariants.getManifest().getProgram("particle")};
+        _renderPipelines[0] = &shaderVariants.getPipeline(permutation.set("SOFT_EDGE", false), pipelineConfiguration);
+        _renderPipelines[1] = &shaderVariants.getPipeline(permutation.set("SOFT_EDGE", true), pipelineConfiguration);
+    }
+
+    // Puts every particle on the dead list once, before the first frame //
+    void ParticleSystem::initializeLists() {
+        VkCommandBuffer commandBuffer = _device.beginSingleTimeCommands();
+        _initPipeline->bind(commandBuffer);
+        _bindlessTable.bind(commandBuffer, _pipelineLayout, VK_PIPELINE_BIND_POINT_COMPUTE);
+        pushConstants(commandBuffer, BindlessTable::INVALID_INDEX);
+        vkCmdDispatch(commandBuffer, (_maxParticles + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        // The first simulation acquires the lists on the compute family //
+        if (usesAsyncCompute()) {
+            transferOwnership(commandBuffer, _graphicsFamily, _computeFamily, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+        }
+        _device.endSingleTimeCommands(commandBuffer);
+    }
+
+    // One small host-visible parameter block per command buffer, like the application's frame data //
+    void ParticleSystem::createFrameParameters(size_t frameCount) {
+        for (StorageBuffer &parameterBuffer : _parameterBuffers) {
+            destroyStorageBuffer(parameterBuffer);
+        }
+        _parameterBuffers.resize(frameCount);
+        for (StorageBuffer &parameterBuffer : _parameterBuffers) {
+            createStorageBuffer(sizeof(ParticleParameters), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, parameterBuffer);
+        }
+    }
+
+    void ParticleSystem::setEmitter(const ParticleEmitter &emitter) {
+        _emitter = emitter;
+    }
+
+    // Call once the command buffer of `frameIndex` is idle //
+    void ParticleSystem::update(size_t frameIndex, float deltaTime) {
+        _emitAccumulator += _emitter.rate * deltaTime;
+        uint32_t emitCount = static_cast<uint32_t>(std::min(std::floor(_emitAccumulator), static_cast<float>(MAX_EMIT_PER_FRAME)));
+        _emitAccumulator = std::min(_emitAccumulator - static_cast<float>(emitCount), static_cast<float>(MAX_EMIT_PER_FRAME));
+
+        ParticleParameters *parameters = static_cast<ParticleParameters *>(_parameterBuffers[frameIndex].mapped);
+        parameters->emitterPosition = _emitter.position;
+        parameters->gravity = _emitter.gravity;
+        parameters->startColor = _emitter.startColor;
+        parameters->endColor = _emitter.endColor;
+        parameters->deltaTime = deltaTime;
+        parameters->emitCount = emitCount;
+        parameters->seed = ++_frameSeed * 0x9E3779B9u;
+        parameters->speed = _emitter.speed;
+        parameters->spread = _emitter.spread;
+        parameters->minLifetime = _emitter.minLifetime;
+        parameters->maxLifetime = _emitter.maxLifetime;
+        parameters->size = _emitter.size;
+    }
+
+    void ParticleSystem::pushConstants(VkCommandBuffer commandBuffer, uint32_t parameterBuffer) {
+        ParticlePushConstantData push{};
+        push.stateBuffer = _stateBuffer.bindlessIndex;
+        push.particleBuffer = _particleBuffer.bindlessIndex;
+        push.deadBuffer = _deadBuffer.bindlessIndex;
+        push.aliveBuffer = _aliveBuffer.bindlessIndex;
+        push.parameterBuffer = parameterBuffer;
+        push.maxParticles = _maxParticles;
+        vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ParticlePushConstantData), &push);
+    }
+
+    void ParticleSystem::computeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    // The buffers both queues touch; the dead list and parameters never leave the compute side //
+    void ParticleSystem::transferOwnership(VkCommandBuffer commandBuffer, uint32_t srcFamily, uint32_t dstFamily, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+        _device.transferBufferOwnership(commandBuffer, _stateBuffer.buffer, srcFamily, dstFamily, srcStage, srcAccess, dstStage, dstAccess);
+        _device.transferBufferOwnership(commandBuffer, _particleBuffer.buffer, srcFamily, dstFamily, srcStage, srcAccess, dstStage, dstAccess);
+        _device.transferBufferOwnership(commandBuffer, _aliveBuffer.buffer, srcFamily, dstFamily, srcStage, srcAccess, dstStage, dstAccess);
+    }
+
+    // Recorded before the frame's draws: outside the render pass of the same command buffer, or into a //
+    // compute queue command buffer that waits for the previous frame's graphics submission //
+    void ParticleSystem::recordSimulation(VkCommandBuffer commandBuffer, size_t frameIndex) {
+        VkAccessFlags readWrite = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        // Last frame's draw still reads the lists this frame rewrites //
+        if (usesAsyncCompute()) {
+            transferOwnership(commandBuffer, _graphicsFamily, _computeFamily, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+        } else {
+            vkCmdPipelineBarrier(commandBuffer, DRAW_STAGES, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+        }
+
+        _bindlessTable.bind(commandBuffer, _pipelineLayout, VK_PIPELINE_BIND_POINT_COMPUTE);
+        pushConstants(commandBuffer, _parameterBuffers[frameIndex].bindlessIndex);
+
+        _emitPipeline->bind(commandBuffer);
+        vkCmdDispatch(commandBuffer, MAX_EMIT_PER_FRAME / WORKGROUP_SIZE, 1, 1);
+        computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        _preparePipeline->bind(commandBuffer);
+        vkCmdDispatch(commandBuffer, 1, 1, 1);
+        computeBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | readWrite);
+
+        _simulatePipeline->bind(commandBuffer);
+        vkCmdDispatchIndirect(commandBuffer, _stateBuffer.buffer, DISPATCH_ARGUMENTS_OFFSET);
+        computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        _finishPipeline->bind(commandBuffer);
+        vkCmdDispatch(commandBuffer, 1, 1, 1);
+        if (usesAsyncCompute()) {
+            transferOwnership(commandBuffer, _computeFamily, _graphicsFamily, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+        } else {
+            computeBarrier(commandBuffer, DRAW_STAGES, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+
+    // Recorded outside the render pass, before the draw; the submission waits on the compute semaphore //
+    // at DRAW_STAGES. Nothing to do when the simulation shares the graphics queue //
+    void ParticleSystem::recordGraphicsAcquire(VkCommandBuffer commandBuffer) {
+        if (usesAsyncCompute()) {
+            transferOwnership(commandBuffer, _computeFamily, _graphicsFamily, DRAW_STAGES, 0, DRAW_STAGES, VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+
+    // Recorded inside the render pass //
+    void ParticleSystem::recordDraw(VkCommandBuffer commandBuffer, size_t frameIndex) {
+        _renderPipelines[_emitter.softEdge ? 1 : 0]->bind(commandBuffer);
+        _bindlessTable.bind(commandBuffer, _pipelineLayout);
+        pushConstants(commandBuffer, _parameterBuffers[frameIndex].bindlessIndex);
+        vkCmdDrawIndirect(commandBuffer, _stateBuffer.buffer, DRAW_ARGUMENTS_OFFSET, 1, sizeof(VkDrawIndirectCommand));
+    }
+
+    // Recorded after the render pass: hands the lists back for the next simulation //
+    void ParticleSystem::recordGraphicsRelease(VkCommandBuffer commandBuffer) {
+        if (usesAsyncCompute()) {
+            transferOwnership(commandBuffer, _graphicsFamily, _computeFamily, DRAW_STAGES, 0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+        }
+    }
+
+    bool ParticleSystem::usesAsyncCompute() {
+        return _computeFamily != _graphicsFamily;
+    }
+
+    uint32_t ParticleSystem::getMaxParticles() {
+        return _maxParticles;
+    }
+
+    ParticleSystem::~ParticleSystem() {
+        for (StorageBuffer &parameterBuffer : _parameterBuffers) {
+            destroyStorageBuffer(parameterBuffer);
+        }
+        destroyStorageBuffer(_stateBuffer);
+        destroyStorageBuffer(_particleBuffer);
+        destroyStorageBuffer(_deadBuffer);
+        destroyStorageBuffer(_aliveBuffer);
+        vkDestroyPipelineLayout(_device.getDevice(), _pipelineLayout, nullptr);
+    }
+
+}
@@ -1,22 +1,19 @@
 #include "pipeline/pipeline.hpp"
 #include "pipeline/model.hpp"
 
-#include <fstream>
+#include <array>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
 
 namespace vulkan {
 
-    Pipeline::Pipeline(Device &device, const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigurationInformation &configurationInformation) : _device{device} {
+    Pipeline::Pipeline(Device &device, const std::string &vertShader, const std::string &fragShader, const PipelineConfigurationInformation &configurationInformation) : _device{device} {
         assert(configurationInformation.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no pipelineLayout in configurationInformation.");
-        assert(configurationInformation.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no renderPass in configurationInformation.");
+        assert((configurationInformation.renderPass != VK_NULL_HANDLE || !configurationInformation.colorAttachmentFormats.empty()) && "Cannot create graphics pipeline:: no renderPass or attachment formats in configurationInformation.");
 
-        std::vector<char> vertCode = readFile(vertFilepath);
-        std::vector<char> fragCode = readFile(fragFilepath);
-
-        createShaderModule(vertCode, &_vertShaderModule);
-        createShaderModule(fragCode, &_fragShaderModule);
+        createShaderModule(ShaderRegistry::getShader(vertShader), &_vertShaderModule);
+        createShaderModule(ShaderRegistry::getShader(fragShader), &_fragShaderModule);
 
         VkPipelineShaderStageCreateInfo shaderStages[2];
         shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -25,17 +22,17 @@ namespace vulkan {
         shaderStages[0].pName = "main";
         shaderStages[0].flags = 0;
         shaderStages[0].pNext = nullptr;
-        shaderStages[0].pSpecializationInfo = nullptr;
+        shaderStages[0].pSpecializationInfo = configurationInformation.specializationInformation;
         shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
         shaderStages[1].module = _fragShaderModule;
         shaderStages[1].pName = "main";
         shaderStages[1].flags = 0;
         shaderStages[1].pNext = nullptr;
-        shaderStages[1].pSpecializationInfo = nullptr;
+        shaderStages[1].pSpecializationInfo = configurationInformation.specializationInformation;
 
-        std::vector<VkVertexInputBindingDescription> bindingDescriptions = Model::Vertex::getBindingDescriptions();
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions = Model::Vertex::getAttributeDescriptions();
+        const std::vector<VkVertexInputBindingDescription> &bindingDescriptions = configurationInformation.bindingDescriptions;
+        const std::vector<VkVertexInputAttributeDescription> &attributeDescriptions = configurationInformation.attributeDescriptions;
 
         VkPipelineVertexInputStateCreateInfo vertexInputInformation{};
         vertexInputInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -44,8 +41,16 @@ namespace vulkan {
         vertexInputInformation.pVertexAttributeDescriptions = attributeDescriptions.data();
         vertexInputInformation.pVertexBindingDescriptions = bindingDescriptions.data();
 
+        VkPipelineRenderingCreateInfoKHR renderingInformation{};
+        renderingInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        renderingInformation.colorAttachmentCount = static_cast<uint32_t>(configurationInformation.colorAttachmentFormats.size());
+        renderingInformation.pColorAttachmentFormats = configurationInformation.colorAttachmentFormats.data();
+        renderingInformation.depthAttachmentFormat = configurationInformation.depthAttachmentFormat;
+        renderingInformation.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
         VkGraphicsPipelineCreateInfo pipelineInformation{};
         pipelineInformation.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInformation.pNext = configurationInformation.renderPass == VK_NULL_HANDLE ? &renderingInformation : nullptr;
         pipelineInformation.stageCount = 2; // Count of how many programmable stages the pipeline will use. (shaders) //
         pipelineInformation.pStages = shaderStages;
         pipelineInformation.pVertexInputState = &vertexInputInformation;
@@ -67,34 +72,24 @@ namespace vulkan {
         }
     }
 
-    void Pipeline::createShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule) {
+    void Pipeline::createShaderModule(const ShaderCode &code, VkShaderModule *shaderModule) {
         VkShaderModuleCreateInfo createInformation{};
         createInformation.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInformation.codeSize = code.size();
-        createInformation.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        createInformation.codeSize = code.size;
+        createInformation.pCode = code.code;
 
         if (vkCreateShaderModule(_device.getDevice(), &createInformation, nullptr, shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create shader module.");
         }
     }
 
-    std::vector<char> Pipeline::readFile(const std::string &filePath) {
-        std::ifstream file{filePath, std::ios::ate | std::ios::binary};
-
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file: " + filePath);
-        }
-
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
-        return buffer;
-    }
-
     void Pipeline::defaultPipelineConfigurationInformation(PipelineConfigurationInformation &configurationInformation) {
 
+        std::array<VkVertexInputBindingDescription, 1> bindingDescriptions = Model::Vertex::getBindingDescriptions();
+        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = Model::Vertex::getAttributeDescriptions();
+        configurationInformation.bindingDescriptions.assign(bindingDescriptions.begin(), bindingDescriptions.end());
+        configurationInformation.attributeDescriptions.assign(attributeDescriptions.begin(), attributeDescriptions.end());
+
         configurationInformation.inputAssemblyInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
         configurationInformation.inputAssemblyInformation.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         configurationInformation.inputAssemblyInformation.primitiveRestartEnable = VK_FALSE;
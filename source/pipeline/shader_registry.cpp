@@ -0,0 +1,88 @@
+#include "pipeline/shader_registry.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace vulkan {
+
+    // Read into 32-bit words, the alignment vkCreateShaderModule expects //
+    std::vector<uint32_t> ShaderRegistry::readFile(const std::string &filePath) {
+        std::ifstream file{filePath, std::ios::ate | std::ios::binary};
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file: " + filePath);
+        }
+
+        size_t fileSize = static_cast<size_t>(file.tellg());
+        if (fileSize % sizeof(uint32_t) != 0) {
+            throw std::runtime_error("SPIR-V size is not a multiple of 4: " + filePath);
+        }
+        std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(buffer.data()), fileSize);
+        file.close();
+        return buffer;
+    }
+
+    const char *ShaderRegistry::getOverrideDirectory() {
+        const char *directory = std::getenv(OVERRIDE_VARIABLE);
+        return directory != nullptr && directory[0] != '\0' ? directory : nullptr;
+    }
+
+    // With the override the file is read again on every call, so rebuilt shaders are picked up. Each //
+    // lookup owns its words, so concurrent lookups of one name share nothing //
+    ShaderCode ShaderRegistry::getShader(const std::string &name) {
+        const char *directory = getOverrideDirectory();
+        if (directory != nullptr) {
+            std::shared_ptr<const std::vector<uint32_t>> code = std::make_shared<const std::vector<uint32_t>>(readFile(std::string(directory) + "/" + name + ".spv"));
+            return {code->data(), code->size() * sizeof(uint32_t), code};
+        }
+
+        for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; i++) {
+            if (std::strcmp(EMBEDDED_SHADERS[i].name, name.c_str()) == 0) {
+                return {EMBEDDED_SHADERS[i].code, EMBEDDED_SHADERS[i].wordCount * sizeof(uint32_t), nullptr};
+            }
+        }
+        throw std::runtime_error("Shader " + name + " is not embedded; rebuild, or set " + OVERRIDE_VARIABLE + ".");
+    }
+
+    std::string ShaderRegistry::getManifest() {
+        const char *directory = getOverrideDirectory();
+        if (directory == nullptr) {
+            return reinterpret_cast<const char *>(EMBEDDED_MANIFEST);
+        }
+
+        std::string filePath = std::string(directory) + "/" + MANIFEST_NAME;
+        std::ifstream file{filePath};
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open shader manifest: " + filePath);
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    // Runs the compiler the Makefile uses, writing "<source>.spv" beside the source as `make shaders` //
+    // does. The compiler reports errors on its own output //
+    void ShaderRegistry::compileShader(const std::string &sourcePath) {
+        std::string outputPath = sourcePath + ".spv";
+        std::vector<char *> arguments = {const_cast<char *>(COMPILER), const_cast<char *>(sourcePath.c_str()), const_cast<char *>("-o"), const_cast<char *>(outputPath.c_str()), nullptr};
+
+        pid_t process;
+        if (posix_spawnp(&process, COMPILER, nullptr, nullptr, arguments.data(), environ) != 0) {
+            throw std::runtime_error(std::string("Failed to run ") + COMPILER + ".");
+        }
+        int status = 0;
+        if (waitpid(process, &status, 0) != process || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw std::runtime_error("Failed to compile shader: " + sourcePath);
+        }
+    }
+
+}
@@ -0,0 +1,275 @@
+#include "pipeline/shader_variants.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <stdexcept>
+
+namespace vulkan {
+
+    ShaderPermutation::ShaderPermutation(const ShaderProgram &program) : _program{&program} {
+        _entries.reserve(program.features.size());
+        _values.reserve(program.features.size());
+        for (const ShaderFeature &feature : program.features) {
+            VkSpecializationMapEntry entry{};
+            entry.constantID = feature.constantId;
+            entry.offset = static_cast<uint32_t>(_values.size() * sizeof(uint32_t));
+            entry.size = sizeof(uint32_t);
+            _entries.push_back(entry);
+            _values.push_back(feature.defaultValue);
+        }
+    }
+
+    ShaderPermutation &ShaderPermutation::set(const std::string &feature, bool enabled) {
+        for (size_t i = 0; i < _program->features.size(); i++) {
+            if (_program->features[i].name == feature) {
+                _values[i] = enabled ? 1 : 0;
+                return *this;
+            }
+        }
+        throw std::runtime_error("Shader program " + _program->name + " has no feature " + feature + ".");
+    }
+
+    bool ShaderPermutation::isEnabled(const std::string &feature) const {
+        for (size_t i = 0; i < _program->features.size(); i++) {
+            if (_program->features[i].name == feature) {
+                return _values[i] != 0;
+            }
+        }
+        return false;
+    }
+
+    // FNV-1a over the program name and the feature values, in manifest order //
+    uint64_t ShaderPermutation::hash() const {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (char character : _program->name) {
+            hash = (hash ^ static_cast<uint8_t>(character)) * 0x100000001B3ull;
+        }
+        for (uint32_t value : _values) {
+            hash = (hash ^ value) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    // Points into the permutation: only valid while it is alive and unchanged //
+    VkSpecializationInfo ShaderPermutation::getSpecializationInformation() const {
+        VkSpecializationInfo specializationInformation{};
+        specializationInformation.mapEntryCount = static_cast<uint32_t>(_entries.size());
+        specializationInformation.pMapEntries = _entries.data();
+        specializationInformation.dataSize = _values.size() * sizeof(uint32_t);
+        specializationInformation.pData = _values.data();
+        return specializationInformation;
+    }
+
+    const ShaderProgram &ShaderPermutation::getProgram() const {
+        return *_program;
+    }
+
+    ShaderManifest::ShaderManifest(const std::string &text) {
+        const std::string filePath = ShaderRegistry::MANIFEST_NAME;
+        std::istringstream file{text};
+        ShaderProgram *current = nullptr;
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream stream{line};
+            std::string keyword;
+            if (!(stream >> keyword)) {
+                continue;
+            }
+
+            if (keyword == "program") {
+                ShaderProgram program;
+                if (!(stream >> program.name >> program.vertShader >> program.fragShader)) {
+                    throw std::runtime_error(filePath + ":" + std::to_string(lineNumber) + ": expected program <name> <vertex> <fragment>.");
+                }
+                current = &(_programs[program.name] = program);
+            } else if (keyword == "feature") {
+                ShaderFeature feature{};
+                if (current == nullptr || !(stream >> feature.name >> feature.constantId)) {
+                    throw std::runtime_error(filePath + ":" + std::to_string(lineNumber) + ": expected feature <NAME> <constant_id> after a program.");
+                }
+                stream >> feature.defaultValue;
+                if (current->features.size() == MAX_FEATURES) {
+                    throw std::runtime_error(filePath + ":" + std::to_string(lineNumber) + ": too many features for " + current->name + ".");
+                }
+                current->features.push_back(feature);
+            } else {
+                throw std::runtime_error(filePath + ":" + std::to_string(lineNumber) + ": unknown keyword " + keyword + ".");
+            }
+        }
+    }
+
+    const ShaderProgram &ShaderManifest::getProgram(const std::string &name) const {
+        std::unordered_map<std::string, ShaderProgram>::const_iterator program = _programs.find(name);
+        if (program == _programs.end()) {
+            throw std::runtime_error("Unknown shader program: " + name);
+        }
+        return program->second;
+    }
+
+    // Bit i of the variant index toggles feature i //
+    std::vector<ShaderPermutation> ShaderManifest::enumeratePermutations(const std::string &name) const {
+        const ShaderProgram &program = getProgram(name);
+        std::vector<ShaderPermutation> permutations;
+        uint32_t variantCount = 1u << program.features.size();
+        permutations.reserve(variantCount);
+        for (uint32_t variant = 0; variant < variantCount; variant++) {
+            ShaderPermutation permutation{program};
+            for (size_t feature = 0; feature < program.features.size(); feature++) {
+                permutation.set(program.features[feature].name, (variant >> feature) & 1u);
+            }
+            permutations.push_back(permutation);
+        }
+        return permutations;
+    }
+
+    ShaderVariantCache::ShaderVariantCache(Device &device, const ShaderManifest &manifest) : _device{device}, _manifest{manifest} {}
+
+    uint64_t ShaderVariantCache::makeKey(const ShaderPermutation &permutation, uint64_t stateKey) {
+        return permutation.hash() ^ (stateKey * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::unique_ptr<Pipeline> ShaderVariantCache::createPipeline(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation) {
+        VkSpecializationInfo specializationInformation = permutation.getSpecializationInformation();
+        PipelineConfigurationInformation variantConfiguration = configurationInformation;
+        variantConfiguration.specializationInformation = &specializationInformation;
+        // The state structures point into the configuration, which may be a stored copy //
+        variantConfiguration.colorBlendInformation.pAttachments = &variantConfiguration.colorBlendAttachment;
+        variantConfiguration.dynamicStateInformation.pDynamicStates = variantConfiguration.dynamicStateEnables.data();
+
+        const ShaderProgram &program = permutation.getProgram();
+        return std::make_unique<Pipeline>(_device, program.vertShader, program.fragShader, variantConfiguration);
+    }
+
+    PipelineHandle ShaderVariantCache::getVariant(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey) {
+        uint64_t key = makeKey(permutation, stateKey);
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            std::unordered_map<uint64_t, PipelineHandle>::iterator cached = _pipelines.find(key);
+            if (cached != _pipelines.end()) {
+                return cached->second;
+            }
+        }
+
+        std::unique_ptr<Pipeline> pipeline = createPipeline(permutation, configurationInformation);
+
+        // Another thread may have built the same variant meanwhile; the first one in is kept. The //
+        // configuration is kept to rebuild the variant when one of its shaders changes //
+        std::lock_guard<std::mutex> lock{_mutex};
+        std::unordered_map<uint64_t, PipelineHandle>::iterator stored = _pipelines.find(key);
+        if (stored == _pipelines.end()) {
+            Variant variant{std::move(pipeline), permutation, configurationInformation};
+            variant.configuration.specializationInformation = nullptr;
+            stored = _pipelines.emplace(key, _variants.create(std::move(variant))).first;
+        }
+        return stored->second;
+    }
+
+    // Null once the cache was cleared after the handle was handed out //
+    Pipeline *ShaderVariantCache::getPipeline(PipelineHandle handle) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        Variant *variant = _variants.get(handle);
+        return variant != nullptr ? variant->pipeline.get() : nullptr;
+    }
+
+    Pipeline &ShaderVariantCache::getPipeline(const ShaderPermutation &permutation, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey) {
+        return *getPipeline(getVariant(permutation, configurationInformation, stateKey));
+    }
+
+    // The vertex and fragment shaders of every variant built so far, each once //
+    std::vector<std::string> ShaderVariantCache::getShaderNames() {
+        std::vector<std::string> names;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            for (const Variant &variant : _variants) {
+                names.push_back(variant.permutation.getProgram().vertShader);
+                names.push_back(variant.permutation.getProgram().fragShader);
+            }
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        return names;
+    }
+
+    // Compiles again, off the render thread, every variant built from the shader ("sprite.frag"); returns //
+    // how many. A shader that fails to compile throws and leaves the current pipelines in place. Rebuilds //
+    // made against pipelines cleared meanwhile are dropped //
+    size_t ShaderVariantCache::rebuild(const std::string &shader) {
+        std::vector<std::pair<uint64_t, Variant>> stale;
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            generation = _generation;
+            for (const std::pair<const uint64_t, PipelineHandle> &cached : _pipelines) {
+                const Variant &variant = *_variants.get(cached.second);
+                const ShaderProgram &program = variant.permutation.getProgram();
+                if (program.vertShader == shader || program.fragShader == shader) {
+                    stale.push_back({cached.first, Variant{nullptr, variant.permutation, variant.configuration}});
+                }
+            }
+        }
+
+        for (std::pair<uint64_t, Variant> &variant : stale) {
+            variant.second.pipeline = createPipeline(variant.second.permutation, variant.second.configuration);
+        }
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (generation != _generation) {
+            return 0;
+        }
+        for (std::pair<uint64_t, Variant> &variant : stale) {
+            _rebuilt[variant.first] = std::move(variant.second.pipeline);
+        }
+        return stale.size();
+    }
+
+    // Call between frames. The replaced pipelines may still be in use by frames in flight, so they are //
+    // destroyed through the deletion queue. Returns whether anything was swapped //
+    bool ShaderVariantCache::swapRebuilt(DeletionQueue &deletionQueue) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_rebuilt.empty()) {
+            return false;
+        }
+        for (std::pair<const uint64_t, std::unique_ptr<Pipeline>> &rebuilt : _rebuilt) {
+            std::unordered_map<uint64_t, PipelineHandle>::iterator cached = _pipelines.find(rebuilt.first);
+            if (cached == _pipelines.end()) {
+                continue;
+            }
+            Variant &variant = *_variants.get(cached->second);
+            std::shared_ptr<Pipeline> retired = std::move(variant.pipeline);
+            deletionQueue.push([retired]() mutable { retired.reset(); });
+            variant.pipeline = std::move(rebuilt.second);
+        }
+        _rebuilt.clear();
+        return true;
+    }
+
+    // Builds every variant of the program up front, so selecting one later never compiles //
+    void ShaderVariantCache::warm(const std::string &program, const PipelineConfigurationInformation &configurationInformation, uint64_t stateKey) {
+        for (const ShaderPermutation &permutation : _manifest.enumeratePermutations(program)) {
+            getPipeline(permutation, configurationInformation, stateKey);
+        }
+    }
+
+    const ShaderManifest &ShaderVariantCache::getManifest() const {
+        return _manifest;
+    }
+
+    size_t ShaderVariantCache::getVariantCount() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _variants.size();
+    }
+
+    // The pipelines bake the attachment formats: call when they change, before rebuilding //
+    void ShaderVariantCache::clear() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _pipelines.clear();
+        _variants.clear();
+        _rebuilt.clear();
+        _generation++;
+    }
+
+}
@@ -0,0 +1,272 @@
+#include "pipeline/sprite_batcher.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace vulkan {
+
+    static uint32_t toUnorm(float value, float scale) {
+        return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * scale + 0.5f);
+    }
+
+    SpriteBatcher::SpriteBatcher(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, uint32_t maxSprites) : _device{device}, _jobSystem{jobSystem}, _bindlessTable{bindlessTable}, _maxSprites{maxSprites} {
+        createPipelineLayout();
+    }
+
+    // Sized once, on the first submit: submitting never reallocates, and the sort works in the frame arena //
+    void SpriteBatcher::allocateSprites() {
+        _instanceBuffer = std::make_unique<DynamicBuffer>(_device, sizeof(SpriteInstance) * _maxSprites, SwapChain::MAX_FRAMES_IN_FLIGHT);
+        _instanceBuffer->beginFrame(_frameIndex);
+        _sprites.reserve(_maxSprites);
+        _draws.reserve(BLEND_COUNT * 64);
+    }
+
+    void SpriteBatcher::createPipelineLayout() {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ViewPushConstantData);
+
+        VkDescriptorSetLayout bindlessSetLayout = _bindlessTable.getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInformation{};
+        pipelineLayoutInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInformation.setLayoutCount = 1;
+        pipelineLayoutInformation.pSetLayouts = &bindlessSetLayout;
+        pipelineLayoutInformation.pushConstantRangeCount = 1;
+        pipelineLayoutInformation.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(_device.getDevice(), &pipelineLayoutInformation, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create sprite pipeline layout.");
+        }
+    }
+
+    void SpriteBatcher::createPipelines(const SwapChainTargets &targets, ShaderVariantCache &shaderVariants) {
+        const ShaderProgram &program = shaderVariants.getManifest().getProgram("sprite");
+        for (size_t blend = 0; blend < BLEND_COUNT; blend++) {
+            PipelineConfigurationInformation pipelineConfiguration{};
+            Pipeline::defaultPipelineConfigurationInformation(pipelineConfiguration);
+
+            // Corners come from gl_VertexIndex; the only vertex stream is the per-instance data //
+            pipelineConfiguration.bindingDescriptions = {{0, sizeof(SpriteInstance), VK_VERTEX_INPUT_RATE_INSTANCE}};
+            pipelineConfiguration.attributeDescriptions = {
+                {0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteInstance, position)},
+                {1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteInstance, size)},
+                {2, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(SpriteInstance, uvRect)},
+                {3, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(SpriteInstance, color)},
+                {4, 0, VK_FORMAT_R32_SFLOAT, offsetof(SpriteInstance, rotation)},
+                {5, 0, VK_FORMAT_R32_UINT, offsetof(SpriteInstance, texture)}
+            };
+
+            pipelineConfiguration.depthStencilInformation.depthTestEnable = VK_FALSE;
+            pipelineConfiguration.depthStencilInformation.depthWriteEnable = VK_FALSE;
+
+            VkPipelineColorBlendAttachmentState &blendAttachment = pipelineConfiguration.colorBlendAttachment;
+            if (static_cast<SpriteBlend>(blend) != SpriteBlend::Opaque) {
+                blendAttachment.blendEnable = VK_TRUE;
+                blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+                blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                if (static_cast<SpriteBlend>(blend) == SpriteBlend::Alpha) {
+                    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                    blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+                } else {
+                    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+                    blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+                }
+            }
+
+            if (targets.dynamicRendering) {
+                pipelineConfiguration.colorAttachmentFormats = {targets.colorFormat};
+                pipelineConfiguration.depthAttachmentFormat = targets.depthFormat;
+            } else {
+                pipelineConfiguration.renderPass = targets.renderPass;
+            }
+            pipelineConfiguration.pipelineLayout = _pipelineLayout;
+            // Opaque sprites have no blending to hide transparent texels behind, so they alpha test //
+            ShaderPermutation permutation{program};
+            permutation.set("ALPHA_TEST", static_cast<SpriteBlend>(blend) == SpriteBlend::Opaque);
+            _pipelines[blend] = &shaderVariants.getPipeline(permutation, pipelineConfiguration, blend);
+        }
+    }
+
+    // Call once the fence of `frameIndex` has signalled; sprites are submitted fresh every frame //
+    void SpriteBatcher::beginFrame(uint32_t frameIndex) {
+        _frameIndex = frameIndex;
+        if (_instanceBuffer != nullptr) {
+            _instanceBuffer->beginFrame(frameIndex);
+        }
+        _sprites.clear();
+        _draws.clear();
+    }
+
+    bool SpriteBatcher::submit(const Sprite &sprite) {
+        return submit(&sprite, 1);
+    }
+
+    bool SpriteBatcher::submit(const Sprite *sprites, uint32_t count) {
+        if (_instanceBuffer == nullptr) {
+            if (count == 0) {
+                return true;
+            }
+            allocateSprites();
+        }
+        size_t available = _maxSprites - _sprites.size();
+        if (count > available) {
+            if (!_overflowReported) {
+                std::cerr << "Sprite batcher is full (" << _maxSprites << " sprites), dropping the rest of the frame." << std::endl;
+                _overflowReported = true;
+            }
+            _sprites.insert(_sprites.end(), sprites, sprites + available);
+            return false;
+        }
+        _sprites.insert(_sprites.end(), sprites, sprites + count);
+        return true;
+    }
+
+    // Maps sprite coordinates to clip space: clip = position * scale + translation //
+    void SpriteBatcher::setView(glm::vec2 scale, glm::vec2 translation) {
+        _view.scale = scale;
+        _view.translation = translation;
+    }
+
+    // Layer first so draw order between layers holds, then blend mode, then texture for sampling locality //
+    uint64_t SpriteBatcher::makeKey(const Sprite &sprite) {
+        return (static_cast<uint64_t>(sprite.layer) << 48) | (static_cast<uint64_t>(sprite.blend) << 40) | sprite.texture;
+    }
+
+    SpriteBatcher::SpriteInstance SpriteBatcher::packInstance(const Sprite &sprite) {
+        SpriteInstance instance;
+        instance.position = sprite.position;
+        instance.size = sprite.size;
+        for (int i = 0; i < 4; i++) {
+            instance.uvRect[i] = static_cast<uint16_t>(toUnorm(sprite.uvRect[i], 65535.0f));
+        }
+        instance.color = toUnorm(sprite.color.x, 255.0f) | (toUnorm(sprite.color.y, 255.0f) << 8) | (toUnorm(sprite.color.z, 255.0f) << 16) | (toUnorm(sprite.color.w, 255.0f) << 24);
+        instance.rotation = sprite.rotation;
+        instance.texture = sprite.texture;
+        return instance;
+    }
+
+    // Stable LSD radix sort over the 64-bit keys, one byte per pass. Passes whose byte is the same for every //
+    // sprite are skipped, which usually leaves two or three passes. //
+    void SpriteBatcher::sortSprites(FrameArenas &frameArenas, FrameVector<uint64_t> &keys, FrameVector<uint32_t> &order) {
+        uint32_t count = static_cast<uint32_t>(_sprites.size());
+        FrameVector<uint64_t> sortedKeys = frameArenas.makeVector<uint64_t>();
+        FrameVector<uint32_t> sortedOrder = frameArenas.makeVector<uint32_t>();
+        keys.resize(count);
+        sortedKeys.resize(count);
+        order.resize(count);
+        sortedOrder.resize(count);
+
+        _jobSystem.parallelFor(count, PARALLEL_BATCH_SIZE, [this, &keys, &order](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                keys[i] = makeKey(_sprites[i]);
+                order[i] = i;
+            }
+        });
+
+        std::array<std::array<uint32_t, 256>, 8> histograms{};
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t key = keys[i];
+            for (int digit = 0; digit < 8; digit++) {
+                histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+            }
+        }
+
+        for (int digit = 0; digit < 8; digit++) {
+            std::array<uint32_t, 256> &histogram = histograms[digit];
+            int shift = digit * 8;
+            if (histogram[(keys[0] >> shift) & 0xFF] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t &bucket : histogram) {
+                uint32_t size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t position = histogram[(keys[i] >> shift) & 0xFF]++;
+                sortedKeys[position] = keys[i];
+                sortedOrder[position] = order[i];
+            }
+            keys.swap(sortedKeys);
+            order.swap(sortedOrder);
+        }
+    }
+
+    void SpriteBatcher::writeInstances(const FrameVector<uint32_t> &order) {
+        uint32_t count = static_cast<uint32_t>(_sprites.size());
+        if (!_instanceBuffer->allocateVertices(sizeof(SpriteInstance) * count, _instances)) {
+            throw std::runtime_error("Failed to allocate sprite instance memory.");
+        }
+
+        SpriteInstance *instances = static_cast<SpriteInstance *>(_instances.data);
+        _jobSystem.parallelFor(count, PARALLEL_BATCH_SIZE, [this, instances, &order](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                instances[i] = packInstance(_sprites[order[i]]);
+            }
+        });
+        _instanceBuffer->flush();
+    }
+
+    // Textures are bindless, so only a change of blend mode (pipeline) starts a new draw //
+    void SpriteBatcher::buildDraws(const FrameVector<uint64_t> &keys) {
+        _draws.clear();
+        uint32_t count = static_cast<uint32_t>(_sprites.size());
+        for (uint32_t i = 0; i < count; i++) {
+            SpriteBlend blend = static_cast<SpriteBlend>((keys[i] >> 40) & 0xFF);
+            if (_draws.empty() || _draws.back().blend != blend) {
+                _draws.push_back({blend, i, 0});
+            }
+            _draws.back().instanceCount++;
+        }
+    }
+
+    // Call after the frame's sprites are submitted and before recording, once frameArenas has begun the frame //
+    void SpriteBatcher::prepare(FrameArenas &frameArenas) {
+        if (_sprites.empty()) {
+            _draws.clear();
+            return;
+        }
+        FrameVector<uint64_t> keys = frameArenas.makeVector<uint64_t>();
+        FrameVector<uint32_t> order = frameArenas.makeVector<uint32_t>();
+        sortSprites(frameArenas, keys, order);
+        writeInstances(order);
+        buildDraws(keys);
+    }
+
+    void SpriteBatcher::record(VkCommandBuffer commandBuffer) {
+        if (_draws.empty()) {
+            return;
+        }
+
+        VkDeviceSize offset = _instances.offset;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &_instances.buffer, &offset);
+        _bindlessTable.bind(commandBuffer, _pipelineLayout);
+        vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ViewPushConstantData), &_view);
+
+        for (const SpriteDraw &draw : _draws) {
+            _pipelines[static_cast<size_t>(draw.blend)]->bind(commandBuffer);
+            vkCmdDraw(commandBuffer, 6, draw.instanceCount, 0, draw.firstInstance);
+        }
+    }
+
+    bool SpriteBatcher::isEmpty() {
+        return _sprites.empty();
+    }
+
+    uint32_t SpriteBatcher::getSpriteCount() {
+        return static_cast<uint32_t>(_sprites.size());
+    }
+
+    uint32_t SpriteBatcher::getDrawCount() {
+        return static_cast<uint32_t>(_draws.size());
+    }
+
+    SpriteBatcher::~SpriteBatcher() {
+        vkDestroyPipelineLayout(_device.getDevice(), _pipelineLayout, nullptr);
+    }
+
+}
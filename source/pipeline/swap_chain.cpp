@@ -1,5 +1,6 @@
 #include "pipeline/swap_chain.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -10,25 +11,38 @@
 
 namespace vulkan {
 
-    SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent) : _device{deviceRef}, _windowExtent{extent} {
+    SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, DepthSharing depthSharing) : _device{deviceRef}, _depthSharing{depthSharing}, _windowExtent{extent} {
         init();
     }
 
-    SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous) : _device{deviceRef}, _windowExtent{extent}, _oldSwapChain{previous} {
+    SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous, DepthSharing depthSharing) : _device{deviceRef}, _depthSharing{depthSharing}, _windowExtent{extent}, _oldSwapChain{previous} {
         init();
         _oldSwapChain = nullptr;
     }
 
+    // With dynamic rendering there is no render pass or framebuffer to build, here or on resize //
     void SwapChain::init() {
+        _dynamicRendering = _device.isDynamicRenderingSupported();
         createSwapChain();
         createImageViews();
-        createRenderPass();
+        if (!_dynamicRendering) {
+            createRenderPass();
+        }
         createDepthResources();
-        createFramebuffers();
+        if (_dynamicResolution) {
+            createSceneResources();
+        }
+        if (!_dynamicRendering) {
+            createFramebuffers();
+        }
         createSyncObjects();
     }
 
+    // With per-frame depth there is one framebuffer per (frame in flight, swap-chain image) pair //
     VkFramebuffer SwapChain::getFrameBuffer(int index) {
+        if (_depthSharing == DepthSharing::PerFrameInFlight) {
+            return _swapChainFramebuffers[getDepthSlot() * getImageCount() + index];
+        }
         return _swapChainFramebuffers[index];
     }
 
@@ -48,6 +62,222 @@ namespace vulkan {
         return _swapChainImageFormat;
     }
 
+    size_t SwapChain::getCurrentFrame() {
+        return _currentFrame;
+    }
+
+    VkFormat SwapChain::getSwapChainDepthFormat() {
+        return _swapChainDepthFormat;
+    }
+
+    bool SwapChain::usesDynamicRendering() {
+        return _dynamicRendering;
+    }
+
+    bool SwapChain::usesDynamicResolution() {
+        return _dynamicResolution;
+    }
+
+    bool SwapChain::usesDepthSampling() {
+        return _depthSampled;
+    }
+
+    VkImageView SwapChain::getDepthImageView(int imageIndex) {
+        return _depthImageViews[getDepthIndex(imageIndex)];
+    }
+
+    // Only the render area changes: the scene target is allocated at the swap-chain extent once. Clamped //
+    // to that extent, and ignored when the scene is rendered straight into the swap-chain images //
+    void SwapChain::setRenderExtent(VkExtent2D extent) {
+        if (!_dynamicResolution) {
+            return;
+        }
+        _renderExtent.width = std::max(1u, std::min(extent.width, _swapChainExtent.width));
+        _renderExtent.height = std::max(1u, std::min(extent.height, _swapChainExtent.height));
+    }
+
+    // The area to set the viewport and scissor to //
+    VkExtent2D SwapChain::getRenderExtent() {
+        return _renderExtent;
+    }
+
+    // Pipelines built for one swap-chain stay valid for the next while these match //
+    bool SwapChain::compareSwapFormats(const SwapChain &swapChain) const {
+        return swapChain._swapChainImageFormat == _swapChainImageFormat && swapChain._swapChainDepthFormat == _swapChainDepthFormat && swapChain._dynamicRendering == _dynamicRendering;
+    }
+
+    SwapChainTargets SwapChain::getTargets() {
+        return {_dynamicRendering, _swapChainImageFormat, _swapChainDepthFormat, _renderPass};
+    }
+
+    // The targets a swap-chain created now would have, without its render pass //
+    SwapChainTargets SwapChain::queryTargets(Device &device) {
+        SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
+        return {device.isDynamicRenderingSupported(), chooseSwapSurfaceFormat(swapChainSupport.formats).format, findDepthFormat(device), VK_NULL_HANDLE};
+    }
+
+    void SwapChain::beginRendering(VkCommandBuffer commandBuffer, int imageIndex, const VkClearValue &colorClear, const VkClearValue &depthClear) {
+        VkImage depthImage = _depthImages[getDepthIndex(imageIndex)];
+        VkImage colorImage = _dynamicResolution ? _sceneImage : _swapChainImages[imageIndex];
+
+        // Same ordering the render pass dependency provides, including a depth image shared across frames //
+        std::array<VkImageMemoryBarrier, 2> barriers{};
+        barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[0].srcAccessMask = 0;
+        barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].image = colorImage;
+        barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].image = depthImage;
+        barriers[1].subresourceRange = {_depthAspects, 0, 1, 0, 1};
+        // The single scene target is also still read by the previous frame's blit, and sampled depth by its compute //
+        VkPipelineStageFlags srcStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | (_dynamicResolution ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0) | (_depthSampled ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0);
+        vkCmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        VkRenderingAttachmentInfoKHR colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        colorAttachment.imageView = _dynamicResolution ? _sceneImageView : _swapChainImageViews[imageIndex];
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.clearValue = colorClear;
+
+        VkRenderingAttachmentInfoKHR depthAttachment{};
+        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        depthAttachment.imageView = _depthImageViews[getDepthIndex(imageIndex)];
+        depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = _depthSampled ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.clearValue = depthClear;
+
+        VkRenderingInfoKHR renderingInformation{};
+        renderingInformation.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInformation.renderArea = {{0, 0}, _renderExtent};
+        renderingInformation.layerCount = 1;
+        renderingInformation.colorAttachmentCount = 1;
+        renderingInformation.pColorAttachments = &colorAttachment;
+        renderingInformation.pDepthAttachment = &depthAttachment;
+        _device.cmdBeginRendering(commandBuffer, renderingInformation);
+    }
+
+    // Ends the rendering with the depth readable from compute shaders; the color attachment is left as is //
+    void SwapChain::suspendRendering(VkCommandBuffer commandBuffer, int imageIndex) {
+        _device.cmdEndRendering(commandBuffer);
+
+        VkImageMemoryBarrier toRead{};
+        toRead.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toRead.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        toRead.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        toRead.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        toRead.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        toRead.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toRead.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toRead.image = _depthImages[getDepthIndex(imageIndex)];
+        toRead.subresourceRange = {_depthAspects, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toRead);
+    }
+
+    // Continues a suspended rendering, keeping what was drawn before it //
+    void SwapChain::resumeRendering(VkCommandBuffer commandBuffer, int imageIndex) {
+        VkImageMemoryBarrier toAttachment{};
+        toAttachment.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toAttachment.srcAccessMask = 0;
+        toAttachment.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        toAttachment.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        toAttachment.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        toAttachment.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toAttachment.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toAttachment.image = _depthImages[getDepthIndex(imageIndex)];
+        toAttachment.subresourceRange = {_depthAspects, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0, nullptr, 1, &toAttachment);
+
+        VkRenderingAttachmentInfoKHR colorAttachment{};
+        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        colorAttachment.imageView = _dynamicResolution ? _sceneImageView : _swapChainImageViews[imageIndex];
+        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+        VkRenderingAttachmentInfoKHR depthAttachment{};
+        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        depthAttachment.imageView = _depthImageViews[getDepthIndex(imageIndex)];
+        depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+        VkRenderingInfoKHR renderingInformation{};
+        renderingInformation.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInformation.renderArea = {{0, 0}, _renderExtent};
+        renderingInformation.layerCount = 1;
+        renderingInformation.colorAttachmentCount = 1;
+        renderingInformation.pColorAttachments = &colorAttachment;
+        renderingInformation.pDepthAttachment = &depthAttachment;
+        _device.cmdBeginRendering(commandBuffer, renderingInformation);
+    }
+
+    void SwapChain::endRendering(VkCommandBuffer commandBuffer, int imageIndex) {
+        _device.cmdEndRendering(commandBuffer);
+
+        if (_dynamicResolution) {
+            blitScene(commandBuffer, imageIndex);
+        }
+
+        VkImageMemoryBarrier toPresent{};
+        toPresent.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        toPresent.srcAccessMask = _dynamicResolution ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        toPresent.dstAccessMask = 0;
+        toPresent.oldLayout = _dynamicResolution ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        toPresent.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toPresent.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toPresent.image = _swapChainImages[imageIndex];
+        toPresent.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        VkPipelineStageFlags srcStage = _dynamicResolution ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &toPresent);
+    }
+
+    // Upscales the rendered area of the scene target over the whole swap-chain image, filtered //
+    void SwapChain::blitScene(VkCommandBuffer commandBuffer, int imageIndex) {
+        std::array<VkImageMemoryBarrier, 2> barriers{};
+        barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].image = _sceneImage;
+        barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        // The swap-chain image was acquired at the color attachment stage, which this barrier chains after //
+        barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[1].srcAccessMask = 0;
+        barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[1].image = _swapChainImages[imageIndex];
+        barriers[1].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+        VkImageBlit blit{};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        blit.srcOffsets[1] = {static_cast<int32_t>(_renderExtent.width), static_cast<int32_t>(_renderExtent.height), 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        blit.dstOffsets[1] = {static_cast<int32_t>(_swapChainExtent.width), static_cast<int32_t>(_swapChainExtent.height), 1};
+        vkCmdBlitImage(commandBuffer, _sceneImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+    }
+
     VkExtent2D SwapChain::getSwapChainExtent() {
         return _swapChainExtent;
     }
@@ -67,30 +297,33 @@ namespace vulkan {
     VkResult SwapChain::acquireNextImage(uint32_t *imageIndex) {
         vkWaitForFences(_device.getDevice(), 1, &_inFlightFences[_currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
         VkResult result = vkAcquireNextImageKHR(_device.getDevice(), _swapChain, std::numeric_limits<uint64_t>::max(), _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE, imageIndex);
+
+        // Wait here rather than at submit: callers reuse the image's command buffer and data before submitting //
+        if ((result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) && _imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
+            vkWaitForFences(_device.getDevice(), 1, &_imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+        }
         return result;
     }
 
+    // The optional semaphores order the frame against other queues, e.g. async compute //
     VkResult SwapChain::submitCommandBuffers(
-        const VkCommandBuffer *buffers, uint32_t *imageIndex) {
-        if (_imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-            vkWaitForFences(_device.getDevice(), 1, &_imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-        }
+        const VkCommandBuffer *buffers, uint32_t *imageIndex, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStage, VkSemaphore signalSemaphore) {
         _imagesInFlight[*imageIndex] = _inFlightFences[_currentFrame];
 
         VkSubmitInfo submitInformation = {};
         submitInformation.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInformation.waitSemaphoreCount = 1;
+        VkSemaphore waitSemaphores[] = {_imageAvailableSemaphores[_currentFrame], waitSemaphore};
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, waitStage};
+        submitInformation.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 2 : 1;
         submitInformation.pWaitSemaphores = waitSemaphores;
         submitInformation.pWaitDstStageMask = waitStages;
 
         submitInformation.commandBufferCount = 1;
         submitInformation.pCommandBuffers = buffers;
 
-        VkSemaphore signalSemaphores[] = {_renderFinishedSemaphores[_currentFrame]};
-        submitInformation.signalSemaphoreCount = 1;
+        VkSemaphore signalSemaphores[] = {_renderFinishedSemaphores[_currentFrame], signalSemaphore};
+        submitInformation.signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 2 : 1;
         submitInformation.pSignalSemaphores = signalSemaphores;
 
         vkResetFences(_device.getDevice(), 1, &_inFlightFences[_currentFrame]);
@@ -111,13 +344,34 @@ namespace vulkan {
 
         presentInformation.pImageIndices = imageIndex;
 
+        // Tagged so FramePacer can wait for this image to reach the screen //
+        uint64_t presentId = _presentId + 1;
+        VkPresentIdKHR presentIdInformation{};
+        presentIdInformation.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentIdInformation.swapchainCount = 1;
+        presentIdInformation.pPresentIds = &presentId;
+        if (_device.isPresentWaitSupported()) {
+            presentInformation.pNext = &presentIdInformation;
+        }
+
         VkResult result = vkQueuePresentKHR(_device.getPresentQueue(), &presentInformation);
+        _presentId = presentId;
 
         _currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
         return result;
     }
 
+    // Zero before the first present //
+    uint64_t SwapChain::getPresentId() {
+        return _presentId;
+    }
+
+    // Needs present wait support. VK_SUCCESS once the present is visible, VK_TIMEOUT before that //
+    VkResult SwapChain::waitForPresent(uint64_t presentId, uint64_t timeout) {
+        return _device.waitForPresent(_swapChain, presentId, timeout);
+    }
+
     void SwapChain::createSwapChain() {
         SwapChainSupportDetails swapChainSupport = _device.getSwapChainSupport();
 
@@ -139,7 +393,9 @@ namespace vulkan {
         createInformation.imageColorSpace = surfaceFormat.colorSpace;
         createInformation.imageExtent = extent;
         createInformation.imageArrayLayers = 1;
-        createInformation.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        // With dynamic resolution the images are only ever written by the upscaling blit //
+        _dynamicResolution = enableDynamicResolution && _dynamicRendering && checkDynamicResolutionSupport(swapChainSupport.capabilities, surfaceFormat.format);
+        createInformation.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (_dynamicResolution ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0);
 
         QueueFamilyIndices indices = _device.findPhysicalQueueFamilies();
         uint32_t queueFamilyIndices[] = {indices.graphicsFamily, indices.presentFamily};
@@ -170,6 +426,19 @@ namespace vulkan {
 
         _swapChainImageFormat = surfaceFormat.format;
         _swapChainExtent = extent;
+        _renderExtent = extent;
+    }
+
+    bool SwapChain::checkDynamicResolutionSupport(const VkSurfaceCapabilitiesKHR &capabilities, VkFormat format) {
+        if ((capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0) {
+            return false;
+        }
+        try {
+            _device.findSupportedFormat({format}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+        } catch (const std::runtime_error &) {
+            return false;
+        }
+        return true;
     }
 
     void SwapChain::createImageViews() {
@@ -227,13 +496,14 @@ namespace vulkan {
         subpass.pColorAttachments = &colorAttachmentReference;
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
+        // Also orders the previous frame's depth writes before this frame clears a shared depth image //
         VkSubpassDependency dependency = {};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.srcAccessMask = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
         dependency.dstSubpass = 0;
         dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
         std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
         VkRenderPassCreateInfo renderPassInformation = {};
@@ -251,51 +521,76 @@ namespace vulkan {
     }
 
     void SwapChain::createFramebuffers() {
-        _swapChainFramebuffers.resize(getImageCount());
-        for (size_t i = 0; i < getImageCount(); i++) {
-            std::array<VkImageView, 2> attachments = {_swapChainImageViews[i], _depthImageViews[i]};
-            VkExtent2D swapChainExtent = getSwapChainExtent();
-            VkFramebufferCreateInfo framebufferInformation = {};
-            framebufferInformation.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInformation.renderPass = _renderPass;
-            framebufferInformation.attachmentCount = static_cast<uint32_t>(attachments.size());
-            framebufferInformation.pAttachments = attachments.data();
-            framebufferInformation.width = swapChainExtent.width;
-            framebufferInformation.height = swapChainExtent.height;
-            framebufferInformation.layers = 1;
-
-            if (vkCreateFramebuffer(_device.getDevice(), &framebufferInformation, nullptr, &_swapChainFramebuffers[i]) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create framebuffer.");
+        size_t frameSlots = _depthSharing == DepthSharing::PerFrameInFlight ? _depthImageViews.size() : 1;
+        _swapChainFramebuffers.resize(frameSlots * getImageCount());
+        for (size_t slot = 0; slot < frameSlots; slot++) {
+            for (size_t i = 0; i < getImageCount(); i++) {
+                VkImageView depthView = _depthSharing == DepthSharing::PerSwapChainImage ? _depthImageViews[i] : _depthImageViews[slot];
+                std::array<VkImageView, 2> attachments = {_swapChainImageViews[i], depthView};
+                VkExtent2D swapChainExtent = getSwapChainExtent();
+                VkFramebufferCreateInfo framebufferInformation = {};
+                framebufferInformation.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+                framebufferInformation.renderPass = _renderPass;
+                framebufferInformation.attachmentCount = static_cast<uint32_t>(attachments.size());
+                framebufferInformation.pAttachments = attachments.data();
+                framebufferInformation.width = swapChainExtent.width;
+                framebufferInformation.height = swapChainExtent.height;
+                framebufferInformation.layers = 1;
+
+                if (vkCreateFramebuffer(_device.getDevice(), &framebufferInformation, nullptr, &_swapChainFramebuffers[slot * getImageCount() + i]) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create framebuffer.");
+                }
             }
         }
     }
 
     void SwapChain::createDepthResources() {
         VkFormat depthFormat = findDepthFormat();
+        _swapChainDepthFormat = depthFormat;
+        bool hasStencil = depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT;
+        _depthAspects = VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
         VkExtent2D swapChainExtent = getSwapChainExtent();
 
-        _depthImages.resize(getImageCount());
-        _depthImageMemories.resize(getImageCount());
-        _depthImageViews.resize(getImageCount());
+        // Only the occlusion culler samples depth, and its draws carry the draw index as their first instance //
+        _depthSampled = enableDepthSampling && _dynamicRendering && _device.isDrawIndirectFirstInstanceSupported();
+        if (_depthSampled) {
+            try {
+                _device.findSupportedFormat({depthFormat}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+            } catch (const std::runtime_error &) {
+                _depthSampled = false;
+            }
+        }
+
+        VkImageCreateInfo imageInformation{};
+        imageInformation.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInformation.imageType = VK_IMAGE_TYPE_2D;
+        imageInformation.extent.width = swapChainExtent.width;
+        imageInformation.extent.height = swapChainExtent.height;
+        imageInformation.extent.depth = 1;
+        imageInformation.mipLevels = 1;
+        imageInformation.arrayLayers = 1;
+        imageInformation.format = depthFormat;
+        imageInformation.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInformation.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInformation.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | (_depthSampled ? VK_IMAGE_USAGE_SAMPLED_BIT : 0);
+        imageInformation.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInformation.flags = 0;
+
+        // Depth is cleared on load and never stored, so tile-based GPUs can keep it entirely on chip, unless it is sampled //
+        _depthLazilyAllocated = !_depthSampled && supportsLazilyAllocated(imageInformation);
+        VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | (_depthLazilyAllocated ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0);
+        if (_depthLazilyAllocated) {
+            imageInformation.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+
+        size_t depthImageCount = getDepthImageCount(_depthSharing);
+        _depthImages.resize(depthImageCount);
+        _depthImageMemories.resize(depthImageCount);
+        _depthImageViews.resize(depthImageCount);
 
         for (size_t i = 0; i < _depthImages.size(); i++) {
-            VkImageCreateInfo imageInformation{};
-            imageInformation.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            imageInformation.imageType = VK_IMAGE_TYPE_2D;
-            imageInformation.extent.width = swapChainExtent.width;
-            imageInformation.extent.height = swapChainExtent.height;
-            imageInformation.extent.depth = 1;
-            imageInformation.mipLevels = 1;
-            imageInformation.arrayLayers = 1;
-            imageInformation.format = depthFormat;
-            imageInformation.tiling = VK_IMAGE_TILING_OPTIMAL;
-            imageInformation.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInformation.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-            imageInformation.samples = VK_SAMPLE_COUNT_1_BIT;
-            imageInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-            imageInformation.flags = 0;
-
-            _device.createImageWithInfo(imageInformation, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _depthImages[i], _depthImageMemories[i]);
+            _device.createImageWithInfo(imageInformation, memoryProperties, _depthImages[i], _depthImageMemories[i]);
 
             VkImageViewCreateInfo viewInformation{};
             viewInformation.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -312,6 +607,78 @@ namespace vulkan {
                 throw std::runtime_error("Failed to create texture image view.");
             }
         }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(_device.getDevice(), _depthImages[0], &memoryRequirements);
+        reportDepthMemory(memoryRequirements.size);
+    }
+
+    // A lazily allocated type existing is not enough: the transient depth image has to accept one //
+    bool SwapChain::supportsLazilyAllocated(const VkImageCreateInfo &imageInfo) {
+        VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        if (!_device.hasMemoryProperties(UINT32_MAX, properties)) {
+            return false;
+        }
+        VkImageCreateInfo transientInfo = imageInfo;
+        transientInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        VkImage image;
+        if (vkCreateImage(_device.getDevice(), &transientInfo, nullptr, &image) != VK_SUCCESS) {
+            return false;
+        }
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(_device.getDevice(), image, &memoryRequirements);
+        vkDestroyImage(_device.getDevice(), image, nullptr);
+        return _device.hasMemoryProperties(memoryRequirements.memoryTypeBits, properties);
+    }
+
+    size_t SwapChain::getDepthImageCount(DepthSharing depthSharing) {
+        switch (depthSharing) {
+            case DepthSharing::PerSwapChainImage:
+                return getImageCount();
+            case DepthSharing::PerFrameInFlight:
+                return std::min(getImageCount(), static_cast<size_t>(MAX_FRAMES_IN_FLIGHT));
+            default:
+                return 1;
+        }
+    }
+
+    size_t SwapChain::getDepthIndex(int imageIndex) {
+        switch (_depthSharing) {
+            case DepthSharing::PerSwapChainImage:
+                return static_cast<size_t>(imageIndex);
+            case DepthSharing::PerFrameInFlight:
+                return getDepthSlot();
+            default:
+                return 0;
+        }
+    }
+
+    // Which of the per-frame depth images the frame being recorded renders into, 0 in the other modes. //
+    // Command buffers recorded for one slot must not be replayed in another: two frames in flight would //
+    // then share a depth image //
+    size_t SwapChain::getDepthSlot() {
+        return _depthSharing == DepthSharing::PerFrameInFlight ? _currentFrame % _depthImages.size() : 0;
+    }
+
+    void SwapChain::reportDepthMemory(VkDeviceSize imageSize) {
+        constexpr double MEGABYTE = 1024.0 * 1024.0;
+        VkDeviceSize perImage = imageSize * getDepthImageCount(DepthSharing::PerSwapChainImage);
+        VkDeviceSize perFrame = imageSize * getDepthImageCount(DepthSharing::PerFrameInFlight);
+        VkDeviceSize single = imageSize * getDepthImageCount(DepthSharing::Single);
+        VkDeviceSize used = imageSize * _depthImages.size();
+
+        std::cout << "Depth buffers: per swap-chain image " << perImage / MEGABYTE << " MB, per frame in flight " << perFrame / MEGABYTE << " MB (saves " << (perImage - perFrame) / MEGABYTE << " MB), single " << single / MEGABYTE << " MB (saves " << (perImage - single) / MEGABYTE << " MB)" << std::endl;
+        std::cout << "Depth buffers: using " << _depthImages.size() << " image(s), " << used / MEGABYTE << " MB, saving " << (perImage - used) / MEGABYTE << " MB" << std::endl;
+
+        if (_depthLazilyAllocated) {
+            VkDeviceSize committed = 0;
+            for (VkDeviceMemory memory : _depthImageMemories) {
+                VkDeviceSize bytes = 0;
+                vkGetDeviceMemoryCommitment(_device.getDevice(), memory, &bytes);
+                committed += bytes;
+            }
+            std::cout << "Depth buffers: lazily allocated, " << committed / MEGABYTE << " MB actually committed" << std::endl;
+        }
     }
 
     void SwapChain::createSyncObjects() {
@@ -345,6 +712,12 @@ namespace vulkan {
     }
 
     VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) {
+        // One image per refresh, always available: the pacing keeps the queue of frames short //
+        if (enableFramePacing) {
+            std::cout << "Buffer swap mode: V-Sync, paced" << std::endl;
+            return VK_PRESENT_MODE_FIFO_KHR;
+        }
+
         // High power consumption but low latency //
         for (const VkPresentModeKHR &availablePresentMode : availablePresentModes) {
             if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
@@ -378,7 +751,48 @@ namespace vulkan {
     }
 
     VkFormat SwapChain::findDepthFormat() {
-        return _device.findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        return findDepthFormat(_device);
+    }
+
+    VkFormat SwapChain::findDepthFormat(Device &device) {
+        return device.findSupportedFormat({VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    }
+
+    // Sized for the full swap-chain extent, so scaling the render area never reallocates. Pipelines drawing //
+    // into it are the same as for the swap-chain images: it has their format. //
+    void SwapChain::createSceneResources() {
+        VkImageCreateInfo imageInformation{};
+        imageInformation.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInformation.imageType = VK_IMAGE_TYPE_2D;
+        imageInformation.extent.width = _swapChainExtent.width;
+        imageInformation.extent.height = _swapChainExtent.height;
+        imageInformation.extent.depth = 1;
+        imageInformation.mipLevels = 1;
+        imageInformation.arrayLayers = 1;
+        imageInformation.format = _swapChainImageFormat;
+        imageInformation.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInformation.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInformation.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInformation.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInformation.flags = 0;
+
+        _device.createImageWithInfo(imageInformation, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _sceneImage, _sceneImageMemory);
+
+        VkImageViewCreateInfo viewInformation{};
+        viewInformation.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInformation.image = _sceneImage;
+        viewInformation.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInformation.format = _swapChainImageFormat;
+        viewInformation.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInformation.subresourceRange.baseMipLevel = 0;
+        viewInformation.subresourceRange.levelCount = 1;
+        viewInformation.subresourceRange.baseArrayLayer = 0;
+        viewInformation.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(_device.getDevice(), &viewInformation, nullptr, &_sceneImageView) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create scene image view.");
+        }
     }
 
     SwapChain::~SwapChain() {
@@ -396,7 +810,13 @@ namespace vulkan {
         for (size_t i = 0; i < _depthImages.size(); i++) {
             vkDestroyImageView(_device.getDevice(), _depthImageViews[i], nullptr);
             vkDestroyImage(_device.getDevice(), _depthImages[i], nullptr);
-            vkFreeMemory(_device.getDevice(), _depthImageMemories[i], nullptr);
+            _device.freeMemory(_depthImageMemories[i]);
+        }
+
+        if (_sceneImage != VK_NULL_HANDLE) {
+            vkDestroyImageView(_device.getDevice(), _sceneImageView, nullptr);
+            vkDestroyImage(_device.getDevice(), _sceneImage, nullptr);
+            _device.freeMemory(_sceneImageMemory);
         }
 
         for (VkFramebuffer framebuffer : _swapChainFramebuffers) {
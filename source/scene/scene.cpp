@@ -0,0 +1,211 @@
+#include "scene/scene.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace vulkan {
+
+    namespace {
+
+        constexpr size_t SECTION_ALIGNMENT = 8;
+
+        constexpr size_t RECORD_SIZES[SCENE_SECTION_COUNT] = {
+            sizeof(Model::Vertex), sizeof(ModelLod), sizeof(ModelMesh), sizeof(SceneMaterial), sizeof(SceneTransform), sizeof(SceneEntity), sizeof(char)
+        };
+
+        static_assert(sizeof(SceneHeader) == 24 + 16 * SCENE_SECTION_COUNT, "Scene header must match the file layout");
+        static_assert(sizeof(Model::Vertex) == 20, "Scene vertices must match the file layout");
+        static_assert(sizeof(ModelLod) == 12 && sizeof(ModelMesh) == 8, "Scene meshes must match the file layout");
+        static_assert(sizeof(SceneMaterial) == 16 && sizeof(SceneTransform) == 16 && sizeof(SceneEntity) == 16, "Scene records must match the file layout");
+
+        size_t alignSection(size_t offset) {
+            return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        }
+
+    }
+
+    Scene::Scene(const std::string &filePath) : _file{std::make_unique<MappedFile>(filePath)}, _name{filePath} {
+        _data = _file->getData();
+        _size = _file->getSize();
+        validate();
+    }
+
+    // Adopts a serialized scene, for one that was just built and could not be read back from a file //
+    Scene::Scene(std::vector<uint8_t> bytes) : _bytes{std::move(bytes)}, _name{"serialized scene"} {
+        _data = _bytes.data();
+        _size = _bytes.size();
+        validate();
+    }
+
+    // Runs once, so nothing read later can point outside the file or at a record that does not exist //
+    void Scene::validate() {
+        if (_size < sizeof(SceneHeader)) {
+            throw std::runtime_error("Not a scene file: " + _name);
+        }
+        const SceneHeader *header = reinterpret_cast<const SceneHeader *>(_data);
+        if (header->magic != MAGIC) {
+            throw std::runtime_error("Not a scene file: " + _name);
+        }
+        if (header->version != VERSION) {
+            throw std::runtime_error("Unsupported scene version " + std::to_string(header->version) + ": " + _name);
+        }
+        if (header->fileSize != _size) {
+            throw std::runtime_error("Truncated scene file: " + _name);
+        }
+
+        for (uint32_t type = 0; type < SCENE_SECTION_COUNT; type++) {
+            const SceneSection &section = header->sections[type];
+            if (section.count == 0) {
+                continue;
+            }
+            if (section.offset < sizeof(SceneHeader) || section.offset % SECTION_ALIGNMENT != 0 || section.offset > _size) {
+                throw std::runtime_error("Scene section " + std::to_string(type) + " is misplaced: " + _name);
+            }
+            if (section.count > (_size - section.offset) / RECORD_SIZES[type] || section.count >= INVALID_INDEX) {
+                throw std::runtime_error("Scene section " + std::to_string(type) + " overruns the file: " + _name);
+            }
+        }
+
+        if (hashContent(_data + sizeof(SceneHeader), _size - sizeof(SceneHeader)) != header->contentHash) {
+            throw std::runtime_error("Scene content hash mismatch: " + _name);
+        }
+
+        SceneArray<Model::Vertex> vertices = getVertices();
+        for (const ModelLod &lod : getLods()) {
+            if (lod.vertexCount < 3 || lod.vertexCount % 3 != 0 || lod.firstVertex > vertices.count || vertices.count - lod.firstVertex < lod.vertexCount) {
+                throw std::runtime_error("Scene level of detail has an invalid vertex range: " + _name);
+            }
+        }
+        SceneArray<ModelLod> lods = getLods();
+        for (const ModelMesh &mesh : getMeshes()) {
+            if (mesh.lodCount == 0 || mesh.firstLod > lods.count || lods.count - mesh.firstLod < mesh.lodCount) {
+                throw std::runtime_error("Scene mesh has an invalid level of detail range: " + _name);
+            }
+        }
+        SceneArray<char> strings = getSection<char>(SCENE_STRINGS);
+        if (strings.count > 0 && strings[strings.count - 1] != '\0') {
+            throw std::runtime_error("Scene strings are not terminated: " + _name);
+        }
+        for (const SceneMaterial &material : getMaterials()) {
+            if (material.textureName != INVALID_INDEX && material.textureName >= strings.count) {
+                throw std::runtime_error("Scene material has an invalid texture name: " + _name);
+            }
+        }
+        SceneArray<SceneEntity> entities = getEntities();
+        for (uint32_t i = 0; i < entities.count; i++) {
+            const SceneEntity &entity = entities[i];
+            // Parents come first, so transforms resolve in a single pass over the entities //
+            if ((entity.parent != INVALID_INDEX && entity.parent >= i) || entity.transform >= getTransforms().count || entity.mesh >= getMeshes().count || entity.material >= getMaterials().count) {
+                throw std::runtime_error("Scene entity " + std::to_string(i) + " has an invalid reference: " + _name);
+            }
+        }
+    }
+
+    template <typename T>
+    SceneArray<T> Scene::getSection(SceneSectionType type) const {
+        const SceneSection &section = reinterpret_cast<const SceneHeader *>(_data)->sections[type];
+        SceneArray<T> array;
+        array.data = reinterpret_cast<const T *>(_data + section.offset);
+        array.count = static_cast<uint32_t>(section.count);
+        return array;
+    }
+
+    SceneArray<Model::Vertex> Scene::getVertices() const {
+        return getSection<Model::Vertex>(SCENE_VERTICES);
+    }
+
+    SceneArray<ModelLod> Scene::getLods() const {
+        return getSection<ModelLod>(SCENE_LODS);
+    }
+
+    SceneArray<ModelMesh> Scene::getMeshes() const {
+        return getSection<ModelMesh>(SCENE_MESHES);
+    }
+
+    SceneArray<SceneMaterial> Scene::getMaterials() const {
+        return getSection<SceneMaterial>(SCENE_MATERIALS);
+    }
+
+    SceneArray<SceneTransform> Scene::getTransforms() const {
+        return getSection<SceneTransform>(SCENE_TRANSFORMS);
+    }
+
+    SceneArray<SceneEntity> Scene::getEntities() const {
+        return getSection<SceneEntity>(SCENE_ENTITIES);
+    }
+
+    const char *Scene::getString(uint32_t offset) const {
+        return getSection<char>(SCENE_STRINGS).data + offset;
+    }
+
+    const char *Scene::getPath() {
+        const char *path = std::getenv(OVERRIDE_VARIABLE);
+        return path != nullptr && path[0] != '\0' ? path : DEFAULT_PATH;
+    }
+
+    // FNV-1a over 64-bit words rather than bytes, so hashing keeps up with the copy to the GPU //
+    uint64_t Scene::hashContent(const uint8_t *data, size_t size) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, data + offset, sizeof(word));
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        for (; offset < size; offset++) {
+            hash = (hash ^ data[offset]) * 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    std::vector<uint8_t> Scene::serialize(const SceneData &data) {
+        const void *records[SCENE_SECTION_COUNT] = {
+            data.vertices.data(), data.lods.data(), data.meshes.data(), data.materials.data(), data.transforms.data(), data.entities.data(), data.strings.c_str()
+        };
+        // The string section keeps the terminator of the last string //
+        size_t counts[SCENE_SECTION_COUNT] = {
+            data.vertices.size(), data.lods.size(), data.meshes.size(), data.materials.size(), data.transforms.size(), data.entities.size(),
+            data.strings.empty() ? 0 : data.strings.size() + 1
+        };
+
+        SceneHeader header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        size_t size = sizeof(SceneHeader);
+        for (uint32_t type = 0; type < SCENE_SECTION_COUNT; type++) {
+            size = alignSection(size);
+            header.sections[type] = {static_cast<uint64_t>(size), static_cast<uint64_t>(counts[type])};
+            size += counts[type] * RECORD_SIZES[type];
+        }
+        header.fileSize = size;
+
+        std::vector<uint8_t> bytes(size, 0);
+        for (uint32_t type = 0; type < SCENE_SECTION_COUNT; type++) {
+            if (counts[type] > 0) {
+                std::memcpy(bytes.data() + header.sections[type].offset, records[type], counts[type] * RECORD_SIZES[type]);
+            }
+        }
+        header.contentHash = hashContent(bytes.data() + sizeof(SceneHeader), size - sizeof(SceneHeader));
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        return bytes;
+    }
+
+    // Written beside the target and renamed over it, so a reader never maps a half-written file //
+    void Scene::write(const std::string &filePath, const std::vector<uint8_t> &bytes) {
+        std::string temporaryPath = filePath + ".tmp";
+        std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file: " + temporaryPath);
+        }
+        file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        file.close();
+        if (!file || std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("Failed to write scene file: " + filePath);
+        }
+    }
+
+}
@@ -0,0 +1,222 @@
+#include "scene/transform_hierarchy.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRANSFORM_HIERARCHY_AVX2
+#endif
+
+namespace vulkan {
+
+    TransformHierarchy::TransformHierarchy(JobSystem &jobSystem) : _jobSystem{jobSystem} {
+#ifdef TRANSFORM_HIERARCHY_AVX2
+        _avx2Supported = __builtin_cpu_supports("avx2");
+#else
+        _avx2Supported = false;
+#endif
+    }
+
+    // The first entityCount entities, which the scene orders parents first. Every node starts dirty //
+    void TransformHierarchy::build(SceneArray<SceneEntity> entities, SceneArray<SceneTransform> transforms, uint32_t entityCount) {
+        // The children of each entity, in file order //
+        std::vector<uint32_t> childOffsets(entityCount + 1, 0);
+        for (uint32_t i = 0; i < entityCount; i++) {
+            if (entities[i].parent != Scene::INVALID_INDEX) {
+                childOffsets[entities[i].parent + 1]++;
+            }
+        }
+        for (uint32_t i = 0; i < entityCount; i++) {
+            childOffsets[i + 1] += childOffsets[i];
+        }
+        std::vector<uint32_t> children(entityCount);
+        std::vector<uint32_t> next(childOffsets.begin(), childOffsets.end() - 1);
+        for (uint32_t i = 0; i < entityCount; i++) {
+            if (entities[i].parent != Scene::INVALID_INDEX) {
+                children[next[entities[i].parent]++] = i;
+            }
+        }
+
+        // Breadth first from the roots: levels come out in order, and the children of each node together, //
+        // siblings as in the file //
+        _nodes.resize(entityCount);
+        _entities.clear();
+        _entities.reserve(entityCount);
+        _childStarts.resize(entityCount + 1);
+        for (uint32_t i = 0; i < entityCount; i++) {
+            if (entities[i].parent == Scene::INVALID_INDEX) {
+                _entities.push_back(i);
+            }
+        }
+        for (uint32_t node = 0; node < entityCount; node++) {
+            uint32_t entity = _entities[node];
+            _nodes[entity] = node;
+            _childStarts[node] = static_cast<uint32_t>(_entities.size());
+            _entities.insert(_entities.end(), children.begin() + childOffsets[entity], children.begin() + childOffsets[entity + 1]);
+        }
+        _childStarts[entityCount] = entityCount;
+
+        // The level after a level starts with the children of its first node //
+        _levelStarts.assign(1, 0);
+        while (_levelStarts.back() < entityCount) {
+            _levelStarts.push_back(_childStarts[_levelStarts.back()]);
+        }
+        _dirtyBegins.assign(_levelStarts.begin(), _levelStarts.end() - 1);
+        _dirtyEnds.assign(_levelStarts.begin() + 1, _levelStarts.end());
+
+        _parents.resize(entityCount);
+        _localX.resize(entityCount);
+        _localY.resize(entityCount);
+        _localScale.resize(entityCount);
+        _localDepth.resize(entityCount);
+        _worldX.assign(entityCount, 0.0f);
+        _worldY.assign(entityCount, 0.0f);
+        _worldScale.assign(entityCount, 1.0f);
+        _worldDepth.assign(entityCount, 0.0f);
+        _dirty.assign(entityCount, UINT32_MAX);
+        for (uint32_t node = 0; node < entityCount; node++) {
+            const SceneEntity &entity = entities[_entities[node]];
+            const SceneTransform &local = transforms[entity.transform];
+            // Roots point at themselves, so the kernels can gather without checking //
+            _parents[node] = entity.parent == Scene::INVALID_INDEX ? node : _nodes[entity.parent];
+            _localX[node] = local.position.x;
+            _localY[node] = local.position.y;
+            _localScale[node] = local.scale;
+            _localDepth[node] = local.depth;
+        }
+        _changed = true;
+    }
+
+    // Marks the entity's subtree for the next update, unless the transform is unchanged //
+    void TransformHierarchy::setLocal(uint32_t entity, const SceneTransform &transform) {
+        uint32_t node = _nodes[entity];
+        if (_localX[node] == transform.position.x && _localY[node] == transform.position.y && _localScale[node] == transform.scale && _localDepth[node] == transform.depth) {
+            return;
+        }
+        _localX[node] = transform.position.x;
+        _localY[node] = transform.position.y;
+        _localScale[node] = transform.scale;
+        _localDepth[node] = transform.depth;
+        _dirty[node] = UINT32_MAX;
+
+        size_t level = static_cast<size_t>(std::upper_bound(_levelStarts.begin(), _levelStarts.end(), node) - _levelStarts.begin()) - 1;
+        _dirtyBegins[level] = std::min(_dirtyBegins[level], node);
+        _dirtyEnds[level] = std::max(_dirtyEnds[level], node + 1);
+        _changed = true;
+    }
+
+    // Each level waits for the one before it: its parents are there. The dirty flags of a level are //
+    // cleared once the level after it has read them. Allocates nothing: the batches come from the job //
+    // system's pools and the batch functions fit in std::function //
+    void TransformHierarchy::update() {
+        if (!_changed) {
+            return;
+        }
+        uint32_t parentBegin = 0;
+        uint32_t parentEnd = 0;
+        for (size_t level = 0; level + 1 < _levelStarts.size(); level++) {
+            uint32_t begin = _dirtyBegins[level];
+            uint32_t end = _dirtyEnds[level];
+            if (parentBegin < parentEnd) {
+                begin = std::min(begin, _childStarts[parentBegin]);
+                end = std::max(end, _childStarts[parentEnd]);
+            }
+            _dirtyBegins[level] = _levelStarts[level + 1];
+            _dirtyEnds[level] = _levelStarts[level];
+
+            if (begin < end) {
+                _rangeBegin = begin;
+                if (level == 0) {
+                    _jobSystem.parallelFor(end - begin, PARALLEL_BATCH_SIZE, [this](uint32_t batchBegin, uint32_t batchEnd) {
+                        updateRoots(_rangeBegin + batchBegin, _rangeBegin + batchEnd);
+                    });
+                } else {
+                    _jobSystem.parallelFor(end - begin, PARALLEL_BATCH_SIZE, [this](uint32_t batchBegin, uint32_t batchEnd) {
+                        if (_avx2Supported) {
+                            updateChildrenAvx2(_rangeBegin + batchBegin, _rangeBegin + batchEnd);
+                        } else {
+                            updateChildren(_rangeBegin + batchBegin, _rangeBegin + batchEnd);
+                        }
+                    });
+                }
+            }
+            std::fill(_dirty.begin() + parentBegin, _dirty.begin() + parentEnd, 0u);
+            parentBegin = begin < end ? begin : 0;
+            parentEnd = begin < end ? end : 0;
+        }
+        std::fill(_dirty.begin() + parentBegin, _dirty.begin() + parentEnd, 0u);
+        _changed = false;
+    }
+
+    void TransformHierarchy::updateRoots(uint32_t begin, uint32_t end) {
+        for (uint32_t node = begin; node < end; node++) {
+            if (_dirty[node] != 0) {
+                _worldX[node] = _localX[node];
+                _worldY[node] = _localY[node];
+                _worldScale[node] = _localScale[node];
+                _worldDepth[node] = _localDepth[node];
+            }
+        }
+    }
+
+    // A dirty parent makes its children dirty, so the flag travels down one level per pass //
+    void TransformHierarchy::updateChildren(uint32_t begin, uint32_t end) {
+        for (uint32_t node = begin; node < end; node++) {
+            uint32_t parent = _parents[node];
+            _dirty[node] |= _dirty[parent];
+            if (_dirty[node] != 0) {
+                _worldX[node] = _localX[node] * _worldScale[parent] + _worldX[parent];
+                _worldY[node] = _localY[node] * _worldScale[parent] + _worldY[parent];
+                _worldScale[node] = _localScale[node] * _worldScale[parent];
+                _worldDepth[node] = _localDepth[node];
+            }
+        }
+    }
+
+#ifdef TRANSFORM_HIERARCHY_AVX2
+    // updateChildren eight nodes at a time: parent values are gathered, and the dirty flags mask the stores //
+    __attribute__((target("avx2"))) void TransformHierarchy::updateChildrenAvx2(uint32_t begin, uint32_t end) {
+        const int *dirtyFlags = reinterpret_cast<const int *>(_dirty.data());
+        uint32_t node = begin;
+        for (; node + 8 <= end; node += 8) {
+            __m256i parents = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_parents.data() + node));
+            __m256i dirty = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(_dirty.data() + node)), _mm256_i32gather_epi32(dirtyFlags, parents, 4));
+            if (_mm256_testz_si256(dirty, dirty)) {
+                continue;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(_dirty.data() + node), dirty);
+            __m256 mask = _mm256_castsi256_ps(dirty);
+
+            __m256 parentX = _mm256_i32gather_ps(_worldX.data(), parents, 4);
+            __m256 parentY = _mm256_i32gather_ps(_worldY.data(), parents, 4);
+            __m256 parentScale = _mm256_i32gather_ps(_worldScale.data(), parents, 4);
+            __m256 worldX = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_localX.data() + node), parentScale), parentX);
+            __m256 worldY = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(_localY.data() + node), parentScale), parentY);
+            __m256 worldScale = _mm256_mul_ps(_mm256_loadu_ps(_localScale.data() + node), parentScale);
+            _mm256_storeu_ps(_worldX.data() + node, _mm256_blendv_ps(_mm256_loadu_ps(_worldX.data() + node), worldX, mask));
+            _mm256_storeu_ps(_worldY.data() + node, _mm256_blendv_ps(_mm256_loadu_ps(_worldY.data() + node), worldY, mask));
+            _mm256_storeu_ps(_worldScale.data() + node, _mm256_blendv_ps(_mm256_loadu_ps(_worldScale.data() + node), worldScale, mask));
+            _mm256_storeu_ps(_worldDepth.data() + node, _mm256_blendv_ps(_mm256_loadu_ps(_worldDepth.data() + node), _mm256_loadu_ps(_localDepth.data() + node), mask));
+        }
+        updateChildren(node, end);
+    }
+#else
+    void TransformHierarchy::updateChildrenAvx2(uint32_t begin, uint32_t end) {
+        updateChildren(begin, end);
+    }
+#endif
+
+    SceneTransform TransformHierarchy::getWorld(uint32_t entity) const {
+        uint32_t node = _nodes[entity];
+        return {{_worldX[node], _worldY[node]}, _worldScale[node], _worldDepth[node]};
+    }
+
+    uint32_t TransformHierarchy::getNodeCount() const {
+        return static_cast<uint32_t>(_nodes.size());
+    }
+
+    uint32_t TransformHierarchy::getLevelCount() const {
+        return _levelStarts.empty() ? 0 : static_cast<uint32_t>(_levelStarts.size() - 1);
+    }
+
+}
@@ -0,0 +1,614 @@
+#include "textures/block_decoder.hpp"
+#include "textures/image_decoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace vulkan {
+
+    namespace {
+
+        using Texels = uint8_t[16][4];
+
+        uint8_t clampByte(int value) {
+            return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+        }
+
+        uint64_t readLittleEndian64(const uint8_t *data) {
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; i--) {
+                value = value << 8 | data[i];
+            }
+            return value;
+        }
+
+        uint64_t readBigEndian64(const uint8_t *data) {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; i++) {
+                value = value << 8 | data[i];
+            }
+            return value;
+        }
+
+        // ---- BC1 - BC5 ---- //
+
+        // Colour block shared by BC1/BC2/BC3; only BC1 has the 3 colour + transparent mode //
+        void decodeBC1(const uint8_t *block, Texels &texels, bool alwaysFourColors, bool punchThroughAlpha) {
+            uint16_t color0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+            uint16_t color1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+            uint32_t indices = static_cast<uint32_t>(block[4] | block[5] << 8 | block[6] << 16 | block[7] << 24);
+
+            uint8_t palette[4][4];
+            uint16_t endpoints[2] = {color0, color1};
+            for (int i = 0; i < 2; i++) {
+                uint32_t r = (endpoints[i] >> 11) & 31;
+                uint32_t g = (endpoints[i] >> 5) & 63;
+                uint32_t b = endpoints[i] & 31;
+                palette[i][0] = static_cast<uint8_t>(r << 3 | r >> 2);
+                palette[i][1] = static_cast<uint8_t>(g << 2 | g >> 4);
+                palette[i][2] = static_cast<uint8_t>(b << 3 | b >> 2);
+                palette[i][3] = 255;
+            }
+            for (int c = 0; c < 3; c++) {
+                if (alwaysFourColors || color0 > color1) {
+                    palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+                    palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+                } else {
+                    palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+                    palette[3][c] = 0;
+                }
+            }
+            palette[2][3] = 255;
+            palette[3][3] = (!alwaysFourColors && color0 <= color1 && punchThroughAlpha) ? 0 : 255;
+
+            for (int i = 0; i < 16; i++) {
+                std::memcpy(texels[i], palette[(indices >> (i * 2)) & 3], 4);
+            }
+        }
+
+        // Single channel block of BC3 alpha, BC4 and both halves of BC5 //
+        void decodeBC4(const uint8_t *block, Texels &texels, int channel) {
+            uint64_t bits = readLittleEndian64(block);
+            int value0 = block[0];
+            int value1 = block[1];
+
+            uint8_t palette[8];
+            palette[0] = static_cast<uint8_t>(value0);
+            palette[1] = static_cast<uint8_t>(value1);
+            if (value0 > value1) {
+                for (int i = 1; i < 7; i++) {
+                    palette[i + 1] = static_cast<uint8_t>(((7 - i) * value0 + i * value1) / 7);
+                }
+            } else {
+                for (int i = 1; i < 5; i++) {
+                    palette[i + 1] = static_cast<uint8_t>(((5 - i) * value0 + i * value1) / 5);
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            for (int i = 0; i < 16; i++) {
+                texels[i][channel] = palette[(bits >> (16 + i * 3)) & 7];
+            }
+        }
+
+        // ---- BC7 ---- //
+
+        struct Bc7Mode {
+            uint8_t subsets;
+            uint8_t partitionBits;
+            uint8_t rotationBits;
+            uint8_t indexSelectionBits;
+            uint8_t colorBits;
+            uint8_t alphaBits;
+            uint8_t endpointPBits;
+            uint8_t sharedPBits;
+            uint8_t indexBits;
+            uint8_t secondaryIndexBits;
+        };
+
+        constexpr Bc7Mode BC7_MODES[8] = {
+            {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+            {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+            {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+            {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+            {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+            {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+            {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+            {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}
+        };
+
+        // Bit i is the subset of texel i //
+        constexpr uint16_t BC7_PARTITIONS_2[64] = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+            0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+            0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+        };
+
+        constexpr uint8_t BC7_PARTITIONS_3[64][16] = {
+            {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+            {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+            {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+            {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+            {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}, {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+            {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+            {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2}, {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+            {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+            {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2}, {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+            {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+            {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+            {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2}, {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+            {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0}, {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+            {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0}, {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+            {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2}, {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+            {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1}, {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+            {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+            {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2}, {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+            {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0}, {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+            {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0}, {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+            {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1}, {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+            {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1}, {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+            {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1}, {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+            {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1}, {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+            {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2}, {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+            {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2}, {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+            {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2}, {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+            {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+            {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+            {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+            {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1}, {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+            {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0}
+        };
+
+        constexpr uint8_t BC7_ANCHORS_2[64] = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+            6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+        };
+
+        constexpr uint8_t BC7_ANCHORS_3_SECOND[64] = {
+            3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+            3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+            8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+            3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+        };
+
+        constexpr uint8_t BC7_ANCHORS_3_THIRD[64] = {
+            15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+            15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+            15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+            15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+        };
+
+        constexpr uint8_t BC7_WEIGHTS_2[4] = {0, 21, 43, 64};
+        constexpr uint8_t BC7_WEIGHTS_3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+        constexpr uint8_t BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        struct BitReader {
+            const uint8_t *data;
+            uint32_t position;
+
+            uint32_t read(uint32_t count) {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < count; i++, position++) {
+                    value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7)) & 1) << i;
+                }
+                return value;
+            }
+        };
+
+        const uint8_t *bc7Weights(uint32_t indexBits) {
+            return indexBits == 2 ? BC7_WEIGHTS_2 : indexBits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4;
+        }
+
+        uint8_t bc7Interpolate(uint8_t endpoint0, uint8_t endpoint1, uint8_t weight) {
+            return static_cast<uint8_t>(((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6);
+        }
+
+        uint8_t bc7Expand(uint32_t value, uint32_t bits) {
+            value <<= 8 - bits;
+            return static_cast<uint8_t>(value | value >> bits);
+        }
+
+        void decodeBC7(const uint8_t *block, Texels &texels) {
+            uint32_t mode = 0;
+            while (mode < 8 && !((block[0] >> mode) & 1)) {
+                mode++;
+            }
+            if (mode == 8) {
+                std::memset(texels, 0, sizeof(Texels));
+                return;
+            }
+
+            const Bc7Mode &info = BC7_MODES[mode];
+            BitReader reader{block, mode + 1};
+            uint32_t partition = reader.read(info.partitionBits);
+            uint32_t rotation = reader.read(info.rotationBits);
+            uint32_t indexSelection = reader.read(info.indexSelectionBits);
+
+            uint32_t endpoints[3][2][4] = {};
+            for (uint32_t channel = 0; channel < 3; channel++) {
+                for (uint32_t subset = 0; subset < info.subsets; subset++) {
+                    endpoints[subset][0][channel] = reader.read(info.colorBits);
+                    endpoints[subset][1][channel] = reader.read(info.colorBits);
+                }
+            }
+            for (uint32_t subset = 0; subset < info.subsets && info.alphaBits > 0; subset++) {
+                endpoints[subset][0][3] = reader.read(info.alphaBits);
+                endpoints[subset][1][3] = reader.read(info.alphaBits);
+            }
+
+            uint32_t pBits[3][2] = {};
+            for (uint32_t subset = 0; subset < info.subsets; subset++) {
+                if (info.endpointPBits) {
+                    pBits[subset][0] = reader.read(1);
+                    pBits[subset][1] = reader.read(1);
+                } else if (info.sharedPBits) {
+                    pBits[subset][0] = pBits[subset][1] = reader.read(1);
+                }
+            }
+
+            bool hasPBits = info.endpointPBits || info.sharedPBits;
+            uint8_t colors[3][2][4];
+            for (uint32_t subset = 0; subset < info.subsets; subset++) {
+                for (uint32_t endpoint = 0; endpoint < 2; endpoint++) {
+                    for (uint32_t channel = 0; channel < 4; channel++) {
+                        uint32_t bits = channel < 3 ? info.colorBits : info.alphaBits;
+                        if (bits == 0) {
+                            colors[subset][endpoint][channel] = 255;
+                            continue;
+                        }
+                        uint32_t value = endpoints[subset][endpoint][channel];
+                        if (hasPBits) {
+                            value = value << 1 | pBits[subset][endpoint];
+                            bits++;
+                        }
+                        colors[subset][endpoint][channel] = bc7Expand(value, bits);
+                    }
+                }
+            }
+
+            uint8_t subsets[16];
+            bool anchors[16] = {};
+            anchors[0] = true;
+            for (uint32_t i = 0; i < 16; i++) {
+                subsets[i] = info.subsets == 1 ? 0 : info.subsets == 2 ? static_cast<uint8_t>((BC7_PARTITIONS_2[partition] >> i) & 1) : BC7_PARTITIONS_3[partition][i];
+            }
+            if (info.subsets == 2) {
+                anchors[BC7_ANCHORS_2[partition]] = true;
+            } else if (info.subsets == 3) {
+                anchors[BC7_ANCHORS_3_SECOND[partition]] = true;
+                anchors[BC7_ANCHORS_3_THIRD[partition]] = true;
+            }
+
+            // Anchor texels drop the implicit most significant index bit //
+            uint32_t primary[16];
+            uint32_t secondary[16] = {};
+            for (uint32_t i = 0; i < 16; i++) {
+                primary[i] = reader.read(anchors[i] ? info.indexBits - 1 : info.indexBits);
+            }
+            for (uint32_t i = 0; i < 16 && info.secondaryIndexBits > 0; i++) {
+                secondary[i] = reader.read(i == 0 ? info.secondaryIndexBits - 1 : info.secondaryIndexBits);
+            }
+
+            for (uint32_t i = 0; i < 16; i++) {
+                const uint8_t (&endpointColors)[2][4] = colors[subsets[i]];
+                uint8_t colorWeight = bc7Weights(info.indexBits)[primary[i]];
+                uint8_t alphaWeight = colorWeight;
+                if (info.secondaryIndexBits > 0) {
+                    uint8_t secondaryWeight = bc7Weights(info.secondaryIndexBits)[secondary[i]];
+                    if (indexSelection) {
+                        alphaWeight = colorWeight;
+                        colorWeight = secondaryWeight;
+                    } else {
+                        alphaWeight = secondaryWeight;
+                    }
+                }
+                for (uint32_t channel = 0; channel < 3; channel++) {
+                    texels[i][channel] = bc7Interpolate(endpointColors[0][channel], endpointColors[1][channel], colorWeight);
+                }
+                texels[i][3] = bc7Interpolate(endpointColors[0][3], endpointColors[1][3], alphaWeight);
+                if (rotation > 0) {
+                    std::swap(texels[i][rotation - 1], texels[i][3]);
+                }
+            }
+        }
+
+        // ---- ETC2 / EAC ---- //
+
+        constexpr int ETC_MODIFIERS[8][4] = {
+            {2, 8, -2, -8}, {5, 17, -5, -17}, {9, 29, -9, -29}, {13, 42, -13, -42},
+            {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}
+        };
+
+        constexpr int ETC_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+        constexpr int EAC_MODIFIERS[16][8] = {
+            {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+            {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10}, {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+            {-2, -6, -8, -10, 1, 5, 7, 9}, {-2, -5, -8, -10, 1, 4, 7, 9}, {-2, -4, -8, -10, 1, 3, 7, 9}, {-2, -5, -7, -10, 1, 4, 6, 9},
+            {-3, -4, -7, -10, 2, 3, 6, 9}, {-1, -2, -3, -10, 0, 1, 2, 9}, {-4, -6, -8, -9, 3, 5, 7, 8}, {-3, -5, -7, -9, 2, 4, 6, 8}
+        };
+
+        int extend4(uint32_t value) {
+            return static_cast<int>(value << 4 | value);
+        }
+
+        int extend5(uint32_t value) {
+            return static_cast<int>(value << 3 | value >> 2);
+        }
+
+        int extend6(uint32_t value) {
+            return static_cast<int>(value << 2 | value >> 4);
+        }
+
+        int extend7(uint32_t value) {
+            return static_cast<int>(value << 1 | value >> 6);
+        }
+
+        int signExtend3(uint32_t value) {
+            return value & 4 ? static_cast<int>(value) - 8 : static_cast<int>(value);
+        }
+
+        void setTexel(Texels &texels, uint32_t x, uint32_t y, int r, int g, int b, int a) {
+            uint8_t *texel = texels[y * 4 + x];
+            texel[0] = clampByte(r);
+            texel[1] = clampByte(g);
+            texel[2] = clampByte(b);
+            texel[3] = clampByte(a);
+        }
+
+        // ETC texels are stored column major: texel k is (k / 4, k % 4) //
+        uint32_t etcIndex(uint32_t low, uint32_t x, uint32_t y) {
+            uint32_t k = x * 4 + y;
+            return ((low >> (k + 16)) & 1) << 1 | ((low >> k) & 1);
+        }
+
+        void decodeETC2(const uint8_t *block, Texels &texels, bool punchThrough) {
+            uint64_t bits = readBigEndian64(block);
+            uint32_t high = static_cast<uint32_t>(bits >> 32);
+            uint32_t low = static_cast<uint32_t>(bits);
+            bool differential = (high >> 1) & 1;
+            bool flip = high & 1;
+            bool opaque = true;
+            if (punchThrough) {
+                opaque = differential;
+                differential = true;
+            }
+
+            int base[2][3];
+            if (!differential) {
+                for (int c = 0; c < 3; c++) {
+                    base[0][c] = extend4((high >> (28 - c * 8)) & 15);
+                    base[1][c] = extend4((high >> (24 - c * 8)) & 15);
+                }
+            } else {
+                int r = static_cast<int>((high >> 27) & 31);
+                int g = static_cast<int>((high >> 19) & 31);
+                int b = static_cast<int>((high >> 11) & 31);
+                int r2 = r + signExtend3((high >> 24) & 7);
+                int g2 = g + signExtend3((high >> 16) & 7);
+                int b2 = b + signExtend3((high >> 8) & 7);
+
+                if (r2 < 0 || r2 > 31) {
+                    // T mode //
+                    int color0[3] = {extend4(((high >> 27) & 3) << 2 | ((high >> 24) & 3)), extend4((high >> 20) & 15), extend4((high >> 16) & 15)};
+                    int color1[3] = {extend4((high >> 12) & 15), extend4((high >> 8) & 15), extend4((high >> 4) & 15)};
+                    int distance = ETC_DISTANCES[((high >> 2) & 3) << 1 | (high & 1)];
+                    int paint[4][3];
+                    for (int c = 0; c < 3; c++) {
+                        paint[0][c] = color0[c];
+                        paint[1][c] = color1[c] + distance;
+                        paint[2][c] = color1[c];
+                        paint[3][c] = color1[c] - distance;
+                    }
+                    for (uint32_t x = 0; x < 4; x++) {
+                        for (uint32_t y = 0; y < 4; y++) {
+                            uint32_t index = etcIndex(low, x, y);
+                            if (!opaque && index == 2) {
+                                setTexel(texels, x, y, 0, 0, 0, 0);
+                            } else {
+                                setTexel(texels, x, y, paint[index][0], paint[index][1], paint[index][2], 255);
+                            }
+                        }
+                    }
+                    return;
+                }
+
+                if (g2 < 0 || g2 > 31) {
+                    // H mode //
+                    int color0[3] = {extend4((high >> 27) & 15), extend4(((high >> 24) & 7) << 1 | ((high >> 20) & 1)), extend4(((high >> 19) & 1) << 3 | ((high >> 15) & 7))};
+                    int color1[3] = {extend4((high >> 11) & 15), extend4((high >> 7) & 15), extend4((high >> 3) & 15)};
+                    int value0 = color0[0] << 16 | color0[1] << 8 | color0[2];
+                    int value1 = color1[0] << 16 | color1[1] << 8 | color1[2];
+                    int distance = ETC_DISTANCES[((high >> 2) & 1) << 2 | (high & 1) << 1 | (value0 >= value1 ? 1 : 0)];
+                    int paint[4][3];
+                    for (int c = 0; c < 3; c++) {
+                        paint[0][c] = color0[c] + distance;
+                        paint[1][c] = color0[c] - distance;
+                        paint[2][c] = color1[c] + distance;
+                        paint[3][c] = color1[c] - distance;
+                    }
+                    for (uint32_t x = 0; x < 4; x++) {
+                        for (uint32_t y = 0; y < 4; y++) {
+                            uint32_t index = etcIndex(low, x, y);
+                            if (!opaque && index == 2) {
+                                setTexel(texels, x, y, 0, 0, 0, 0);
+                            } else {
+                                setTexel(texels, x, y, paint[index][0], paint[index][1], paint[index][2], 255);
+                            }
+                        }
+                    }
+                    return;
+                }
+
+                if (b2 < 0 || b2 > 31) {
+                    // Planar mode: colour gradient across the block, never transparent //
+                    int origin[3] = {extend6((high >> 25) & 63), extend7(((high >> 24) & 1) << 6 | ((high >> 17) & 63)), extend6(((high >> 16) & 1) << 5 | ((high >> 11) & 3) << 3 | ((high >> 7) & 7))};
+                    int horizontal[3] = {extend6(((high >> 2) & 31) << 1 | (high & 1)), extend7((low >> 25) & 127), extend6((low >> 19) & 63)};
+                    int vertical[3] = {extend6((low >> 13) & 63), extend7((low >> 6) & 127), extend6(low & 63)};
+                    for (uint32_t x = 0; x < 4; x++) {
+                        for (uint32_t y = 0; y < 4; y++) {
+                            int color[3];
+                            for (int c = 0; c < 3; c++) {
+                                color[c] = (static_cast<int>(x) * (horizontal[c] - origin[c]) + static_cast<int>(y) * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+                            }
+                            setTexel(texels, x, y, color[0], color[1], color[2], 255);
+                        }
+                    }
+                    return;
+                }
+
+                base[0][0] = extend5(static_cast<uint32_t>(r));
+                base[0][1] = extend5(static_cast<uint32_t>(g));
+                base[0][2] = extend5(static_cast<uint32_t>(b));
+                base[1][0] = extend5(static_cast<uint32_t>(r2));
+                base[1][1] = extend5(static_cast<uint32_t>(g2));
+                base[1][2] = extend5(static_cast<uint32_t>(b2));
+            }
+
+            uint32_t tables[2] = {(high >> 5) & 7, (high >> 2) & 7};
+            for (uint32_t x = 0; x < 4; x++) {
+                for (uint32_t y = 0; y < 4; y++) {
+                    uint32_t subblock = flip ? (y >= 2) : (x >= 2);
+                    uint32_t index = etcIndex(low, x, y);
+                    if (!opaque && index == 2) {
+                        setTexel(texels, x, y, 0, 0, 0, 0);
+                        continue;
+                    }
+                    int modifier = (!opaque && index == 0) ? 0 : ETC_MODIFIERS[tables[subblock]][index];
+                    setTexel(texels, x, y, base[subblock][0] + modifier, base[subblock][1] + modifier, base[subblock][2] + modifier, 255);
+                }
+            }
+        }
+
+        void decodeEACAlpha(const uint8_t *block, Texels &texels) {
+            uint64_t bits = readBigEndian64(block);
+            int base = static_cast<int>(bits >> 56);
+            int multiplier = static_cast<int>((bits >> 52) & 15);
+            const int *modifiers = EAC_MODIFIERS[(bits >> 48) & 15];
+            for (uint32_t k = 0; k < 16; k++) {
+                uint32_t index = static_cast<uint32_t>((bits >> (45 - k * 3)) & 7);
+                texels[(k % 4) * 4 + k / 4][3] = clampByte(base + modifiers[index] * multiplier);
+            }
+        }
+
+        void decodeBlock(VkFormat format, const uint8_t *block, Texels &texels) {
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    decodeBC1(block, texels, false, false);
+                    break;
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    decodeBC1(block, texels, false, true);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    decodeBC1(block + 8, texels, true, false);
+                    decodeBC4(block, texels, 3);
+                    break;
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    std::memset(texels, 0, sizeof(Texels));
+                    decodeBC4(block, texels, 0);
+                    for (int i = 0; i < 16; i++) {
+                        texels[i][3] = 255;
+                    }
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    std::memset(texels, 0, sizeof(Texels));
+                    decodeBC4(block, texels, 0);
+                    decodeBC4(block + 8, texels, 1);
+                    for (int i = 0; i < 16; i++) {
+                        texels[i][3] = 255;
+                    }
+                    break;
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                case VK_FORMAT_BC7_SRGB_BLOCK:
+                    decodeBC7(block, texels);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+                    decodeETC2(block, texels, false);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+                    decodeETC2(block, texels, true);
+                    break;
+                case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+                case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+                    decodeETC2(block + 8, texels, false);
+                    decodeEACAlpha(block, texels);
+                    break;
+                default:
+                    throw std::runtime_error("No CPU transcoder for this block-compressed format.");
+            }
+        }
+
+    }
+
+    bool BlockDecoder::canDecode(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    VkFormat BlockDecoder::getDecodedFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+                return VK_FORMAT_R8G8B8A8_SRGB;
+            default:
+                return VK_FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    // Decodes one mip level into tightly packed RGBA8, clipping the padding texels of edge blocks //
+    void BlockDecoder::decodeLevel(VkFormat format, const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *pixels) {
+        uint32_t bytesPerBlock = ImageDecoder::getFormatBlockInfo(format).bytesPerBlock;
+        uint32_t blocksWide = (width + 3) / 4;
+        uint32_t blocksHigh = (height + 3) / 4;
+
+        Texels texels;
+        for (uint32_t blockY = 0; blockY < blocksHigh; blockY++) {
+            for (uint32_t blockX = 0; blockX < blocksWide; blockX++) {
+                decodeBlock(format, blocks, texels);
+                blocks += bytesPerBlock;
+
+                uint32_t columns = std::min(4u, width - blockX * 4);
+                uint32_t rows = std::min(4u, height - blockY * 4);
+                for (uint32_t y = 0; y < rows; y++) {
+                    std::memcpy(pixels + (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4) * 4, texels[y * 4], columns * 4);
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,278 @@
+#include "textures/image_decoder.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace vulkan {
+
+    namespace {
+
+        struct DecoderRegistry {
+            std::mutex mutex;
+            std::unordered_map<std::string, ImageDecoder::DecodeFunction> decoders;
+        };
+
+        DecoderRegistry &registry() {
+            static DecoderRegistry instance;
+            return instance;
+        }
+
+        std::string fileExtension(const std::string &filePath) {
+            size_t dot = filePath.find_last_of('.');
+            if (dot == std::string::npos) {
+                return "";
+            }
+            std::string extension = filePath.substr(dot + 1);
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension;
+        }
+
+        // Reads the next header token, skipping whitespace and '#' comments //
+        std::string readPPMToken(std::istream &stream) {
+            std::string token;
+            int c = stream.get();
+            while (c != EOF) {
+                if (c == '#') {
+                    while (c != EOF && c != '\n') {
+                        c = stream.get();
+                    }
+                } else if (std::isspace(c)) {
+                    if (!token.empty()) {
+                        break;
+                    }
+                } else {
+                    token.push_back(static_cast<char>(c));
+                }
+                c = stream.get();
+            }
+            return token;
+        }
+
+        // 2x2 box filter of an RGBA8 level, clamping at odd edges //
+        void downsampleRGBA8(const uint8_t *source, uint32_t width, uint32_t height, uint8_t *destination) {
+            uint32_t newWidth = std::max(1u, width / 2);
+            uint32_t newHeight = std::max(1u, height / 2);
+            for (uint32_t y = 0; y < newHeight; y++) {
+                uint32_t y0 = std::min(y * 2, height - 1);
+                uint32_t y1 = std::min(y * 2 + 1, height - 1);
+                for (uint32_t x = 0; x < newWidth; x++) {
+                    uint32_t x0 = std::min(x * 2, width - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                    for (uint32_t c = 0; c < 4; c++) {
+                        uint32_t sum = source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] + source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+                        destination[(y * newWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+    }
+
+    void ImageDecoder::registerDecoder(const std::string &extension, DecodeFunction decoder) {
+        std::lock_guard<std::mutex> lock{registry().mutex};
+        registry().decoders[extension] = std::move(decoder);
+    }
+
+    DecodedImage ImageDecoder::decode(const std::string &filePath, uint32_t maxDimension) {
+        std::string extension = fileExtension(filePath);
+        DecodeFunction decoder;
+        {
+            std::lock_guard<std::mutex> lock{registry().mutex};
+            auto found = registry().decoders.find(extension);
+            if (found != registry().decoders.end()) {
+                decoder = found->second;
+            }
+        }
+        if (decoder) {
+            return decoder(filePath, maxDimension);
+        }
+        if (extension == "ppm") {
+            return decodePPM(filePath, maxDimension);
+        }
+        throw std::runtime_error("No image decoder for file: " + filePath);
+    }
+
+    DecodedImage ImageDecoder::decodePPM(const std::string &filePath, uint32_t maxDimension) {
+        std::ifstream file{filePath, std::ios::binary};
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file: " + filePath);
+        }
+
+        if (readPPMToken(file) != "P6") {
+            throw std::runtime_error("Unsupported PPM variant (expected P6): " + filePath);
+        }
+        uint32_t width = static_cast<uint32_t>(std::stoul(readPPMToken(file)));
+        uint32_t height = static_cast<uint32_t>(std::stoul(readPPMToken(file)));
+        uint32_t maxValue = static_cast<uint32_t>(std::stoul(readPPMToken(file)));
+        if (width == 0 || height == 0 || maxValue == 0 || maxValue > 65535) {
+            throw std::runtime_error("Invalid PPM header: " + filePath);
+        }
+
+        uint32_t bytesPerSample = maxValue > 255 ? 2 : 1;
+        std::vector<uint8_t> raw(static_cast<size_t>(width) * height * 3 * bytesPerSample);
+        file.read(reinterpret_cast<char *>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        if (static_cast<size_t>(file.gcount()) != raw.size()) {
+            throw std::runtime_error("Truncated PPM data: " + filePath);
+        }
+
+        std::shared_ptr<std::vector<uint8_t>> pixels = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(width) * height * 4);
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                uint32_t value = bytesPerSample == 2 ? (raw[(i * 3 + c) * 2] << 8 | raw[(i * 3 + c) * 2 + 1]) : raw[i * 3 + c];
+                (*pixels)[i * 4 + c] = static_cast<uint8_t>((value * 255 + maxValue / 2) / maxValue);
+            }
+            (*pixels)[i * 4 + 3] = 255;
+        }
+
+        DecodedImage image{};
+        image.format = VK_FORMAT_R8G8B8A8_SRGB;
+        image.width = width;
+        image.height = height;
+        image.mipLevels = fullMipLevelCount(width, height);
+        image.generateMipmaps = true;
+
+        image.levels.push_back({pixels->data(), static_cast<VkDeviceSize>(pixels->size()), width, height});
+        image.storage = pixels;
+        dropLevelsAbove(image, maxDimension);
+        return image;
+    }
+
+    // Only keep what the requested residency needs: downsample levels[0] on the CPU until it fits maxDimension //
+    void ImageDecoder::dropLevelsAbove(DecodedImage &image, uint32_t maxDimension) {
+        if (image.levels.size() != 1 || (image.format != VK_FORMAT_R8G8B8A8_SRGB && image.format != VK_FORMAT_R8G8B8A8_UNORM)) {
+            throw std::runtime_error("Only single level RGBA8 images can be downsampled on the CPU.");
+        }
+
+        const uint8_t *pixels = image.levels[0].data;
+        uint32_t levelWidth = image.levels[0].width;
+        uint32_t levelHeight = image.levels[0].height;
+        std::shared_ptr<std::vector<uint8_t>> next;
+        while (image.baseLevel + 1 < image.mipLevels && std::max(levelWidth, levelHeight) > maxDimension) {
+            uint32_t nextWidth = std::max(1u, levelWidth / 2);
+            uint32_t nextHeight = std::max(1u, levelHeight / 2);
+            std::shared_ptr<std::vector<uint8_t>> level = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(nextWidth) * nextHeight * 4);
+            downsampleRGBA8(pixels, levelWidth, levelHeight, level->data());
+            next = level;
+            pixels = next->data();
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+            image.baseLevel++;
+        }
+
+        if (next != nullptr) {
+            image.levels[0] = {next->data(), static_cast<VkDeviceSize>(next->size()), levelWidth, levelHeight};
+            image.storage = next;
+        }
+    }
+
+    // CPU fallback when the device cannot blit the format: fills in every level below levels[0] //
+    void ImageDecoder::buildMipChain(DecodedImage &image) {
+        if (!image.generateMipmaps || image.levels.empty()) {
+            return;
+        }
+        if (image.format != VK_FORMAT_R8G8B8A8_SRGB && image.format != VK_FORMAT_R8G8B8A8_UNORM) {
+            throw std::runtime_error("CPU mipmap generation only supports RGBA8 images.");
+        }
+
+        uint32_t levelCount = image.mipLevels - image.baseLevel;
+        uint32_t width = image.levels[0].width;
+        uint32_t height = image.levels[0].height;
+        std::shared_ptr<std::vector<uint8_t>> chain = std::make_shared<std::vector<uint8_t>>(mipChainSize(image.format, width, height, levelCount));
+        std::copy(image.levels[0].data, image.levels[0].data + image.levels[0].size, chain->begin());
+
+        std::vector<VkDeviceSize> offsets(levelCount, 0);
+        for (uint32_t level = 1; level < levelCount; level++) {
+            uint32_t levelWidth = std::max(1u, width >> (level - 1));
+            uint32_t levelHeight = std::max(1u, height >> (level - 1));
+            offsets[level] = offsets[level - 1] + mipLevelSize(image.format, levelWidth, levelHeight);
+            downsampleRGBA8(chain->data() + offsets[level - 1], levelWidth, levelHeight, chain->data() + offsets[level]);
+        }
+
+        image.levels.clear();
+        for (uint32_t level = 0; level < levelCount; level++) {
+            uint32_t levelWidth = std::max(1u, width >> level);
+            uint32_t levelHeight = std::max(1u, height >> level);
+            image.levels.push_back({chain->data() + offsets[level], mipLevelSize(image.format, levelWidth, levelHeight), levelWidth, levelHeight});
+        }
+        image.storage = chain;
+        image.generateMipmaps = false;
+    }
+
+    uint32_t ImageDecoder::fullMipLevelCount(uint32_t width, uint32_t height) {
+        uint32_t levels = 1;
+        uint32_t dimension = std::max(width, height);
+        while (dimension > 1) {
+            dimension >>= 1;
+            levels++;
+        }
+        return levels;
+    }
+
+    FormatBlockInfo ImageDecoder::getFormatBlockInfo(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return {1, 1, 4};
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+                return {4, 4, 8};
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC5_SNORM_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+                return {4, 4, 16};
+            case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+                return {5, 5, 16};
+            case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+                return {6, 6, 16};
+            case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+                return {8, 8, 16};
+            case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+                return {10, 10, 16};
+            case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+            case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+                return {12, 12, 16};
+            default:
+                throw std::runtime_error("Unsupported texture format.");
+        }
+    }
+
+    VkDeviceSize ImageDecoder::mipLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+        FormatBlockInfo block = getFormatBlockInfo(format);
+        VkDeviceSize blocksWide = (width + block.blockWidth - 1) / block.blockWidth;
+        VkDeviceSize blocksHigh = (height + block.blockHeight - 1) / block.blockHeight;
+        return blocksWide * blocksHigh * block.bytesPerBlock;
+    }
+
+    VkDeviceSize ImageDecoder::mipChainSize(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount) {
+        VkDeviceSize size = 0;
+        for (uint32_t level = 0; level < levelCount; level++) {
+            size += mipLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level));
+        }
+        return size;
+    }
+
+}
@@ -0,0 +1,174 @@
+#include "textures/ktx2_loader.hpp"
+#include "textures/block_decoder.hpp"
+#include "core/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace vulkan {
+
+    namespace {
+
+        constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+        struct Ktx2Header {
+            uint8_t identifier[12];
+            uint32_t vkFormat;
+            uint32_t typeSize;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth;
+            uint32_t layerCount;
+            uint32_t faceCount;
+            uint32_t levelCount;
+            uint32_t supercompressionScheme;
+            uint32_t dfdByteOffset;
+            uint32_t dfdByteLength;
+            uint32_t kvdByteOffset;
+            uint32_t kvdByteLength;
+            uint64_t sgdByteOffset;
+            uint64_t sgdByteLength;
+        };
+        static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+
+        struct Ktx2LevelIndex {
+            uint64_t byteOffset;
+            uint64_t byteLength;
+            uint64_t uncompressedByteLength;
+        };
+
+        // Best first: what a KTX2 file may contain and we know how to size //
+        constexpr VkFormat KTX2_FORMATS[] = {
+            VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB,
+            VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+            VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK, VK_FORMAT_BC5_SNORM_BLOCK,
+            VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK,
+            VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK,
+            VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,
+            VK_FORMAT_ASTC_4x4_UNORM_BLOCK, VK_FORMAT_ASTC_4x4_SRGB_BLOCK, VK_FORMAT_ASTC_5x5_UNORM_BLOCK, VK_FORMAT_ASTC_5x5_SRGB_BLOCK,
+            VK_FORMAT_ASTC_6x6_UNORM_BLOCK, VK_FORMAT_ASTC_6x6_SRGB_BLOCK, VK_FORMAT_ASTC_8x8_UNORM_BLOCK, VK_FORMAT_ASTC_8x8_SRGB_BLOCK,
+            VK_FORMAT_ASTC_10x10_UNORM_BLOCK, VK_FORMAT_ASTC_10x10_SRGB_BLOCK, VK_FORMAT_ASTC_12x12_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+        };
+
+    }
+
+    // Resolved once up front so worker threads never touch the device //
+    Ktx2Loader::Ktx2Loader(Device &device) {
+        for (VkFormat format : KTX2_FORMATS) {
+            std::vector<VkFormat> candidates{format};
+            if (BlockDecoder::canDecode(format)) {
+                candidates.push_back(BlockDecoder::getDecodedFormat(format));
+            }
+            try {
+                _uploadFormats[format] = device.findSupportedFormat(candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT);
+            } catch (const std::runtime_error &) {
+                // Neither the format nor a transcode target is usable: files in it fail to load //
+            }
+        }
+    }
+
+    void Ktx2Loader::registerDecoder(Device &device) {
+        std::shared_ptr<const Ktx2Loader> loader = std::make_shared<const Ktx2Loader>(device);
+        ImageDecoder::registerDecoder("ktx2", [loader](const std::string &filePath, uint32_t maxDimension) {
+            return loader->load(filePath, maxDimension);
+        });
+    }
+
+    VkFormat Ktx2Loader::getUploadFormat(VkFormat fileFormat) const {
+        auto found = _uploadFormats.find(fileFormat);
+        return found != _uploadFormats.end() ? found->second : VK_FORMAT_UNDEFINED;
+    }
+
+    DecodedImage Ktx2Loader::load(const std::string &filePath, uint32_t maxDimension) const {
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(filePath);
+        if (file->getSize() < sizeof(Ktx2Header) || std::memcmp(file->getData(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+            throw std::runtime_error("Not a KTX2 file: " + filePath);
+        }
+
+        Ktx2Header header;
+        std::memcpy(&header, file->getData(), sizeof(header));
+        if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1) {
+            throw std::runtime_error("Only 2D KTX2 textures are supported: " + filePath);
+        }
+        if (header.supercompressionScheme != 0) {
+            throw std::runtime_error("Supercompressed KTX2 files are not supported: " + filePath);
+        }
+
+        VkFormat fileFormat = static_cast<VkFormat>(header.vkFormat);
+        VkFormat uploadFormat = getUploadFormat(fileFormat);
+        if (uploadFormat == VK_FORMAT_UNDEFINED) {
+            throw std::runtime_error("KTX2 format is not supported by this device: " + filePath);
+        }
+
+        // A level count of 0 asks the loader to generate the chain //
+        bool generateMipmaps = header.levelCount == 0;
+        uint32_t storedLevels = std::max(1u, header.levelCount);
+        if (storedLevels > ImageDecoder::fullMipLevelCount(header.pixelWidth, header.pixelHeight)) {
+            throw std::runtime_error("KTX2 level count exceeds the full mip chain: " + filePath);
+        }
+        if (file->getSize() < sizeof(Ktx2Header) + storedLevels * sizeof(Ktx2LevelIndex)) {
+            throw std::runtime_error("Truncated KTX2 level index: " + filePath);
+        }
+        const Ktx2LevelIndex *levelIndex = reinterpret_cast<const Ktx2LevelIndex *>(file->getData() + sizeof(Ktx2Header));
+
+        bool compressed = ImageDecoder::getFormatBlockInfo(fileFormat).blockWidth > 1;
+        bool transcode = uploadFormat != fileFormat || (generateMipmaps && compressed);
+        if (transcode && !BlockDecoder::canDecode(fileFormat)) {
+            throw std::runtime_error("KTX2 file needs a CPU transcode that is not available: " + filePath);
+        }
+
+        DecodedImage image{};
+        image.format = transcode ? BlockDecoder::getDecodedFormat(fileFormat) : fileFormat;
+        image.width = header.pixelWidth;
+        image.height = header.pixelHeight;
+        image.mipLevels = generateMipmaps ? ImageDecoder::fullMipLevelCount(header.pixelWidth, header.pixelHeight) : storedLevels;
+        image.generateMipmaps = generateMipmaps;
+
+        // Skip stored levels above the requested residency; they are never paged in //
+        if (!generateMipmaps) {
+            while (image.baseLevel + 1 < storedLevels && std::max(header.pixelWidth >> image.baseLevel, header.pixelHeight >> image.baseLevel) > maxDimension) {
+                image.baseLevel++;
+            }
+        }
+
+        std::vector<DecodedMipLevel> sourceLevels;
+        for (uint32_t level = image.baseLevel; level < storedLevels; level++) {
+            uint32_t width = std::max(1u, header.pixelWidth >> level);
+            uint32_t height = std::max(1u, header.pixelHeight >> level);
+            VkDeviceSize size = ImageDecoder::mipLevelSize(fileFormat, width, height);
+            const Ktx2LevelIndex &entry = levelIndex[level];
+            if (entry.byteLength < size || entry.byteOffset > file->getSize() || file->getSize() - entry.byteOffset < size) {
+                throw std::runtime_error("Truncated KTX2 level data: " + filePath);
+            }
+            file->prefetch(static_cast<size_t>(entry.byteOffset), static_cast<size_t>(size));
+            sourceLevels.push_back({file->getData() + entry.byteOffset, size, width, height});
+        }
+
+        if (!transcode) {
+            image.levels = std::move(sourceLevels);
+            image.storage = file;
+        } else {
+            VkDeviceSize totalSize = 0;
+            for (const DecodedMipLevel &level : sourceLevels) {
+                totalSize += static_cast<VkDeviceSize>(level.width) * level.height * 4;
+            }
+            std::shared_ptr<std::vector<uint8_t>> pixels = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(totalSize));
+            uint8_t *destination = pixels->data();
+            for (const DecodedMipLevel &level : sourceLevels) {
+                BlockDecoder::decodeLevel(fileFormat, level.data, level.width, level.height, destination);
+                image.levels.push_back({destination, static_cast<VkDeviceSize>(level.width) * level.height * 4, level.width, level.height});
+                destination += static_cast<size_t>(level.width) * level.height * 4;
+            }
+            image.storage = pixels;
+        }
+
+        if (generateMipmaps) {
+            ImageDecoder::dropLevelsAbove(image, maxDimension);
+        }
+        return image;
+    }
+
+}
@@ -0,0 +1,66 @@
+#include "textures/staging_ring.hpp"
+
+#include <stdexcept>
+
+namespace vulkan {
+
+    StagingRing::StagingRing(Device &device, VkDeviceSize size) : _device{device}, _size{size} {
+        _device.createBuffer(_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _buffer, _memory, MemoryCategory::Staging);
+
+        void *data;
+        if (vkMapMemory(_device.getDevice(), _memory, 0, _size, 0, &data) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map staging ring memory.");
+        }
+        _mapped = static_cast<uint8_t *>(data);
+    }
+
+    // Positions grow monotonically; the physical offset is the position modulo the ring size //
+    bool StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) {
+        if (size > _size) {
+            return false;
+        }
+
+        uint64_t begin = (_head + alignment - 1) / alignment * alignment;
+        if (begin % _size + size > _size) {
+            begin = (begin / _size + 1) * _size;
+        }
+        uint64_t end = begin + size;
+        if (end - _tail > _size) {
+            return false;
+        }
+
+        _head = end;
+        offset = begin % _size;
+        return true;
+    }
+
+    // Frees everything allocated before `position` (a value previously returned by getHead) //
+    void StagingRing::release(uint64_t position) {
+        if (position > _tail) {
+            _tail = position;
+        }
+    }
+
+    uint64_t StagingRing::getHead() {
+        return _head;
+    }
+
+    uint8_t *StagingRing::getMapped() {
+        return _mapped;
+    }
+
+    VkBuffer StagingRing::getBuffer() {
+        return _buffer;
+    }
+
+    VkDeviceSize StagingRing::getSize() {
+        return _size;
+    }
+
+    StagingRing::~StagingRing() {
+        vkUnmapMemory(_device.getDevice(), _memory);
+        vkDestroyBuffer(_device.getDevice(), _buffer, nullptr);
+        _device.freeMemory(_memory);
+    }
+
+}
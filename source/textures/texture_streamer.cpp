@@ -0,0 +1,717 @@
+#include "textures/texture_streamer.hpp"
+#include "textures/ktx2_loader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace vulkan {
+
+    static constexpr VkPipelineStageFlags SHADER_READ_STAGES = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    static VkImageMemoryBarrier imageBarrier(VkImage image, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = baseLevel;
+        barrier.subresourceRange.levelCount = levelCount;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        return barrier;
+    }
+
+    TextureStreamer::TextureStreamer(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, DeletionQueue &deletionQueue) : TextureStreamer{device, jobSystem, bindlessTable, deletionQueue, Settings{}} {}
+
+    TextureStreamer::TextureStreamer(Device &device, JobSystem &jobSystem, BindlessTable &bindlessTable, DeletionQueue &deletionQueue, const Settings &settings) : _device{device}, _jobSystem{jobSystem}, _bindlessTable{bindlessTable}, _deletionQueue{deletionQueue}, _settings{settings}, _stagingRing{device, settings.stagingBufferSize} {
+        _queueFamilies = _device.findPhysicalQueueFamilies();
+
+        try {
+            _device.findSupportedFormat({VK_FORMAT_R8G8B8A8_SRGB}, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+            _gpuMipmapsSupported = true;
+        } catch (const std::runtime_error &) {
+            _gpuMipmapsSupported = false;
+        }
+
+        Ktx2Loader::registerDecoder(_device);
+
+        createCommandPools();
+        createBatches();
+        createSampler();
+        createDefaultTexture();
+    }
+
+    void TextureStreamer::createCommandPools() {
+        VkCommandPoolCreateInfo poolInformation{};
+        poolInformation.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInformation.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInformation.queueFamilyIndex = _queueFamilies.graphicsFamily;
+
+        if (vkCreateCommandPool(_device.getDevice(), &poolInformation, nullptr, &_graphicsCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture streaming command pool.");
+        }
+
+        if (_queueFamilies.hasDedicatedTransfer()) {
+            poolInformation.queueFamilyIndex = _queueFamilies.transferFamily;
+            if (vkCreateCommandPool(_device.getDevice(), &poolInformation, nullptr, &_transferCommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create texture transfer command pool.");
+            }
+        }
+    }
+
+    void TextureStreamer::createBatches() {
+        VkCommandBufferAllocateInfo allocInformation{};
+        allocInformation.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInformation.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInformation.commandBufferCount = 1;
+
+        VkFenceCreateInfo fenceInformation{};
+        fenceInformation.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkSemaphoreCreateInfo semaphoreInformation{};
+        semaphoreInformation.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for (GpuBatch &batch : _batches) {
+            allocInformation.commandPool = _graphicsCommandPool;
+            if (vkAllocateCommandBuffers(_device.getDevice(), &allocInformation, &batch.graphicsCommandBuffer) != VK_SUCCESS || vkCreateFence(_device.getDevice(), &fenceInformation, nullptr, &batch.fence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create texture streaming batch.");
+            }
+            if (_transferCommandPool != VK_NULL_HANDLE) {
+                allocInformation.commandPool = _transferCommandPool;
+                if (vkAllocateCommandBuffers(_device.getDevice(), &allocInformation, &batch.transferCommandBuffer) != VK_SUCCESS || vkCreateSemaphore(_device.getDevice(), &semaphoreInformation, nullptr, &batch.ownershipSemaphore) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create texture streaming batch.");
+                }
+            }
+        }
+    }
+
+    void TextureStreamer::createSampler() {
+        VkSamplerCreateInfo samplerInformation{};
+        samplerInformation.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInformation.magFilter = VK_FILTER_LINEAR;
+        samplerInformation.minFilter = VK_FILTER_LINEAR;
+        samplerInformation.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInformation.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInformation.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInformation.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInformation.anisotropyEnable = VK_TRUE;
+        samplerInformation.maxAnisotropy = _device._properties.limits.maxSamplerAnisotropy;
+        samplerInformation.compareEnable = VK_FALSE;
+        samplerInformation.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInformation.minLod = 0.0f;
+        samplerInformation.maxLod = VK_LOD_CLAMP_NONE;
+        samplerInformation.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerInformation.unnormalizedCoordinates = VK_FALSE;
+
+        if (vkCreateSampler(_device.getDevice(), &samplerInformation, nullptr, &_sampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture sampler.");
+        }
+    }
+
+    // 1x1 white texture every handle resolves to until its first mips are resident //
+    void TextureStreamer::createDefaultTexture() {
+        VkDeviceSize bytes;
+        createTextureImage(VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, _defaultImage, _defaultMemory, _defaultView, bytes);
+
+        VkDeviceSize offset;
+        if (!_stagingRing.allocate(4, 4, offset)) {
+            throw std::runtime_error("Failed to allocate staging memory for the default texture.");
+        }
+        std::memset(_stagingRing.getMapped() + offset, 0xFF, 4);
+
+        VkCommandBuffer commandBuffer = _device.beginSingleTimeCommands();
+        VkImageMemoryBarrier toTransfer = imageBarrier(_defaultImage, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {1, 1, 1};
+        vkCmdCopyBufferToImage(commandBuffer, _stagingRing.getBuffer(), _defaultImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImageMemoryBarrier toShader = imageBarrier(_defaultImage, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_READ_STAGES, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+        _device.endSingleTimeCommands(commandBuffer);
+
+        _stagingRing.release(_stagingRing.getHead());
+        _defaultIndex = _bindlessTable.registerImage(_defaultView, _sampler);
+    }
+
+    TextureHandle TextureStreamer::request(const std::string &filePath) {
+        TextureHandle handle;
+        if (!_freeTextures.empty()) {
+            handle = _freeTextures.back();
+            _freeTextures.pop_back();
+        } else {
+            handle = static_cast<TextureHandle>(_textures.size());
+            _textures.emplace_back();
+        }
+
+        Texture &texture = _textures[handle];
+        uint32_t serial = texture.serial + 1;
+        texture = Texture{};
+        texture.serial = serial;
+        texture.path = filePath;
+        texture.inUse = true;
+        texture.busy = true;
+        texture.state = TextureState::Decoding;
+        texture.lastUsedFrame = _frame;
+        requestDecode(handle, _settings.initialResidentDimension);
+        return handle;
+    }
+
+    void TextureStreamer::release(TextureHandle handle) {
+        Texture &texture = _textures[handle];
+        if (!texture.inUse) {
+            return;
+        }
+        if (texture.image != VK_NULL_HANDLE) {
+            destroyLater(texture.image, texture.memory, texture.view, texture.bindlessIndex);
+        }
+        _residentBytes -= texture.residentBytes;
+        _reservedBytes -= texture.reservedBytes;
+
+        uint32_t serial = texture.serial + 1;
+        texture = Texture{};
+        texture.serial = serial;
+        _freeTextures.push_back(handle);
+    }
+
+    void TextureStreamer::touch(TextureHandle handle) {
+        _textures[handle].lastUsedFrame = _frame;
+    }
+
+    uint32_t TextureStreamer::getBindlessIndex(TextureHandle handle) {
+        if (handle >= _textures.size() || !_textures[handle].inUse || _textures[handle].bindlessIndex == BindlessTable::INVALID_INDEX) {
+            return _defaultIndex;
+        }
+        return _textures[handle].bindlessIndex;
+    }
+
+    bool TextureStreamer::isFullyResident(TextureHandle handle) {
+        const Texture &texture = _textures[handle];
+        return texture.inUse && texture.state == TextureState::Resident && texture.residentLevel == texture.bestLevel;
+    }
+
+    void TextureStreamer::setMemoryBudget(VkDeviceSize budget) {
+        _settings.memoryBudget = budget;
+    }
+
+    TextureStreamer::Statistics TextureStreamer::getStatistics() {
+        Statistics statistics{};
+        statistics.residentBytes = _residentBytes;
+        statistics.memoryBudget = _settings.memoryBudget;
+        statistics.pendingDecodes = _pendingDecodes;
+        for (const Texture &texture : _textures) {
+            if (texture.inUse) {
+                statistics.textureCount++;
+                if (texture.state == TextureState::Resident && texture.residentLevel == texture.bestLevel) {
+                    statistics.fullyResidentCount++;
+                }
+            }
+        }
+        for (const GpuBatch &batch : _batches) {
+            if (batch.inFlight) {
+                statistics.uploadsInFlight += static_cast<uint32_t>(batch.changes.size());
+            }
+        }
+        return statistics;
+    }
+
+    void TextureStreamer::update() {
+        _frame++;
+        collectDecodeResults();
+        retireBatches();
+
+        bool overBudget = _residentBytes > _settings.memoryBudget;
+        if (!_readyUploads.empty() || overBudget) {
+            GpuBatch *batch = acquireBatch();
+            if (batch != nullptr) {
+                beginBatch(*batch);
+                submitUploads(*batch);
+                if (overBudget) {
+                    enforceBudget(*batch);
+                }
+                submitBatch(*batch);
+            }
+        }
+
+        scheduleUpgrades();
+    }
+
+    // Runs on a job system worker; only touches the request it was given and the result list //
+    void TextureStreamer::decode(TextureHandle handle, uint32_t serial, const std::string &path, uint32_t maxDimension) {
+        DecodeResult result{handle, serial, {}, {}};
+        try {
+            result.image = ImageDecoder::decode(path, maxDimension);
+            if (result.image.generateMipmaps && !_gpuMipmapsSupported) {
+                ImageDecoder::buildMipChain(result.image);
+            }
+        } catch (const std::exception &error) {
+            result.error = error.what();
+        }
+
+        std::lock_guard<std::mutex> lock{_resultMutex};
+        _decodeResults.push_back(std::move(result));
+    }
+
+    void TextureStreamer::requestDecode(TextureHandle handle, uint32_t maxDimension) {
+        _pendingDecodes++;
+        uint32_t serial = _textures[handle].serial;
+        std::string path = _textures[handle].path;
+        _jobSystem.schedule([this, handle, serial, path, maxDimension]() { decode(handle, serial, path, maxDimension); }, &_decodeCounter);
+    }
+
+    void TextureStreamer::collectDecodeResults() {
+        {
+            std::lock_guard<std::mutex> lock{_resultMutex};
+            if (_decodeResults.empty()) {
+                return;
+            }
+            _collectedResults.swap(_decodeResults);
+        }
+
+        for (DecodeResult &result : _collectedResults) {
+            _pendingDecodes--;
+            Texture &texture = _textures[result.texture];
+            if (!texture.inUse || texture.serial != result.serial) {
+                continue;
+            }
+
+            bool upgrade = texture.state == TextureState::Resident;
+            if (!result.error.empty() || (upgrade && result.image.baseLevel >= texture.residentLevel)) {
+                if (!result.error.empty()) {
+                    std::cerr << "Failed to stream texture " << texture.path << ": " << result.error << std::endl;
+                }
+                // Keep whatever is resident and stop trying to climb further //
+                texture.bestLevel = upgrade ? texture.residentLevel : 0;
+                texture.state = upgrade ? TextureState::Resident : TextureState::Failed;
+                texture.busy = false;
+                _reservedBytes -= texture.reservedBytes;
+                texture.reservedBytes = 0;
+                continue;
+            }
+
+            if (!upgrade) {
+                texture.format = result.image.format;
+                texture.width = result.image.width;
+                texture.height = result.image.height;
+                texture.mipLevels = result.image.mipLevels;
+                texture.minimumResidentLevel = result.image.baseLevel;
+                texture.state = TextureState::Uploading;
+            }
+            _readyUploads.push_back(std::move(result));
+        }
+        _collectedResults.clear();
+    }
+
+    TextureStreamer::GpuBatch *TextureStreamer::acquireBatch() {
+        for (GpuBatch &batch : _batches) {
+            if (!batch.inFlight) {
+                return &batch;
+            }
+        }
+        return nullptr;
+    }
+
+    void TextureStreamer::beginBatch(GpuBatch &batch) {
+        VkCommandBufferBeginInfo beginInformation{};
+        beginInformation.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInformation.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(batch.graphicsCommandBuffer, &beginInformation);
+        if (batch.transferCommandBuffer != VK_NULL_HANDLE) {
+            vkBeginCommandBuffer(batch.transferCommandBuffer, &beginInformation);
+        }
+        batch.changes.clear();
+    }
+
+    void TextureStreamer::submitBatch(GpuBatch &batch) {
+        vkEndCommandBuffer(batch.graphicsCommandBuffer);
+
+        VkSubmitInfo graphicsSubmit{};
+        graphicsSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphicsSubmit.commandBufferCount = 1;
+        graphicsSubmit.pCommandBuffers = &batch.graphicsCommandBuffer;
+
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        if (batch.transferCommandBuffer != VK_NULL_HANDLE) {
+            vkEndCommandBuffer(batch.transferCommandBuffer);
+
+            VkSubmitInfo transferSubmit{};
+            transferSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            transferSubmit.commandBufferCount = 1;
+            transferSubmit.pCommandBuffers = &batch.transferCommandBuffer;
+            transferSubmit.signalSemaphoreCount = 1;
+            transferSubmit.pSignalSemaphores = &batch.ownershipSemaphore;
+            if (vkQueueSubmit(_device.getTransferQueue(), 1, &transferSubmit, VK_NULL_HANDLE) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit texture transfer commands.");
+            }
+
+            graphicsSubmit.waitSemaphoreCount = 1;
+            graphicsSubmit.pWaitSemaphores = &batch.ownershipSemaphore;
+            graphicsSubmit.pWaitDstStageMask = &waitStage;
+        }
+
+        if (vkQueueSubmit(_device.getGraphicsQueue(), 1, &graphicsSubmit, batch.fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit texture upload commands.");
+        }
+        batch.stagingEnd = _stagingRing.getHead();
+        batch.inFlight = true;
+    }
+
+    void TextureStreamer::retireBatches() {
+        for (GpuBatch &batch : _batches) {
+            if (!batch.inFlight || vkGetFenceStatus(_device.getDevice(), batch.fence) != VK_SUCCESS) {
+                continue;
+            }
+            vkResetFences(_device.getDevice(), 1, &batch.fence);
+            _stagingRing.release(batch.stagingEnd);
+            batch.inFlight = false;
+
+            for (const ResidencyChange &change : batch.changes) {
+                Texture &texture = _textures[change.texture];
+                if (!texture.inUse || texture.serial != change.serial) {
+                    // Released while in flight: the new image was never visible to any frame //
+                    vkDestroyImageView(_device.getDevice(), change.view, nullptr);
+                    vkDestroyImage(_device.getDevice(), change.image, nullptr);
+                    _device.freeMemory(change.memory);
+                    continue;
+                }
+
+                // A fresh bindless slot: the old one may still be read by frames in flight //
+                uint32_t bindlessIndex = _bindlessTable.registerImage(change.view, _sampler);
+                if (texture.image != VK_NULL_HANDLE) {
+                    destroyLater(texture.image, texture.memory, texture.view, texture.bindlessIndex);
+                }
+                _residentBytes = _residentBytes - texture.residentBytes + change.bytes;
+                _reservedBytes -= texture.reservedBytes;
+
+                texture.image = change.image;
+                texture.memory = change.memory;
+                texture.view = change.view;
+                texture.residentBytes = change.bytes;
+                texture.reservedBytes = 0;
+                texture.bindlessIndex = bindlessIndex;
+                texture.residentLevel = change.residentLevel;
+                texture.state = TextureState::Resident;
+                texture.busy = false;
+            }
+            batch.changes.clear();
+        }
+    }
+
+    void TextureStreamer::submitUploads(GpuBatch &batch) {
+        VkDeviceSize alignment = std::max<VkDeviceSize>(16, _device._properties.limits.optimalBufferCopyOffsetAlignment);
+        VkDeviceSize uploadedBytes = 0;
+        size_t consumed = 0;
+
+        for (; consumed < _readyUploads.size(); consumed++) {
+            DecodeResult &result = _readyUploads[consumed];
+            Texture &texture = _textures[result.texture];
+            if (!texture.inUse || texture.serial != result.serial) {
+                continue;
+            }
+
+            const DecodedImage &decoded = result.image;
+            _levelOffsets.clear();
+            VkDeviceSize totalSize = 0;
+            for (const DecodedMipLevel &level : decoded.levels) {
+                totalSize = (totalSize + alignment - 1) / alignment * alignment;
+                _levelOffsets.push_back(totalSize);
+                totalSize += level.size;
+            }
+
+            if (totalSize > _stagingRing.getSize()) {
+                std::cerr << "Texture " << texture.path << " does not fit in the staging ring." << std::endl;
+                texture.state = texture.image != VK_NULL_HANDLE ? TextureState::Resident : TextureState::Failed;
+                texture.bestLevel = texture.image != VK_NULL_HANDLE ? texture.residentLevel : 0;
+                texture.busy = false;
+                _reservedBytes -= texture.reservedBytes;
+                texture.reservedBytes = 0;
+                continue;
+            }
+
+            VkDeviceSize stagingOffset;
+            if ((uploadedBytes > 0 && uploadedBytes + totalSize > _settings.maxUploadBytesPerFrame) || !_stagingRing.allocate(totalSize, alignment, stagingOffset)) {
+                break;
+            }
+            uploadedBytes += totalSize;
+
+            for (size_t level = 0; level < decoded.levels.size(); level++) {
+                std::memcpy(_stagingRing.getMapped() + stagingOffset + _levelOffsets[level], decoded.levels[level].data, static_cast<size_t>(decoded.levels[level].size));
+            }
+
+            ResidencyChange change{};
+            change.texture = result.texture;
+            change.serial = result.serial;
+            change.residentLevel = decoded.baseLevel;
+            uint32_t levelCount = decoded.mipLevels - decoded.baseLevel;
+            createTextureImage(decoded.format, decoded.levels[0].width, decoded.levels[0].height, levelCount, change.image, change.memory, change.view, change.bytes);
+            recordUpload(batch, decoded, stagingOffset, _levelOffsets, change.image, levelCount);
+            batch.changes.push_back(change);
+        }
+
+        _readyUploads.erase(_readyUploads.begin(), _readyUploads.begin() + static_cast<std::ptrdiff_t>(consumed));
+    }
+
+    void TextureStreamer::recordUpload(GpuBatch &batch, const DecodedImage &decoded, VkDeviceSize stagingOffset, const std::vector<VkDeviceSize> &levelOffsets, VkImage image, uint32_t levelCount) {
+        bool dedicatedTransfer = batch.transferCommandBuffer != VK_NULL_HANDLE;
+        VkCommandBuffer copyCommands = dedicatedTransfer ? batch.transferCommandBuffer : batch.graphicsCommandBuffer;
+        VkCommandBuffer graphicsCommands = batch.graphicsCommandBuffer;
+
+        VkImageMemoryBarrier toTransfer = imageBarrier(image, 0, levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdPipelineBarrier(copyCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+        for (size_t level = 0; level < decoded.levels.size() && level < levelCount; level++) {
+            VkBufferImageCopy region{};
+            region.bufferOffset = stagingOffset + levelOffsets[level];
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = static_cast<uint32_t>(level);
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {decoded.levels[level].width, decoded.levels[level].height, 1};
+            vkCmdCopyBufferToImage(copyCommands, _stagingRing.getBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+
+        // Hand the image over to the graphics family, which owns it from now on //
+        if (dedicatedTransfer) {
+            VkImageMemoryBarrier release = imageBarrier(image, 0, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+            release.srcQueueFamilyIndex = _queueFamilies.transferFamily;
+            release.dstQueueFamilyIndex = _queueFamilies.graphicsFamily;
+            vkCmdPipelineBarrier(copyCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &release);
+
+            VkImageMemoryBarrier acquire = imageBarrier(image, 0, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+            acquire.srcQueueFamilyIndex = _queueFamilies.transferFamily;
+            acquire.dstQueueFamilyIndex = _queueFamilies.graphicsFamily;
+            vkCmdPipelineBarrier(graphicsCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &acquire);
+        }
+
+        if (!decoded.generateMipmaps) {
+            VkImageMemoryBarrier toShader = imageBarrier(image, 0, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+            vkCmdPipelineBarrier(graphicsCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_READ_STAGES, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+            return;
+        }
+
+        // Each level is blitted from the previous one, then released to the shaders //
+        int32_t width = static_cast<int32_t>(decoded.levels[0].width);
+        int32_t height = static_cast<int32_t>(decoded.levels[0].height);
+        for (uint32_t level = 1; level < levelCount; level++) {
+            VkImageMemoryBarrier toSource = imageBarrier(image, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+            vkCmdPipelineBarrier(graphicsCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toSource);
+
+            int32_t nextWidth = std::max(1, width / 2);
+            int32_t nextHeight = std::max(1, height / 2);
+
+            VkImageBlit blit{};
+            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.srcSubresource.mipLevel = level - 1;
+            blit.srcSubresource.baseArrayLayer = 0;
+            blit.srcSubresource.layerCount = 1;
+            blit.srcOffsets[0] = {0, 0, 0};
+            blit.srcOffsets[1] = {width, height, 1};
+            blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            blit.dstSubresource.mipLevel = level;
+            blit.dstSubresource.baseArrayLayer = 0;
+            blit.dstSubresource.layerCount = 1;
+            blit.dstOffsets[0] = {0, 0, 0};
+            blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+            vkCmdBlitImage(graphicsCommands, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            VkImageMemoryBarrier toShader = imageBarrier(image, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+            vkCmdPipelineBarrier(graphicsCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_READ_STAGES, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        VkImageMemoryBarrier lastToShader = imageBarrier(image, levelCount - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        vkCmdPipelineBarrier(graphicsCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_READ_STAGES, 0, 0, nullptr, 0, nullptr, 1, &lastToShader);
+    }
+
+    // Evicts top mips of the least recently used textures until the budget is met //
+    void TextureStreamer::enforceBudget(GpuBatch &batch) {
+        _evictionCandidates.clear();
+        for (TextureHandle handle = 0; handle < _textures.size(); handle++) {
+            const Texture &texture = _textures[handle];
+            if (texture.inUse && !texture.busy && texture.state == TextureState::Resident && texture.residentLevel < texture.minimumResidentLevel) {
+                _evictionCandidates.push_back(handle);
+            }
+        }
+        std::sort(_evictionCandidates.begin(), _evictionCandidates.end(), [this](TextureHandle a, TextureHandle b) { return _textures[a].lastUsedFrame < _textures[b].lastUsedFrame; });
+
+        VkDeviceSize projectedBytes = _residentBytes;
+        for (TextureHandle handle : _evictionCandidates) {
+            if (projectedBytes <= _settings.memoryBudget) {
+                break;
+            }
+            const Texture &texture = _textures[handle];
+            uint32_t newLevel = texture.residentLevel + 1;
+            VkDeviceSize newBytes = ImageDecoder::mipChainSize(texture.format, std::max(1u, texture.width >> newLevel), std::max(1u, texture.height >> newLevel), texture.mipLevels - newLevel);
+            VkDeviceSize oldBytes = texture.residentBytes;
+            if (downgrade(handle, batch, batch.graphicsCommandBuffer)) {
+                projectedBytes -= std::min(projectedBytes, oldBytes - std::min(oldBytes, newBytes));
+            }
+        }
+    }
+
+    bool TextureStreamer::downgrade(TextureHandle handle, GpuBatch &batch, VkCommandBuffer commandBuffer) {
+        Texture &texture = _textures[handle];
+        uint32_t newLevel = texture.residentLevel + 1;
+        uint32_t levelCount = texture.mipLevels - newLevel;
+        uint32_t width = std::max(1u, texture.width >> newLevel);
+        uint32_t height = std::max(1u, texture.height >> newLevel);
+
+        ResidencyChange change{};
+        change.texture = handle;
+        change.serial = texture.serial;
+        change.residentLevel = newLevel;
+        createTextureImage(texture.format, width, height, levelCount, change.image, change.memory, change.view, change.bytes);
+
+        std::array<VkImageMemoryBarrier, 2> before = {
+            imageBarrier(texture.image, 0, levelCount + 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT),
+            imageBarrier(change.image, 0, levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT)
+        };
+        vkCmdPipelineBarrier(commandBuffer, SHADER_READ_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(before.size()), before.data());
+
+        for (uint32_t level = 0; level < levelCount; level++) {
+            VkImageCopy region{};
+            region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level + 1, 0, 1};
+            region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            region.srcOffset = {0, 0, 0};
+            region.dstOffset = {0, 0, 0};
+            region.extent = {std::max(1u, width >> level), std::max(1u, height >> level), 1};
+            vkCmdCopyImage(commandBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, change.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+
+        // The old image stays readable by frames recorded before the swap //
+        std::array<VkImageMemoryBarrier, 2> after = {
+            imageBarrier(texture.image, 0, levelCount + 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT),
+            imageBarrier(change.image, 0, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT)
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_READ_STAGES, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(after.size()), after.data());
+
+        texture.busy = true;
+        batch.changes.push_back(change);
+        return true;
+    }
+
+    // Climbs one mip level at a time for textures drawn recently, as long as the budget allows //
+    void TextureStreamer::scheduleUpgrades() {
+        for (TextureHandle handle = 0; handle < _textures.size() && _pendingDecodes < _settings.maxPendingDecodes; handle++) {
+            Texture &texture = _textures[handle];
+            if (!texture.inUse || texture.busy || texture.state != TextureState::Resident || texture.residentLevel <= texture.bestLevel) {
+                continue;
+            }
+            if (texture.lastUsedFrame + _settings.residencyWindowFrames < _frame) {
+                continue;
+            }
+
+            uint32_t targetLevel = texture.residentLevel - 1;
+            VkDeviceSize targetBytes = ImageDecoder::mipChainSize(texture.format, std::max(1u, texture.width >> targetLevel), std::max(1u, texture.height >> targetLevel), texture.mipLevels - targetLevel);
+            VkDeviceSize extraBytes = targetBytes - std::min(targetBytes, texture.residentBytes);
+            if (_residentBytes + _reservedBytes + extraBytes > _settings.memoryBudget) {
+                continue;
+            }
+
+            texture.busy = true;
+            texture.reservedBytes = extraBytes;
+            _reservedBytes += extraBytes;
+            requestDecode(handle, std::max(texture.width, texture.height) >> targetLevel);
+        }
+    }
+
+    void TextureStreamer::createTextureImage(VkFormat format, uint32_t width, uint32_t height, uint32_t levels, VkImage &image, VkDeviceMemory &memory, VkImageView &view, VkDeviceSize &bytes) {
+        VkImageCreateInfo imageInformation{};
+        imageInformation.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInformation.imageType = VK_IMAGE_TYPE_2D;
+        imageInformation.extent = {width, height, 1};
+        imageInformation.mipLevels = levels;
+        imageInformation.arrayLayers = 1;
+        imageInformation.format = format;
+        imageInformation.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInformation.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInformation.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInformation.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInformation.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        _device.createImageWithInfo(imageInformation, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(_device.getDevice(), image, &memoryRequirements);
+        bytes = memoryRequirements.size;
+
+        VkImageViewCreateInfo viewInformation{};
+        viewInformation.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInformation.image = image;
+        viewInformation.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInformation.format = format;
+        viewInformation.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInformation.subresourceRange.baseMipLevel = 0;
+        viewInformation.subresourceRange.levelCount = levels;
+        viewInformation.subresourceRange.baseArrayLayer = 0;
+        viewInformation.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(_device.getDevice(), &viewInformation, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create texture image view.");
+        }
+    }
+
+    void TextureStreamer::destroyLater(VkImage image, VkDeviceMemory memory, VkImageView view, uint32_t bindlessIndex) {
+        Device *device = &_device;
+        BindlessTable *bindlessTable = &_bindlessTable;
+        _deletionQueue.push([device, bindlessTable, image, memory, view, bindlessIndex]() {
+            bindlessTable->releaseImage(bindlessIndex);
+            vkDestroyImageView(device->getDevice(), view, nullptr);
+            vkDestroyImage(device->getDevice(), image, nullptr);
+            device->freeMemory(memory);
+        });
+    }
+
+    TextureStreamer::~TextureStreamer() {
+        _jobSystem.wait(_decodeCounter);
+
+        for (GpuBatch &batch : _batches) {
+            if (batch.inFlight) {
+                vkWaitForFences(_device.getDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+                for (const ResidencyChange &change : batch.changes) {
+                    vkDestroyImageView(_device.getDevice(), change.view, nullptr);
+                    vkDestroyImage(_device.getDevice(), change.image, nullptr);
+                    _device.freeMemory(change.memory);
+                }
+            }
+            vkDestroyFence(_device.getDevice(), batch.fence, nullptr);
+            if (batch.ownershipSemaphore != VK_NULL_HANDLE) {
+                vkDestroySemaphore(_device.getDevice(), batch.ownershipSemaphore, nullptr);
+            }
+        }
+
+        for (Texture &texture : _textures) {
+            if (texture.inUse && texture.image != VK_NULL_HANDLE) {
+                vkDestroyImageView(_device.getDevice(), texture.view, nullptr);
+                vkDestroyImage(_device.getDevice(), texture.image, nullptr);
+                _device.freeMemory(texture.memory);
+            }
+        }
+
+        vkDestroyImageView(_device.getDevice(), _defaultView, nullptr);
+        vkDestroyImage(_device.getDevice(), _defaultImage, nullptr);
+        _device.freeMemory(_defaultMemory);
+        vkDestroySampler(_device.getDevice(), _sampler, nullptr);
+        if (_transferCommandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(_device.getDevice(), _transferCommandPool, nullptr);
+        }
+        vkDestroyCommandPool(_device.getDevice(), _graphicsCommandPool, nullptr);
+    }
+
+}
@@ -1,45 +1,343 @@
 #include "window/application.hpp"
+#include "core/allocation_counter.hpp"
+#include "pipeline/mesh_simplifier.hpp"
 
 // GLM include //
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <array>
 #include <iostream>
 #include <cassert>
+#include <cmath>
 
 namespace vulkan {
 
+    // Recorded once per command buffer: where the draws find their data; each one is its instance index //
     struct SimplePushConstantData {
+        uint32_t frameDataIndex;
+    };
+
+    // Rewritten every frame in the mapped frame data buffer, std430 layout //
+    struct DrawData {
         glm::vec2 offset;
+        float depth;
+        float scale;
         alignas(16) glm::vec3 color;
+        // Bindless index of the material's texture, or of the streamer's white default //
+        uint32_t texture;
     };
 
+    // What the scene file holds until it is edited: four copies of a triangle, farther ones smaller //
+    static SceneData buildDefaultScene() {
+        std::vector<Model::Vertex> vertices = {
+            {{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+            {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+            {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
+        };
+        Model::LodMesh mesh = MeshSimplifier::buildLodChain(vertices);
+
+        SceneData scene;
+        scene.vertices = std::move(mesh.vertices);
+        scene.lods = std::move(mesh.lods);
+        scene.meshes.push_back({0, static_cast<uint32_t>(scene.lods.size())});
+        for (uint32_t i = 0; i < 4; i++) {
+            float depth = 0.1f + 0.2f * i;
+            scene.materials.push_back({{0.0f, 0.0f, 0.2f + 0.2f * i}, Scene::INVALID_INDEX});
+            scene.transforms.push_back({{0.5f, -0.5f * i * 0.25f}, 1.0f / (1.0f + depth), depth});
+            scene.entities.push_back({Scene::INVALID_INDEX, i, 0, i});
+        }
+        return scene;
+    }
+
+    StartupAssets::StartupAssets(JobSystem &jobSystem, StartupTimeline &startupTimeline) : _jobSystem{jobSystem}, _startupTimeline{startupTimeline} {
+        _startupTimeline.schedule(_jobSystem, "shader manifest", [this]() {
+            _shaderManifest = std::make_unique<ShaderManifest>(ShaderRegistry::getManifest());
+        }, _loading);
+        // The default scene file is a cache of the built-in scene: it is baked, simplification included, //
+        // whenever it is missing or unreadable. Delete it to pick up changes to buildDefaultScene //
+        _startupTimeline.schedule(_jobSystem, "scene", [this]() {
+            std::string path = Scene::getPath();
+            if (path != Scene::DEFAULT_PATH) {
+                _scene = std::make_unique<Scene>(path);
+                return;
+            }
+            try {
+                _scene = std::make_unique<Scene>(path);
+                return;
+            } catch (const std::runtime_error &error) {
+                std::cerr << "Baking the default scene: " << error.what() << std::endl;
+            }
+            std::vector<uint8_t> bytes = Scene::serialize(buildDefaultScene());
+            try {
+                Scene::write(path, bytes);
+            } catch (const std::runtime_error &error) {
+                std::cerr << error.what() << std::endl;
+            }
+            _scene = std::make_unique<Scene>(std::move(bytes));
+        }, _loading);
+    }
+
+    const ShaderManifest &StartupAssets::getShaderManifest() {
+        _startupTimeline.wait(_jobSystem, _loading);
+        return *_shaderManifest;
+    }
+
+    std::unique_ptr<Scene> StartupAssets::takeScene() {
+        _startupTimeline.wait(_jobSystem, _loading);
+        return std::move(_scene);
+    }
+
+    StartupAssets::~StartupAssets() {
+        _jobSystem.wait(_loading);
+    }
+
     Application::Application() {
-        loadModels();
+        _startupTimeline.mark("subsystems");
+        watchMemoryBudget();
+        _startupTimeline.measure("scene", [this]() { loadScene(); });
         createPipelineLayout();
-        recreateSwapChain();
-        createCommandBuffers();
+        createSwapChainAndPipelines();
+        createComputeSemaphores();
+        _startupTimeline.measure("command buffers", [this]() { createCommandBuffers(); });
+        watchAssets();
     }
 
     void Application::run() {
+        // Input is polled inside drawFrame, as late as the frame allows //
         while (!_window.IsClosed()) {
-            glfwPollEvents();
             drawFrame();
+            if (!_startupTimeline.isReported()) {
+                _startupTimeline.mark("first frame");
+                _startupTimeline.report(std::cout);
+            }
         }
         vkDeviceWaitIdle(_device.getDevice());
+
+        std::cout << "Heap allocations over " << _steadyFrames << " steady-state frames: " << _steadyFrameAllocations << std::endl;
+        if (_swapChain->usesDynamicResolution()) {
+            std::cout << "Render scale " << _dynamicResolution.getScale() << " at " << _dynamicResolution.getGpuTime() << " ms of GPU time per frame" << std::endl;
+        }
+        if (_framePacer.getLatencyCount() > 0) {
+            std::cout << "Input-to-present latency" << (_framePacer.usesPresentWait() ? "" : " (estimated)") << " over " << _framePacer.getLatencyCount() << " frames: " << _framePacer.getAverageLatency() << " ms average, " << _framePacer.getMaxLatency() << " ms worst, at " << _framePacer.getRefreshInterval() << " ms per refresh" << std::endl;
+        }
+        reportMemory();
     }
 
-    void Application::loadModels() {
-        std::vector<Model::Vertex> vertecies {
-            {{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-            {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
-            {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
-        };
+    // Textures are the one thing that can give memory back: when a device-local heap runs over its //
+    // budget, the streamer's budget drops by the excess below what it holds and it evicts on its next //
+    // update. Nothing changes again until those evictions have been freed and reported, so one excess //
+    // is only taken off once. With headroom back, the budget grows again up to the configured one //
+    void Application::watchMemoryBudget() {
+        _baseTextureBudget = _textureStreamer.getStatistics().memoryBudget;
+        _device.addMemoryBudgetCallback([this](const MemoryHeapStatistics &heap) {
+            if (!heap.deviceLocal || _frameCount < _textureBudgetFrame + MEMORY_BUDGET_SETTLE_FRAMES) {
+                return;
+            }
+            TextureStreamer::Statistics textures = _textureStreamer.getStatistics();
+            if (textures.uploadsInFlight > 0) {
+                return;
+            }
 
-        _model = std::make_unique<Model>(_device, vertecies);
+            VkDeviceSize budget = textures.memoryBudget;
+            VkDeviceSize restoreLimit = static_cast<VkDeviceSize>(static_cast<double>(heap.budget) * MEMORY_BUDGET_RESTORE_SHARE);
+            if (heap.usage > heap.budget) {
+                VkDeviceSize held = std::min(budget, textures.residentBytes);
+                budget = held - std::min(held, heap.usage - heap.budget);
+            } else if (heap.usage < restoreLimit && budget < _baseTextureBudget && !isDeviceLocalMemoryTight()) {
+                budget = std::min(_baseTextureBudget, budget + (restoreLimit - heap.usage));
+            }
+            if (budget != textures.memoryBudget) {
+                _textureStreamer.setMemoryBudget(budget);
+                _textureBudgetFrame = _frameCount;
+            }
+        });
+    }
+
+    // Whether any device-local heap is above the share the texture budget may grow back into //
+    bool Application::isDeviceLocalMemoryTight() {
+        MemoryStatistics statistics = _device.getMemoryStatistics();
+        for (uint32_t i = 0; i < statistics.heapCount; i++) {
+            const MemoryHeapStatistics &heap = statistics.heaps[i];
+            if (heap.deviceLocal && heap.usage >= static_cast<VkDeviceSize>(static_cast<double>(heap.budget) * MEMORY_BUDGET_RESTORE_SHARE)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Application::reportMemory() {
+        static const char *CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = {"buffers", "images", "staging"};
+
+        MemoryStatistics statistics = _device.getMemoryStatistics();
+        std::cout << "GPU memory" << (statistics.budgetExtension ? "" : " (estimated budgets)") << ":" << std::endl;
+        for (uint32_t i = 0; i < statistics.heapCount; i++) {
+            const MemoryHeapStatistics &heap = statistics.heaps[i];
+            std::cout << "  heap " << heap.heapIndex << (heap.deviceLocal ? " (device local)" : "") << ": " << heap.usage / (1024 * 1024) << " / " << heap.budget / (1024 * 1024) << " MiB used, " << heap.allocatedBytes / (1024 * 1024) << " MiB in " << heap.allocationCount << " allocations";
+            for (uint32_t category = 0; category < MEMORY_CATEGORY_COUNT; category++) {
+                std::cout << ", " << CATEGORY_NAMES[category] << " " << heap.categoryBytes[category] / (1024 * 1024) << " MiB";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void Application::loadScene() {
+        std::shared_ptr<Scene> scene = _startupAssets.takeScene();
+        setScene(scene, createSceneModel(*scene));
+    }
+
+    // The scene stays mapped: its records are read in place every frame. The only copy is the upload of //
+    // the vertex section, straight from the mapping. Safe off the render thread //
+    std::shared_ptr<Model> Application::createSceneModel(const Scene &scene) {
+        SceneArray<Model::Vertex> vertices = scene.getVertices();
+        SceneArray<ModelLod> lods = scene.getLods();
+        SceneArray<ModelMesh> meshes = scene.getMeshes();
+        if (meshes.count == 0) {
+            throw std::runtime_error("Scene has no meshes.");
+        }
+        return std::make_shared<Model>(_device, vertices.data, vertices.count, std::vector<ModelLod>(lods.begin(), lods.end()), std::vector<ModelMesh>(meshes.begin(), meshes.end()));
+    }
+
+    // Between frames only. The model being replaced may still be drawn by frames in flight //
+    void Application::setScene(std::shared_ptr<Scene> scene, std::shared_ptr<Model> model) {
+        if (_model != nullptr) {
+            std::shared_ptr<Model> retired = std::move(_model);
+            _deletionQueue.push([retired]() mutable { retired.reset(); });
+        }
+        _scene = std::move(scene);
+        _model = std::move(model);
+        SceneArray<Model::Vertex> vertices = _scene->getVertices();
+        SceneArray<ModelLod> lods = _scene->getLods();
+        SceneArray<ModelMesh> meshes = _scene->getMeshes();
+
+        // Each draw's occlusion bounds are its mesh's, scaled and moved by its transform. Coarser levels //
+        // only pull the outline in, so the full-detail level bounds them all //
+        _meshBoundsMin.resize(meshes.count);
+        _meshBoundsMax.resize(meshes.count);
+        for (uint32_t mesh = 0; mesh < meshes.count; mesh++) {
+            const ModelLod &finest = lods[meshes[mesh].firstLod];
+            _meshBoundsMin[mesh] = _meshBoundsMax[mesh] = vertices[finest.firstVertex].position;
+            for (uint32_t i = finest.firstVertex; i < finest.firstVertex + finest.vertexCount; i++) {
+                _meshBoundsMin[mesh] = glm::min(_meshBoundsMin[mesh], vertices[i].position);
+                _meshBoundsMax[mesh] = glm::max(_meshBoundsMax[mesh], vertices[i].position);
+            }
+        }
+
+        requestMaterialTextures();
+        // A new scene starts from the positions in its file //
+        _sceneTime = 0.0f;
+
+        SceneArray<SceneEntity> entities = _scene->getEntities();
+        _drawCount = std::min(entities.count, _occlusionCuller.getMaxObjects());
+        _transforms.build(entities, _scene->getTransforms(), _drawCount);
+        _drawLods.resize(_drawCount);
+        for (uint32_t i = 0; i < _drawCount; i++) {
+            _drawLods[i] = meshes[entities[i].mesh].firstLod;
+        }
+
+        // A reloaded scene with more entities outgrows the draw buffers; rare enough to wait for //
+        if (!_frameData.empty() && _drawCount > _drawCapacity) {
+            vkDeviceWaitIdle(_device.getDevice());
+            destroyFrameData();
+            createFrameData();
+        }
+        invalidateCommandBuffers();
+    }
+
+    // Texture names are relative to the scene file. The new scene's textures are requested before the old //
+    // ones are released, and start from the streamer's low mip tail //
+    void Application::requestMaterialTextures() {
+        std::string scenePath = Scene::getPath();
+        size_t separator = scenePath.find_last_of('/');
+        std::string sceneDirectory = separator == std::string::npos ? "" : scenePath.substr(0, separator + 1);
+
+        SceneArray<SceneMaterial> materials = _scene->getMaterials();
+        std::vector<TextureHandle> textures(materials.count, TextureStreamer::INVALID_TEXTURE);
+        for (uint32_t i = 0; i < materials.count; i++) {
+            if (materials[i].textureName != Scene::INVALID_INDEX) {
+                std::string name = _scene->getString(materials[i].textureName);
+                textures[i] = _textureStreamer.request(!name.empty() && name[0] == '/' ? name : sceneDirectory + name);
+            }
+        }
+        for (TextureHandle texture : _materialTextures) {
+            if (texture != TextureStreamer::INVALID_TEXTURE) {
+                _textureStreamer.release(texture);
+            }
+        }
+        _materialTextures = std::move(textures);
+    }
+
+    // Only in development: shaders reload from VULKAN_SHADER_DIR, which holds both the sources and the //
+    // compiled modules, as shaders/ does after `make shaders`. The scene reloads when a new file is moved //
+    // over it, as Scene::write does. Rewriting it in place is not supported: the running scene maps it //
+    // and reads it every frame, so a truncating write would pull the pages from under it //
+    void Application::watchAssets() {
+        if (!_assetWatcher.isSupported()) {
+            return;
+        }
+        const char *shaderDirectory = ShaderRegistry::getOverrideDirectory();
+        if (shaderDirectory != nullptr) {
+            _assetWatcher.watch(shaderDirectory, [this](const std::string &directory, const std::string &fileName) {
+                reloadShader(directory, fileName);
+            });
+        }
+
+        std::string scenePath = Scene::getPath();
+        size_t separator = scenePath.find_last_of('/');
+        std::string sceneDirectory = separator == std::string::npos ? "." : scenePath.substr(0, separator);
+        std::string sceneName = separator == std::string::npos ? scenePath : scenePath.substr(separator + 1);
+        _assetWatcher.watch(sceneDirectory, [this, sceneName](const std::string &directory, const std::string &fileName) {
+            if (fileName == sceneName) {
+                reloadScene(directory + "/" + fileName);
+            }
+        }, AssetWatcher::FILE_MOVED_IN);
+        _assetWatcher.start();
+    }
+
+    static bool endsWith(const std::string &text, const std::string &suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // On the watcher thread. A changed source is compiled, and the module it writes comes back here; //
+    // a changed module rebuilds the pipeline variants using it, swapped in at the next frame //
+    void Application::reloadShader(const std::string &directory, const std::string &fileName) {
+        if (endsWith(fileName, ".spv")) {
+            std::string shader = fileName.substr(0, fileName.size() - 4);
+            if (endsWith(shader, ".comp")) {
+                std::cout << "Compute shader " << shader << " changed; restart to apply it." << std::endl;
+                return;
+            }
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            size_t rebuilt = _shaderVariants.rebuild(shader);
+            if (rebuilt > 0) {
+                _assetWatcher.post([this]() {
+                    if (_shaderVariants.swapRebuilt(_deletionQueue)) {
+                        getPipelines(_swapChain->getTargets());
+                        invalidateCommandBuffers();
+                    }
+                });
+                std::cout << "Reloaded " << shader << " (" << rebuilt << " pipelines) in " << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+            }
+        } else if (endsWith(fileName, ".vert") || endsWith(fileName, ".frag") || endsWith(fileName, ".comp")) {
+            ShaderRegistry::compileShader(directory + "/" + fileName);
+        } else if (endsWith(fileName, ".glsl")) {
+            // Which shaders include it is not tracked: every loaded graphics stage is compiled again //
+            for (const std::string &stage : _shaderVariants.getShaderNames()) {
+                ShaderRegistry::compileShader(directory + "/" + stage);
+            }
+        }
+    }
+
+    // On the watcher thread: validation and the upload happen here, the swap at the next frame //
+    void Application::reloadScene(const std::string &filePath) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>(filePath);
+        std::shared_ptr<Model> model = createSceneModel(*scene);
+        _assetWatcher.post([this, scene, model]() { setScene(scene, model); });
+        std::cout << "Reloaded " << filePath << " in " << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
     }
 
     void Application::createPipelineLayout() {
@@ -48,10 +346,12 @@ namespace vulkan {
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(SimplePushConstantData);
 
+        VkDescriptorSetLayout bindlessSetLayout = _bindlessTable.getDescriptorSetLayout();
+
         VkPipelineLayoutCreateInfo pipelineLayoutInformation{};
         pipelineLayoutInformation.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInformation.setLayoutCount = 0;
-        pipelineLayoutInformation.pSetLayouts = nullptr;
+        pipelineLayoutInformation.setLayoutCount = 1;
+        pipelineLayoutInformation.pSetLayouts = &bindlessSetLayout;
         pipelineLayoutInformation.pushConstantRangeCount = 1;
         pipelineLayoutInformation.pPushConstantRanges = &pushConstantRange;
         if (vkCreatePipelineLayout(_device.getDevice(), &pipelineLayoutInformation, nullptr, &_pipelineLayout) != VK_SUCCESS) {
@@ -59,37 +359,104 @@ namespace vulkan {
         }
     }
 
-    void Application::createPipeline() {
-        assert(_swapChain != nullptr && "Cannot create pipeline before swap-chain.");
+    void Application::createPipeline(const SwapChainTargets &targets) {
+        // Every variant bakes the old attachment formats //
+        _shaderVariants.clear();
+        getPipelines(targets);
+    }
+
+    // Pipelines compile independently in the driver, so the batches are spread over the job system. Those //
+    // already in the variant cache are only looked up //
+    void Application::getPipelines(const SwapChainTargets &targets) {
         assert(_pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout.");
 
         PipelineConfigurationInformation pipelineConfiguration{};
         Pipeline::defaultPipelineConfigurationInformation(pipelineConfiguration);
-        pipelineConfiguration.renderPass = _swapChain->getRenderPass();
+        if (targets.dynamicRendering) {
+            pipelineConfiguration.colorAttachmentFormats = {targets.colorFormat};
+            pipelineConfiguration.depthAttachmentFormat = targets.depthFormat;
+        } else {
+            pipelineConfiguration.renderPass = targets.renderPass;
+        }
         pipelineConfiguration.pipelineLayout = _pipelineLayout;
-        _pipeline = std::make_unique<Pipeline>(_device, "shaders/simple_shader.vert.spv", "shaders/simple_shader.frag.spv", pipelineConfiguration);
 
+        JobCounter compilation;
+        _startupTimeline.schedule(_jobSystem, "sprite pipelines", [this, targets]() { _spriteBatcher.createPipelines(targets, _shaderVariants); }, compilation);
+        _startupTimeline.schedule(_jobSystem, "particle pipelines", [this, targets]() { _particleSystem.createPipelines(targets, _shaderVariants); }, compilation);
+        try {
+            _pipeline = _shaderVariants.getVariant(ShaderPermutation{_shaderVariants.getManifest().getProgram("simple")}, pipelineConfiguration);
+        } catch (...) {
+            _jobSystem.wait(compilation);
+            throw;
+        }
+        _startupTimeline.wait(_jobSystem, compilation);
     }
 
-    void Application::recreateSwapChain() {
+    // With dynamic rendering the pipelines only need the attachment formats, so they compile on the job //
+    // system while the swap-chain is built. A render pass has to exist first otherwise. //
+    void Application::createSwapChainAndPipelines() {
+        SwapChainTargets targets = SwapChain::queryTargets(_device);
+        JobCounter pipelineCompilation;
+        if (targets.dynamicRendering) {
+            _startupTimeline.schedule(_jobSystem, "pipelines", [this, targets]() { createPipeline(targets); }, pipelineCompilation);
+        }
+
+        try {
+            _startupTimeline.measure("swap-chain", [this]() { _swapChain = std::make_unique<SwapChain>(_device, waitForExtent()); });
+        } catch (...) {
+            _jobSystem.wait(pipelineCompilation);
+            throw;
+        }
+        _startupTimeline.wait(_jobSystem, pipelineCompilation);
+        if (_swapChain->usesDepthSampling()) {
+            _occlusionCuller.createPyramid(*_swapChain);
+        }
+
+        SwapChainTargets created = _swapChain->getTargets();
+        if (!targets.dynamicRendering || created.colorFormat != targets.colorFormat || created.depthFormat != targets.depthFormat) {
+            _startupTimeline.measure("pipelines", [this, created]() { createPipeline(created); });
+        }
+        invalidateCommandBuffers();
+    }
+
+    // A minimized window has no extent to build a swap-chain for //
+    VkExtent2D Application::waitForExtent() {
         VkExtent2D extent = _window.getExtent();
         while (extent.width == 0 || extent.height == 0) {
             extent = _window.getExtent();
             glfwPollEvents();
         }
+        return extent;
+    }
+
+    void Application::recreateSwapChain() {
+        VkExtent2D extent = waitForExtent();
 
         vkDeviceWaitIdle(_device.getDevice());
+        _framePacer.reset();
 
+        bool formatsChanged = true;
         if (_swapChain == nullptr) {
             _swapChain = std::make_unique<SwapChain>(_device, extent);
         } else {
-            _swapChain = std::make_unique<SwapChain>(_device, extent, std::move(_swapChain));
+            std::shared_ptr<SwapChain> oldSwapChain = std::move(_swapChain);
+            _swapChain = std::make_unique<SwapChain>(_device, extent, oldSwapChain);
+            formatsChanged = !oldSwapChain->compareSwapFormats(*_swapChain);
             if (_swapChain->getImageCount() != _commandBuffers.size()) {
                 freeCommandBuffers();
                 createCommandBuffers();
             }
         }
-        createPipeline();
+        _swapChain->setRenderExtent(_dynamicResolution.getRenderExtent(_swapChain->getSwapChainExtent()));
+        if (_swapChain->usesDepthSampling()) {
+            _occlusionCuller.createPyramid(*_swapChain);
+        }
+
+        // A plain resize keeps the formats, and the pipeline stays compatible //
+        if (formatsChanged || _shaderVariants.getPipeline(_pipeline) == nullptr) {
+            createPipeline(_swapChain->getTargets());
+        }
+        invalidateCommandBuffers();
     }
 
     void Application::createCommandBuffers() {
@@ -104,73 +471,287 @@ namespace vulkan {
         if (vkAllocateCommandBuffers(_device.getDevice(), &allocatedInformation, _commandBuffers.data()) != VK_SUCCESS) {
             throw std::runtime_error("Failed to allocate command buffers.");
         }
+        // The particle simulation gets its own command buffers when it runs on the async compute queue //
+        if (_particleSystem.usesAsyncCompute()) {
+            _computeCommandBuffers.resize(_commandBuffers.size());
+            allocatedInformation.commandPool = _device.getComputeCommandPool();
+            if (vkAllocateCommandBuffers(_device.getDevice(), &allocatedInformation, _computeCommandBuffers.data()) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate compute command buffers.");
+            }
+        }
+        _recordedGenerations.assign(_commandBuffers.size(), 0);
+        _recordedDepthSlots.assign(_commandBuffers.size(), 0);
+        _dynamicResolution.createQueries(_commandBuffers.size());
+        createFrameData();
     }
 
     void Application::freeCommandBuffers() {
         vkFreeCommandBuffers(_device.getDevice(), _device.getCommandPool(), static_cast<uint32_t>(_commandBuffers.size()), _commandBuffers.data());
         _commandBuffers.clear();
+        if (!_computeCommandBuffers.empty()) {
+            vkFreeCommandBuffers(_device.getDevice(), _device.getComputeCommandPool(), static_cast<uint32_t>(_computeCommandBuffers.size()), _computeCommandBuffers.data());
+            _computeCommandBuffers.clear();
+        }
+        _recordedGenerations.clear();
+        _recordedDepthSlots.clear();
+        _dynamicResolution.destroyQueries();
+        destroyFrameData();
     }
 
-    void Application::recordCommandBuffer(int imageIndex) {
-        static int frame = 0;
-        frame = (frame + 1) % 1000;
+    // Compute and graphics submissions alternate, so one semaphore per direction is enough: each compute //
+    // submission waits for the previous graphics one to hand the particle lists back, and the graphics //
+    // submission waits for the simulation before drawing //
+    void Application::createComputeSemaphores() {
+        if (!_particleSystem.usesAsyncCompute()) {
+            return;
+        }
 
+        VkSemaphoreCreateInfo semaphoreInformation{};
+        semaphoreInformation.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(_device.getDevice(), &semaphoreInformation, nullptr, &_computeFinishedSemaphore) != VK_SUCCESS ||
+            vkCreateSemaphore(_device.getDevice(), &semaphoreInformation, nullptr, &_graphicsFinishedSemaphore) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create async compute semaphores.");
+        }
+    }
+
+    void Application::destroyComputeSemaphores() {
+        vkDestroySemaphore(_device.getDevice(), _computeFinishedSemaphore, nullptr);
+        vkDestroySemaphore(_device.getDevice(), _graphicsFinishedSemaphore, nullptr);
+    }
+
+    // One bindless slot per command buffer, pointed at the frame's draw data by updateFrameData //
+    void Application::createFrameData() {
+        _drawCapacity = std::max(_drawCount, 1u);
+        _frameData.resize(_commandBuffers.size());
+        for (FrameData &frameData : _frameData) {
+            frameData.drawDataOffset = 0;
+            frameData.bindlessIndex = _bindlessTable.registerBuffer(_dynamicBuffer.getBuffer(), 0, sizeof(DrawData) * _drawCapacity);
+            if (_device.isMultiDrawIndirectSupported()) {
+                frameData.commands = _gpuResources.createBuffer(sizeof(VkDrawIndirectCommand) * _drawCapacity, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            }
+        }
+        _particleSystem.createFrameParameters(_frameData.size());
+        _occlusionCuller.createFrameObjects(_frameData.size());
+    }
+
+    void Application::destroyFrameData() {
+        for (FrameData &frameData : _frameData) {
+            _bindlessTable.releaseBuffer(frameData.bindlessIndex);
+            _gpuResources.release(frameData.commands);
+        }
+        _frameData.clear();
+    }
+
+    // Anything baked into the recorded commands changed: every command buffer is re-recorded on its next use //
+    void Application::invalidateCommandBuffers() {
+        _sceneGeneration++;
+    }
+
+    // Only the viewport recorded in the command buffers changes: nothing is reallocated //
+    void Application::applyRenderScale() {
+        _swapChain->setRenderExtent(_dynamicResolution.getRenderExtent(_swapChain->getSwapChainExtent()));
+        invalidateCommandBuffers();
+    }
+
+    void Application::updateFrameData(int imageIndex) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        float deltaTime = std::min(std::chrono::duration<float>(now - _lastFrameTime).count(), 0.1f);
+        _lastFrameTime = now;
+        _sceneTime = std::fmod(_sceneTime + deltaTime, SCROLL_PERIOD);
+
+        // The root entities scroll at the same speed whatever the frame rate, which moves their whole subtrees //
+        SceneArray<SceneEntity> entities = _scene->getEntities();
+        SceneArray<SceneTransform> transforms = _scene->getTransforms();
+        SceneArray<SceneMaterial> materials = _scene->getMaterials();
+        for (uint32_t i = 0; i < _drawCount; i++) {
+            if (entities[i].parent == Scene::INVALID_INDEX) {
+                SceneTransform local = transforms[entities[i].transform];
+                local.position.x += _sceneTime * SCROLL_SPEED;
+                _transforms.setLocal(i, local);
+            }
+        }
+        _transforms.update();
+
+        // The slot's previous frame and the image's previous submission have both completed, so neither the //
+        // allocation nor the descriptor is in use. The allocation comes first in its slice, so its offset //
+        // only changes with the frame slot and the descriptor is rarely rewritten //
+        DynamicAllocation drawData;
+        if (!_dynamicBuffer.allocateStorage(sizeof(DrawData) * _drawCapacity, drawData)) {
+            throw std::runtime_error("Draw data does not fit in the dynamic buffer.");
+        }
+        if (_frameData[imageIndex].drawDataOffset != drawData.offset) {
+            _bindlessTable.updateBuffer(_frameData[imageIndex].bindlessIndex, drawData.buffer, drawData.offset, drawData.size);
+            _frameData[imageIndex].drawDataOffset = drawData.offset;
+        }
+        DrawData *draws = static_cast<DrawData *>(drawData.data);
+        for (uint32_t i = 0; i < _drawCount; i++) {
+            SceneTransform world = _transforms.getWorld(i);
+            draws[i].offset = world.position;
+            draws[i].depth = world.depth;
+            draws[i].scale = world.scale;
+            draws[i].color = materials[entities[i].material].color;
+            // Drawn textures keep climbing their mip chain; the others are the first to lose it //
+            TextureHandle texture = _materialTextures[entities[i].material];
+            if (texture != TextureStreamer::INVALID_TEXTURE) {
+                _textureStreamer.touch(texture);
+            }
+            draws[i].texture = _textureStreamer.getBindlessIndex(texture);
+        }
+
+        // Normalized device coordinates span two units over the render height //
+        bool lodsChanged = false;
+        float pixelsPerUnit = static_cast<float>(_swapChain->getRenderExtent().height) * 0.5f;
+        for (uint32_t i = 0; i < _drawCount; i++) {
+            uint32_t lod = _model->selectLod(entities[i].mesh, _transforms.getWorld(i).scale * pixelsPerUnit, _drawLods[i]);
+            lodsChanged = lodsChanged || lod != _drawLods[i];
+            _drawLods[i] = lod;
+        }
+
+        if (_swapChain->usesDepthSampling()) {
+            // The culling writes the draws from these, so a level change needs no re-recording //
+            OcclusionObject *objects = _occlusionCuller.getObjects(imageIndex);
+            for (uint32_t i = 0; i < _drawCount; i++) {
+                SceneTransform world = _transforms.getWorld(i);
+                objects[i].boundsMin = _meshBoundsMin[entities[i].mesh] * world.scale + world.position;
+                objects[i].boundsMax = _meshBoundsMax[entities[i].mesh] * world.scale + world.position;
+                objects[i].depth = world.depth;
+                objects[i].vertexCount = _model->getLod(_drawLods[i]).vertexCount;
+                objects[i].firstVertex = _model->getLod(_drawLods[i]).firstVertex;
+            }
+        } else if (_device.isMultiDrawIndirectSupported()) {
+            // Rewritten in bulk with the draw data, so a level change needs no re-recording either //
+            VkDrawIndirectCommand *commands = static_cast<VkDrawIndirectCommand *>(_gpuResources.getBuffer(_frameData[imageIndex].commands)->mapped);
+            for (uint32_t i = 0; i < _drawCount; i++) {
+                const ModelLod &lod = _model->getLod(_drawLods[i]);
+                commands[i] = {lod.vertexCount, 1, lod.firstVertex, i};
+            }
+        } else if (lodsChanged) {
+            invalidateCommandBuffers();
+        }
+
+        _particleSystem.update(imageIndex, deltaTime);
+    }
+
+    void Application::recordCommandBuffer(int imageIndex) {
         VkCommandBufferBeginInfo beginInformation{};
         beginInformation.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
+        if (_particleSystem.usesAsyncCompute()) {
+            if (vkBeginCommandBuffer(_computeCommandBuffers[imageIndex], &beginInformation) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin recording compute command buffer.");
+            }
+            _particleSystem.recordSimulation(_computeCommandBuffers[imageIndex], imageIndex);
+            if (vkEndCommandBuffer(_computeCommandBuffers[imageIndex]) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record compute command buffer.");
+            }
+        }
+
         if (vkBeginCommandBuffer(_commandBuffers[imageIndex], &beginInformation) != VK_SUCCESS) {
             throw std::runtime_error("Failed to begin recording command buffer.");
         }
+        _dynamicResolution.recordBegin(_commandBuffers[imageIndex], imageIndex);
 
-        VkRenderPassBeginInfo renderPassInformation{};
-        renderPassInformation.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInformation.renderPass = _swapChain->getRenderPass();
-        renderPassInformation.framebuffer = _swapChain->getFrameBuffer(imageIndex);
-        renderPassInformation.renderArea.offset = {0, 0};
-        renderPassInformation.renderArea.extent = _swapChain->getSwapChainExtent();
+        if (_particleSystem.usesAsyncCompute()) {
+            _particleSystem.recordGraphicsAcquire(_commandBuffers[imageIndex]);
+        } else {
+            _particleSystem.recordSimulation(_commandBuffers[imageIndex], imageIndex);
+        }
+        if (_swapChain->usesDepthSampling()) {
+            _occlusionCuller.recordEarlyCull(_commandBuffers[imageIndex], imageIndex, _drawCount);
+        }
 
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = {{0.01f, 0.01f, 0.01f, 1.0f}};
         clearValues[1].depthStencil = {1.0f, 0};
-        renderPassInformation.clearValueCount = static_cast<uint32_t>(clearValues.size());
-        renderPassInformation.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(_commandBuffers[imageIndex], &renderPassInformation, VK_SUBPASS_CONTENTS_INLINE);
+        if (_swapChain->usesDynamicRendering()) {
+            _swapChain->beginRendering(_commandBuffers[imageIndex], imageIndex, clearValues[0], clearValues[1]);
+        } else {
+            VkRenderPassBeginInfo renderPassInformation{};
+            renderPassInformation.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderPassInformation.renderPass = _swapChain->getRenderPass();
+            renderPassInformation.framebuffer = _swapChain->getFrameBuffer(imageIndex);
+            renderPassInformation.renderArea.offset = {0, 0};
+            renderPassInformation.renderArea.extent = _swapChain->getSwapChainExtent();
+            renderPassInformation.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassInformation.pClearValues = clearValues.data();
+
+            vkCmdBeginRenderPass(_commandBuffers[imageIndex], &renderPassInformation, VK_SUBPASS_CONTENTS_INLINE);
+        }
 
+        // The scaled area of the scene target with dynamic resolution, the whole image otherwise //
+        VkExtent2D renderExtent = _swapChain->getRenderExtent();
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(_swapChain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(_swapChain->getSwapChainExtent().height);
+        viewport.width = static_cast<float>(renderExtent.width);
+        viewport.height = static_cast<float>(renderExtent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        VkRect2D scissor{{0, 0}, _swapChain->getSwapChainExtent()};
+        VkRect2D scissor{{0, 0}, renderExtent};
         vkCmdSetViewport(_commandBuffers[imageIndex], 0, 1, &viewport);
         vkCmdSetScissor(_commandBuffers[imageIndex], 0, 1, &scissor);
 
-        _pipeline->bind(_commandBuffers[imageIndex]);
-        _model->bind(_commandBuffers[imageIndex]);
-
-        for (int i = 0; i < 4; i++) {
-            SimplePushConstantData push{};
-            push.offset = {0.5f + frame * 0.005f, -0.5f * i * 0.25f};
-            push.color = {0.0f, 0.0f, 0.2f + 0.2f * i};
-            vkCmdPushConstants(_commandBuffers[imageIndex], _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
-            _model->draw(_commandBuffers[imageIndex]);
+        if (_swapChain->usesDepthSampling()) {
+            // The late phase needs the depth of the early one: the rendering is suspended around it //
+            bindModel(imageIndex);
+            _occlusionCuller.recordDraws(_commandBuffers[imageIndex], OcclusionCuller::EARLY_PHASE, _drawCount);
+            _swapChain->suspendRendering(_commandBuffers[imageIndex], imageIndex);
+            _occlusionCuller.recordLateCull(_commandBuffers[imageIndex], imageIndex, renderExtent, _drawCount);
+            _swapChain->resumeRendering(_commandBuffers[imageIndex], imageIndex);
+            bindModel(imageIndex);
+            _occlusionCuller.recordDraws(_commandBuffers[imageIndex], OcclusionCuller::LATE_PHASE, _drawCount);
+        } else if (_device.isMultiDrawIndirectSupported()) {
+            // Every object in one call: nothing changes between draws, each finds its data by instance index //
+            bindModel(imageIndex);
+            vkCmdDrawIndirect(_commandBuffers[imageIndex], _gpuResources.getBuffer(_frameData[imageIndex].commands)->buffer, 0, _drawCount, sizeof(VkDrawIndirectCommand));
+        } else {
+            bindModel(imageIndex);
+            for (uint32_t i = 0; i < _drawCount; i++) {
+                _model->draw(_commandBuffers[imageIndex], i, _drawLods[i]);
+            }
         }
 
-        vkCmdEndRenderPass(_commandBuffers[imageIndex]);
+        _particleSystem.recordDraw(_commandBuffers[imageIndex], imageIndex);
+        _spriteBatcher.record(_commandBuffers[imageIndex]);
+
+        if (_swapChain->usesDynamicRendering()) {
+            _swapChain->endRendering(_commandBuffers[imageIndex], imageIndex);
+        } else {
+            vkCmdEndRenderPass(_commandBuffers[imageIndex]);
+        }
+        _particleSystem.recordGraphicsRelease(_commandBuffers[imageIndex]);
+        _dynamicResolution.recordEnd(_commandBuffers[imageIndex], imageIndex);
 
         if (vkEndCommandBuffer(_commandBuffers[imageIndex]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to record command buffer.");
         }
+
+        // Sprite instances live in this frame's dynamic slice, so a buffer holding sprites is never reused //
+        _recordedGenerations[imageIndex] = _spriteBatcher.isEmpty() ? _sceneGeneration : 0;
+        _recordedDepthSlots[imageIndex] = _swapChain->getDepthSlot();
+    }
+
+    // Binds what the model draws need; the culling compute in between disturbs the pipeline and push constants //
+    void Application::bindModel(int imageIndex) {
+        _shaderVariants.getPipeline(_pipeline)->bind(_commandBuffers[imageIndex]);
+        _bindlessTable.bind(_commandBuffers[imageIndex], _pipelineLayout);
+        _model->bind(_commandBuffers[imageIndex]);
+
+        SimplePushConstantData push{};
+        push.frameDataIndex = _frameData[imageIndex].bindlessIndex;
+        vkCmdPushConstants(_commandBuffers[imageIndex], _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
     }
 
     void Application::drawFrame() {
+        uint64_t allocationsBefore = AllocationCounter::getAllocationCount();
+        _framePacer.beginFrame(*_swapChain);
         uint32_t imageIndex;
         VkResult result = _swapChain->acquireNextImage(&imageIndex);
+        _framePacer.markImageAcquired();
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            glfwPollEvents();
             recreateSwapChain();
             return;
         }
@@ -179,8 +760,46 @@ namespace vulkan {
             throw std::runtime_error("Failed to acquire next swap-chain image.");
         }
 
-        recordCommandBuffer(imageIndex);
-        result = _swapChain->submitCommandBuffers(&_commandBuffers[imageIndex], &imageIndex);
+        // The frame slot acquired above has retired, so resources deleted that long ago are free to go //
+        _frameArenas.beginFrame(_swapChain->getCurrentFrame());
+        _dynamicBuffer.beginFrame(static_cast<uint32_t>(_swapChain->getCurrentFrame()));
+        _spriteBatcher.beginFrame(static_cast<uint32_t>(_swapChain->getCurrentFrame()));
+        _deletionQueue.advanceFrame();
+        _device.checkMemoryBudget();
+        _textureStreamer.update();
+        bool reloaded = _assetWatcher.applyPosted();
+
+        // Sampled as late as possible: nothing after this waits on the GPU or the display. What the window //
+        // system allocates handling events is not the frame's //
+        uint64_t allocationsBeforeInput = AllocationCounter::getAllocationCount();
+        glfwPollEvents();
+        _framePacer.markInputSampled();
+        allocationsBefore += AllocationCounter::getAllocationCount() - allocationsBeforeInput;
+
+        // The image's previous submission has completed, so its data and commands are free to touch //
+        updateFrameData(imageIndex);
+        // Measured either way for the frame pacer; the scale only matters to a scaled swap-chain //
+        if (_dynamicResolution.measure(imageIndex) && _swapChain->usesDynamicResolution() && _dynamicResolution.update()) {
+            applyRenderScale();
+        }
+
+        // Sprites for this frame are submitted between the batcher's beginFrame and prepare //
+        _spriteBatcher.prepare(_frameArenas);
+        // Images do not come back in the frame slot they were recorded in: the depth slot is checked too //
+        if (_recordedGenerations[imageIndex] != _sceneGeneration || _recordedDepthSlots[imageIndex] != _swapChain->getDepthSlot() || !_spriteBatcher.isEmpty()) {
+            recordCommandBuffer(imageIndex);
+        }
+
+        _dynamicBuffer.flush();
+        if (_particleSystem.usesAsyncCompute()) {
+            // The first simulation has no graphics submission to wait for //
+            _device.submitCompute(_computeCommandBuffers[imageIndex], _graphicsFinishedPending ? _graphicsFinishedSemaphore : VK_NULL_HANDLE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, _computeFinishedSemaphore);
+            _graphicsFinishedPending = true;
+            result = _swapChain->submitCommandBuffers(&_commandBuffers[imageIndex], &imageIndex, _computeFinishedSemaphore, ParticleSystem::DRAW_STAGES, _graphicsFinishedSemaphore);
+        } else {
+            result = _swapChain->submitCommandBuffers(&_commandBuffers[imageIndex], &imageIndex);
+        }
+        _framePacer.endFrame(*_swapChain, _dynamicResolution.getGpuTime());
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _window.wasWindowResized()) {
             _window.resetWindowResizedFlag();
             recreateSwapChain();
@@ -189,9 +808,23 @@ namespace vulkan {
         if (result != VK_SUCCESS) {
             throw std::runtime_error("Failed to present swap-chain image.");
         }
+
+        // Transient data belongs in _frameArenas; a steady-state frame that reaches operator new is a regression. //
+        // Re-recorded frames count too. A frame applying a reload builds a new scene or pipelines: not steady //
+        if (++_frameCount > WARMUP_FRAMES && !reloaded) {
+            uint64_t allocations = AllocationCounter::getAllocationCount() - allocationsBefore;
+            if (allocations != 0 && _steadyFrameAllocations == 0) {
+                std::cerr << "Frame " << _frameCount << " made " << allocations << " heap allocations." << std::endl;
+            }
+            _steadyFrames++;
+            _steadyFrameAllocations += allocations;
+        }
     }
 
     Application::~Application() {
+        _assetWatcher.stop();
+        destroyFrameData();
+        destroyComputeSemaphores();
         vkDestroyPipelineLayout(_device.getDevice(), _pipelineLayout, nullptr);
     }
 